@@ -305,6 +305,71 @@ VLC_API block_t *block_File(int fd, bool write) VLC_USED VLC_MALLOC;
  */
 VLC_API block_t *block_FilePath(const char *, bool write) VLC_USED VLC_MALLOC;
 
+/**
+ * \defgroup block_pool Block pool
+ * @{
+ */
+
+/**
+ * Pool of fixed-size blocks.
+ *
+ * A block pool recycles blocks of a single size class, so that packetized
+ * data can be allocated without hitting the heap allocator for each packet.
+ *
+ * A pool is owned by a single thread, which allocates from a private free
+ * list without any synchronization. Blocks can be released from any thread:
+ * they are then returned to the owning pool through a lock-free list.
+ */
+typedef struct block_pool block_pool_t;
+
+/**
+ * Block pool statistics.
+ */
+struct block_pool_stats
+{
+    uint64_t requests; /**< Number of blocks requested from the pool */
+    uint64_t recycled; /**< Number of requests served from recycled blocks */
+    size_t   count; /**< Number of blocks currently owned by the pool */
+};
+
+/**
+ * Creates a block pool.
+ *
+ * @param size payload size of the pool blocks (bytes)
+ * @return a pool or NULL on memory error
+ */
+VLC_API block_pool_t *block_PoolNew(size_t size) VLC_USED VLC_MALLOC;
+
+/**
+ * Releases a block pool.
+ *
+ * Blocks still in use remain valid. Their memory is reclaimed as they are
+ * released with block_Release().
+ */
+VLC_API void block_PoolRelease(block_pool_t *);
+
+/**
+ * Allocates a block from a pool.
+ *
+ * This works like block_Alloc(), but the block memory comes from the pool
+ * whenever possible. The block must be released with block_Release().
+ *
+ * @note This function must only be called by one thread at a time.
+ *
+ * @return a block of the pool size, or NULL on memory error
+ */
+VLC_API block_t *block_PoolAlloc(block_pool_t *) VLC_USED;
+
+/**
+ * Retrieves the statistics of a block pool.
+ *
+ * @note This function must be called by the thread owning the pool.
+ */
+VLC_API void block_PoolGetStats(const block_pool_t *,
+                                struct block_pool_stats *);
+
+/** @} */
+
 static inline void block_Cleanup (void *block)
 {
     block_Release ((block_t *)block);
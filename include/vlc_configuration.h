@@ -224,17 +224,21 @@ VLC_API void config_PutPsz(const char *name, const char *val);
  * Enumerates integer configuration choices.
  *
  * Determines a list of suggested values for an integer configuration item.
+ * \param obj object to log the loading of the item's plug-in for, if any
  * \param values pointer to a table of integer values [OUT]
  * \param texts pointer to a table of descriptions strings [OUT]
  * \return number of choices, or -1 on error
  * \note the caller is responsible for calling free() on all descriptions and
  * on both tables. In case of error, both pointers are set to NULL.
  */
-VLC_API ssize_t config_GetIntChoices(const char *, int64_t **values,
-                                     char ***texts) VLC_USED;
+VLC_API ssize_t config_GetIntChoices(vlc_object_t *, const char *,
+                                     int64_t **values, char ***texts) VLC_USED;
+#define config_GetIntChoices(a,b,c,d) \
+        config_GetIntChoices(VLC_OBJECT(a),b,c,d)
 
 /**
  * Determines a list of suggested values for a string configuration item.
+ * \param obj object to log the loading of the item's plug-in for, if any
  * \param values pointer to a table of value strings [OUT]
  * \param texts pointer to a table of descriptions strings [OUT]
  * \return number of choices, or -1 on error
@@ -242,8 +246,10 @@ VLC_API ssize_t config_GetIntChoices(const char *, int64_t **values,
  * descriptions and on both tables.
  * In case of error, both pointers are set to NULL.
  */
-VLC_API ssize_t config_GetPszChoices(const char *,
+VLC_API ssize_t config_GetPszChoices(vlc_object_t *, const char *,
                                      char ***values, char ***texts) VLC_USED;
+#define config_GetPszChoices(a,b,c,d) \
+        config_GetPszChoices(VLC_OBJECT(a),b,c,d)
 
 VLC_API int config_SaveConfigFile( vlc_object_t * );
 #define config_SaveConfigFile(a) config_SaveConfigFile(VLC_OBJECT(a))
@@ -51,6 +51,9 @@
 #else
 #   include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 #include <dirent.h>
 
 #include <vlc_common.h>
@@ -69,6 +72,14 @@ typedef struct
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    /* Memory-mapped reading */
+    uint64_t offset; /**< Current read offset */
+    uint64_t size; /**< File size, updated on end of file */
+    uint64_t next; /**< Offset following the last returned block */
+    unsigned sequential; /**< Number of consecutive sequential blocks */
+    size_t page_mask;
+#endif
 } access_sys_t;
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -126,11 +137,21 @@ static bool IsRemote (const char *path)
 #ifndef HAVE_POSIX_FADVISE
 # define posix_fadvise(fd, off, len, adv)
 #endif
+#ifndef HAVE_POSIX_MADVISE
+# define posix_madvise(addr, len, adv)
+#endif
+
+/* Size of the memory mappings handed out as blocks */
+#define MMAP_WINDOW_SIZE (1 << 20)
 
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int NoSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *, bool *restrict);
+static int MmapSeek (stream_t *, uint64_t);
+#endif
 
 /*****************************************************************************
  * FileOpen: open the file
@@ -231,6 +252,23 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        /* Remote files are more likely to be truncated under our feet,
+         * which would kill the process with SIGBUS. */
+        if (S_ISREG (st.st_mode) && !IsRemote(fd, p_access->psz_filepath)
+         && var_InheritBool (p_access, "file-mmap"))
+        {
+            p_access->pf_read = NULL;
+            p_access->pf_block = MmapBlock;
+            p_access->pf_seek = MmapSeek;
+            p_sys->offset = 0;
+            p_sys->size = st.st_size;
+            p_sys->next = 0;
+            p_sys->sequential = 0;
+            p_sys->page_mask = sysconf (_SC_PAGESIZE) - 1;
+            msg_Dbg (p_access, "using memory mapping");
+        }
 #endif
     }
     else
@@ -253,7 +291,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_readdir != NULL)
     {
         DirClose (p_this);
         return;
@@ -287,6 +325,71 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    uint64_t offset = p_sys->offset;
+
+    if (offset >= p_sys->size)
+    {   /* The file may have grown in the mean time */
+        struct stat st;
+
+        if (fstat (p_sys->fd, &st) == 0)
+            p_sys->size = st.st_size;
+        if (offset >= p_sys->size)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    /* Mappings must start on a page boundary */
+    size_t skip = offset & p_sys->page_mask;
+    uint64_t base = offset - skip;
+    size_t length = __MIN(p_sys->size - base, MMAP_WINDOW_SIZE);
+
+    void *addr = mmap (NULL, length, PROT_READ, MAP_SHARED, p_sys->fd, base);
+    if (addr == MAP_FAILED)
+    {
+        msg_Err (p_access, "memory mapping error: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+
+    /* Follow the reading pattern of the demuxer: read ahead when it reads
+     * sequentially, only fault in the current window after a seek. */
+    if (offset == p_sys->next)
+        p_sys->sequential++;
+    else
+        p_sys->sequential = 0;
+
+    if (p_sys->sequential > 0)
+    {
+        posix_madvise (addr, length, POSIX_MADV_SEQUENTIAL);
+        posix_fadvise (p_sys->fd, base + length, MMAP_WINDOW_SIZE,
+                       POSIX_FADV_WILLNEED);
+    }
+    /* The advised range must be page-aligned, unlike addr + skip */
+    posix_madvise (addr, length, POSIX_MADV_WILLNEED);
+
+    block_t *block = block_mmap_Alloc ((char *)addr + skip, length - skip);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    p_sys->offset = p_sys->next = base + length;
+    return block;
+}
+
+static int MmapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    p_sys->offset = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -36,6 +36,10 @@ vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_ACCESS )
     add_obsolete_string( "file-cat" )
+    add_bool( "file-mmap", false, N_("Use memory mapping"),
+              N_("Read local files through memory mappings instead of "
+                 "copying their content. The file must not be truncated "
+                 "while it is being read."), true )
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
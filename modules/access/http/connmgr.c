@@ -98,6 +98,7 @@ struct vlc_http_mgr
     vlc_tls_creds_t *creds;
     struct vlc_http_cookie_jar_t *jar;
     struct vlc_http_conn *conn;
+    bool multiplexed;
 };
 
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
@@ -186,6 +187,7 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
      * supported by the server.
      * NOTE: We do not enforce TLS version 1.2 for HTTP 2.0 explicitly.
      */
+    mgr->multiplexed = http2;
     if (http2)
         conn = vlc_h2_conn_create(mgr->obj, tls);
     else
@@ -247,6 +249,7 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
+    mgr->multiplexed = false;
     mgr->conn = conn;
     return resp;
 }
@@ -263,6 +266,11 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
     return mgr->jar;
 }
 
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr)
+{
+    return mgr->conn != NULL && mgr->multiplexed;
+}
+
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
                                          struct vlc_http_cookie_jar_t *jar)
 {
@@ -274,6 +282,7 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->creds = NULL;
     mgr->jar = jar;
     mgr->conn = NULL;
+    mgr->multiplexed = false;
     return mgr;
 }
 
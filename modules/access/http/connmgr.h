@@ -54,6 +54,14 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
+/**
+ * Checks connection multiplexing
+ *
+ * @retval true if the current connection can carry concurrent streams (HTTP/2)
+ * @retval false if there is no connection, or it is HTTP/1.x
+ */
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr);
+
 /**
  * Creates an HTTP connection manager
  *
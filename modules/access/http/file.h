@@ -72,6 +72,20 @@ bool vlc_http_file_can_seek(struct vlc_http_resource *);
  */
 int vlc_http_file_seek(struct vlc_http_resource *, uintmax_t offset);
 
+/**
+ * Sets the read offset and the end of the data to request.
+ *
+ * The request is bounded to the given byte range, so that the server can
+ * keep the connection alive once it is read.
+ *
+ * @param offset byte offset of next read
+ * @param end offset of the last byte to read (inclusive)
+ * @retval 0 if seek succeeded
+ * @retval -1 if seek failed
+ */
+int vlc_http_file_seek_range(struct vlc_http_resource *, uintmax_t offset,
+                             uintmax_t end);
+
 /**
  * Reads data.
  *
@@ -37,6 +37,7 @@
 #endif
 
 #include <errno.h>
+#include <stdatomic.h>
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
@@ -59,6 +60,9 @@ static void Close( vlc_object_t * );
 #define BUFFER_TEXT N_("Receive buffer")
 #define BUFFER_LONGTEXT N_("UDP receive buffer size (bytes)" )
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Receive batch size")
+#define BATCH_LONGTEXT N_("Maximum number of datagrams received per " \
+    "system call. 1 disables batched reception.")
 
 vlc_module_begin ()
     set_shortname( N_("UDP" ) )
@@ -69,6 +73,10 @@ vlc_module_begin ()
     add_obsolete_integer( "server-port" ) /* since 2.0.0 */
     add_obsolete_integer( "udp-buffer" ) /* since 3.0.0 */
     add_integer( "udp-timeout", -1, TIMEOUT_TEXT, NULL, true )
+#ifdef HAVE_RECVMMSG
+    add_integer_with_range( "udp-batch", 16, 1, 1024,
+                            BATCH_TEXT, BATCH_LONGTEXT, true )
+#endif
 
     set_capability( "access", 0 )
     add_shortcut( "udp", "udpstream", "udp4", "udp6" )
@@ -81,12 +89,23 @@ typedef struct
     int fd;
     int timeout;
     size_t mtu;
+    block_pool_t *pool;
+#ifdef HAVE_RECVMMSG
+    unsigned batch;
+    struct mmsghdr *msgv;
+    struct iovec *iov;
+    uint64_t datagrams; /**< datagrams received in batched mode */
+    uint64_t wakeups; /**< recvmmsg() calls returning data */
+#endif
 } access_sys_t;
 
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
 static block_t *BlockUDP( stream_t *, bool * );
+#ifdef HAVE_RECVMMSG
+static block_t *BlockUDPBatch( stream_t *, bool * );
+#endif
 static int Control( stream_t *, int, va_list );
 
 /*****************************************************************************
@@ -169,11 +188,43 @@ static int Open( vlc_object_t *p_this )
     }
 
     sys->mtu = 7 * 188;
+    sys->pool = block_PoolNew( sys->mtu );
+    if( unlikely(sys->pool == NULL) )
+    {
+        net_Close( sys->fd );
+        return VLC_ENOMEM;
+    }
 
     sys->timeout = var_InheritInteger( p_access, "udp-timeout");
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_RECVMMSG
+    sys->batch = var_InheritInteger( p_access, "udp-batch" );
+    sys->msgv = NULL;
+    sys->iov = NULL;
+    sys->datagrams = 0;
+    sys->wakeups = 0;
+
+    if( sys->batch > 1 )
+    {
+        sys->msgv = vlc_obj_calloc( p_this, sys->batch, sizeof (*sys->msgv) );
+        sys->iov = vlc_obj_calloc( p_this, sys->batch, sizeof (*sys->iov) );
+        if( unlikely(sys->msgv == NULL || sys->iov == NULL) )
+        {
+            block_PoolRelease( sys->pool );
+            net_Close( sys->fd );
+            return VLC_ENOMEM;
+        }
+
+        for( unsigned i = 0; i < sys->batch; i++ )
+        {
+            sys->msgv[i].msg_hdr.msg_iov = &sys->iov[i];
+            sys->msgv[i].msg_hdr.msg_iovlen = 1;
+        }
+        p_access->pf_block = BlockUDPBatch;
+    }
+#endif
     return VLC_SUCCESS;
 }
 
@@ -185,6 +236,20 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    if( sys->wakeups > 0 )
+        msg_Dbg( p_access, "received %"PRIu64" datagrams in %"PRIu64
+                 " batches (%.2f datagrams per call)", sys->datagrams,
+                 sys->wakeups, (double)sys->datagrams / sys->wakeups );
+#endif
+    struct block_pool_stats stats;
+
+    block_PoolGetStats( sys->pool, &stats );
+    if( stats.requests > 0 )
+        msg_Dbg( p_access, "%"PRIu64" of %"PRIu64" blocks recycled "
+                 "(%zu allocated)", stats.recycled, stats.requests,
+                 stats.count );
+    block_PoolRelease( sys->pool );
     net_Close( sys->fd );
 }
 
@@ -216,6 +281,24 @@ static int Control( stream_t *p_access, int i_query, va_list args )
     return VLC_SUCCESS;
 }
 
+/* Pool blocks are allocated with the MTU size: grow both after truncation */
+static void GrowMTU(stream_t *access, size_t mtu)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (mtu <= sys->mtu)
+        return;
+
+    block_pool_t *pool = block_PoolNew(mtu);
+    if (unlikely(pool == NULL))
+        return;
+
+    /* Blocks from the previous pool remain valid until released */
+    block_PoolRelease(sys->pool);
+    sys->pool = pool;
+    sys->mtu = mtu;
+}
+
 /*****************************************************************************
  * BlockUDP:
  *****************************************************************************/
@@ -223,7 +306,7 @@ static block_t *BlockUDP(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
 
-    block_t *pkt = block_Alloc(sys->mtu);
+    block_t *pkt = block_PoolAlloc(sys->pool);
     if (unlikely(pkt == NULL))
     {   /* OOM - dequeue and discard one packet */
         char dummy;
@@ -272,7 +355,7 @@ skip:
         msg_Err(access, "%zd bytes packet truncated (MTU was %zu)",
                 len, sys->mtu);
         pkt->i_flags |= BLOCK_FLAG_CORRUPTED;
-        sys->mtu = len;
+        GrowMTU(access, len);
     }
     else
 #endif
@@ -280,3 +363,143 @@ skip:
 
     return pkt;
 }
+
+#ifdef HAVE_RECVMMSG
+/*****************************************************************************
+ * Batched reception:
+ *
+ * Datagrams are received directly into a single slab allocation holding the
+ * block headers and the payloads of a whole batch. Each datagram is returned
+ * as its own block in a chain, and the slab is freed with its last block.
+ *****************************************************************************/
+struct udp_slab;
+
+struct udp_datagram
+{
+    block_t self;
+    struct udp_slab *slab;
+};
+
+struct udp_slab
+{
+    atomic_uint refs;
+    struct udp_datagram dgrams[];
+};
+
+static void SlabRelease(block_t *block)
+{
+    struct udp_datagram *dgram = container_of(block, struct udp_datagram,
+                                              self);
+    struct udp_slab *slab = dgram->slab;
+
+    if (atomic_fetch_sub_explicit(&slab->refs, 1, memory_order_acq_rel) == 1)
+        aligned_free(slab);
+}
+
+static const struct vlc_block_callbacks udp_slab_cbs =
+{
+    SlabRelease,
+};
+
+static struct udp_slab *SlabAlloc(unsigned count, size_t mtu,
+                                  unsigned char **restrict data)
+{
+    size_t hdr = sizeof (struct udp_slab)
+               + count * sizeof (struct udp_datagram);
+    size_t size;
+
+    /* Keep payloads aligned as block_Alloc() would */
+    hdr = (hdr + 31) & ~(size_t)31;
+    if (unlikely(mul_overflow(count, mtu, &size)
+              || add_overflow(size, hdr, &size)))
+        return NULL;
+
+    unsigned char *base = aligned_alloc(32, (size + 31) & ~(size_t)31);
+    if (unlikely(base == NULL))
+        return NULL;
+
+    struct udp_slab *slab = (struct udp_slab *)base;
+    atomic_init(&slab->refs, 0);
+    *data = base + hdr;
+    return slab;
+}
+
+static block_t *BlockUDPBatch(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    const size_t mtu = sys->mtu;
+    unsigned char *data;
+
+    struct udp_slab *slab = SlabAlloc(sys->batch, mtu, &data);
+    if (unlikely(slab == NULL))
+    {   /* OOM - dequeue and discard one packet */
+        char dummy;
+        recv(sys->fd, &dummy, 1, 0);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < sys->batch; i++)
+    {
+        sys->iov[i].iov_base = data + i * mtu;
+        sys->iov[i].iov_len = mtu;
+        sys->msgv[i].msg_hdr.msg_flags = 0;
+    }
+
+    struct pollfd ufd[1];
+
+    ufd[0].fd = sys->fd;
+    ufd[0].events = POLLIN;
+
+    switch (vlc_poll_i11e(ufd, 1, sys->timeout))
+    {
+        case 0:
+            msg_Err(access, "receive time-out");
+            *eof = true;
+            /* fall through */
+        case -1:
+            aligned_free(slab);
+            return NULL;
+     }
+
+    /* The socket is readable: take whatever is queued without blocking */
+    int count = recvmmsg(sys->fd, sys->msgv, sys->batch, MSG_WAITFORONE,
+                         NULL);
+    if (count <= 0)
+    {
+        aligned_free(slab);
+        return NULL;
+    }
+
+    sys->datagrams += count;
+    sys->wakeups++;
+
+    atomic_init(&slab->refs, count);
+
+    block_t *chain = NULL, **pp = &chain;
+
+    for (int i = 0; i < count; i++)
+    {
+        struct udp_datagram *dgram = &slab->dgrams[i];
+        block_t *pkt = block_Init(&dgram->self, &udp_slab_cbs,
+                                  data + i * mtu, mtu);
+        size_t len = sys->msgv[i].msg_len;
+
+        dgram->slab = slab;
+
+        if (sys->msgv[i].msg_hdr.msg_flags & MSG_TRUNC)
+        {
+            msg_Err(access, "%zu bytes packet truncated (MTU was %zu)",
+                    len, mtu);
+            pkt->i_flags |= BLOCK_FLAG_CORRUPTED;
+            GrowMTU(access, len);
+        }
+        else
+            pkt->i_buffer = len;
+
+        *pp = pkt;
+        pp = &pkt->p_next;
+    }
+
+    return chain;
+}
+#endif
@@ -46,11 +46,28 @@
 #elif defined (HAVE_SYS_SOCKET_H)
 #   include <sys/socket.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#   include <sys/uio.h>
+#endif
+#ifdef __linux__
+#   include <netinet/udp.h>
+#endif
 
 #include <vlc_network.h>
 
 #define MAX_EMPTY_BLOCKS 200
 
+/* Maximum number of datagrams submitted to the kernel at once.
+ * This is also the Linux limit on UDP segmentation offload segments. */
+#define MAX_BATCH_PACKETS 64
+
+/* Paced packets due within this delay of the last wait are sent with it */
+#define PACING_SLOT VLC_TICK_FROM_MS(1)
+
+#if defined (UDP_SEGMENT) && defined (HAVE_SENDMMSG)
+#   define HAVE_UDP_GSO 1
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -119,8 +136,35 @@ typedef struct
     block_t      *p_buffer;
 
     vlc_thread_t  thread;
+
+    /* Datagrams due in the current pacing slot, owned by the thread */
+    block_t      *pp_batch[MAX_BATCH_PACKETS];
+    vlc_tick_t    pi_batch_date[MAX_BATCH_PACKETS]; /* or VLC_TICK_INVALID */
+    unsigned      i_batch;
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgv[MAX_BATCH_PACKETS];
+    struct iovec  iov[MAX_BATCH_PACKETS];
+#endif
+#ifdef HAVE_UDP_GSO
+    bool          b_gso;
+#endif
+
+    /* Statistics, only accessed by the thread until it is joined */
+    uint64_t      i_sent_batches;
+    uint64_t      i_sent_packets;
+    uint64_t      jitter[6];
 } sout_access_out_sys_t;
 
+/* Upper bounds of the send jitter histogram buckets. The first bucket counts
+ * early sends, the last one counts sends later than the last bound. */
+static const vlc_tick_t jitter_bounds[] = {
+    0,
+    VLC_TICK_FROM_US(100),
+    VLC_TICK_FROM_MS(1),
+    VLC_TICK_FROM_MS(5),
+    VLC_TICK_FROM_MS(20),
+};
+
 #define DEFAULT_PORT 1234
 
 /*****************************************************************************
@@ -209,6 +253,21 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_mtu_warning = false;
     p_sys->p_fifo = block_FifoNew();
     p_sys->p_buffer = NULL;
+    p_sys->i_batch = 0;
+#ifdef HAVE_SENDMMSG
+    memset( p_sys->msgv, 0, sizeof( p_sys->msgv ) );
+    for( unsigned i = 0; i < MAX_BATCH_PACKETS; i++ )
+    {
+        p_sys->msgv[i].msg_hdr.msg_iov = &p_sys->iov[i];
+        p_sys->msgv[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+#ifdef HAVE_UDP_GSO
+    p_sys->b_gso = true;
+#endif
+    p_sys->i_sent_batches = 0;
+    p_sys->i_sent_packets = 0;
+    memset( p_sys->jitter, 0, sizeof( p_sys->jitter ) );
 
     if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
@@ -239,6 +298,19 @@ static void Close( vlc_object_t * p_this )
     block_FifoRelease( p_sys->p_fifo );
 
     if( p_sys->p_buffer ) block_Release( p_sys->p_buffer );
+    for( unsigned i = 0; i < p_sys->i_batch; i++ )
+        block_Release( p_sys->pp_batch[i] );
+
+    if( p_sys->i_sent_batches > 0 )
+    {
+        msg_Dbg( p_access, "sent %"PRIu64" packets in %"PRIu64" batches",
+                 p_sys->i_sent_packets, p_sys->i_sent_batches );
+        msg_Dbg( p_access, "send jitter: early %"PRIu64", <0.1ms %"PRIu64
+                 ", <1ms %"PRIu64", <5ms %"PRIu64", <20ms %"PRIu64
+                 ", >=20ms %"PRIu64, p_sys->jitter[0], p_sys->jitter[1],
+                 p_sys->jitter[2], p_sys->jitter[3], p_sys->jitter[4],
+                 p_sys->jitter[5] );
+    }
 
     net_Close( p_sys->i_handle );
     free( p_sys );
@@ -346,14 +418,160 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     return i_len;
 }
 
+/*****************************************************************************
+ * SendBatch: submit all pending datagrams to the kernel at once.
+ *****************************************************************************/
+#ifdef HAVE_UDP_GSO
+/* Sends as many datagrams as possible with segmentation offload, in runs
+ * of same size segments, and returns how many were sent */
+static unsigned SendBatchGSO( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    const unsigned i_count = p_sys->i_batch;
+    unsigned i_done = 0;
+
+    while( i_count - i_done > 1 )
+    {
+        const size_t i_segment = p_sys->pp_batch[i_done]->i_buffer;
+        const unsigned i_max = i_segment ? 65507 / i_segment : 0;
+        unsigned i_run = 1;
+
+        /* All segments but the last one must have the same size */
+        while( i_run < i_max && i_done + i_run < i_count )
+        {
+            size_t i_size = p_sys->pp_batch[i_done + i_run]->i_buffer;
+
+            if( i_size > i_segment )
+                break;
+            i_run++;
+            if( i_size < i_segment )
+                break;
+        }
+        if( i_run < 2 )
+            break;
+
+        union {
+            char buf[CMSG_SPACE(sizeof (uint16_t))];
+            struct cmsghdr align;
+        } u;
+        struct msghdr msg = {
+            .msg_iov = p_sys->iov + i_done,
+            .msg_iovlen = i_run,
+            .msg_control = u.buf,
+            .msg_controllen = sizeof (u.buf),
+        };
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+
+        cm->cmsg_level = SOL_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof (uint16_t));
+        *(uint16_t *)CMSG_DATA(cm) = i_segment;
+
+        if( sendmsg( p_sys->i_handle, &msg, 0 ) == -1 )
+        {
+            /* Only these mean that the kernel or device lacks support */
+            if( errno == EINVAL || errno == EIO )
+            {
+                msg_Dbg( p_access, "segmentation offload disabled: %s",
+                         vlc_strerror_c(errno) );
+                p_sys->b_gso = false;
+            }
+            break;
+        }
+        i_done += i_run;
+    }
+    return i_done;
+}
+#endif
+
+static void RecordJitter( sout_access_out_sys_t *p_sys, vlc_tick_t i_delay )
+{
+    size_t i = 0;
+
+    while( i < ARRAY_SIZE(jitter_bounds) && i_delay >= jitter_bounds[i] )
+        i++;
+    p_sys->jitter[i]++;
+}
+
+static void SendBatch( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    const unsigned i_count = p_sys->i_batch;
+
+    if( i_count == 0 )
+        return;
+
+#ifdef HAVE_SENDMMSG
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        p_sys->iov[i].iov_base = p_sys->pp_batch[i]->p_buffer;
+        p_sys->iov[i].iov_len = p_sys->pp_batch[i]->i_buffer;
+    }
+
+    unsigned i_done = 0;
+# ifdef HAVE_UDP_GSO
+    if( i_count > 1 && p_sys->b_gso )
+        i_done = SendBatchGSO( p_access );
+# endif
+
+    while( i_done < i_count )
+    {
+        int val = sendmmsg( p_sys->i_handle, p_sys->msgv + i_done,
+                            i_count - i_done, 0 );
+        if( val <= 0 )
+        {
+            /* Only the first pending datagram failed: skip it */
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+            val = 1;
+        }
+        i_done += val;
+    }
+#else
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        block_t *p_pk = p_sys->pp_batch[i];
+
+        if( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+    }
+#endif
+
+    const vlc_tick_t i_sent = vlc_tick_now();
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        const vlc_tick_t i_date = p_sys->pi_batch_date[i];
+
+        if( i_date != VLC_TICK_INVALID )
+        {
+            RecordJitter( p_sys, i_sent - i_date );
+            if ( i_sent > i_date + VLC_TICK_FROM_MS(20) )
+            {
+                msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
+                         i_sent - i_date );
+            }
+        }
+        block_Release( p_sys->pp_batch[i] );
+    }
+    p_sys->i_batch = 0;
+    p_sys->i_sent_batches++;
+    p_sys->i_sent_packets += i_count;
+}
+
 /*****************************************************************************
  * ThreadWrite: Write a packet on the network at the good time.
+ *
+ * Packets are paced as before: one out of every "group" packets, and every
+ * packet carrying a PCR, is held until its date. Pending packets are only
+ * submitted, with a single system call, before waiting for a date past the
+ * current pacing slot, so that packets already due are sent together.
  *****************************************************************************/
 static void* ThreadWrite( void *data )
 {
     sout_access_out_t *p_access = data;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
     vlc_tick_t i_date_last = -1;
+    vlc_tick_t i_slot_end = VLC_TICK_INVALID;
     const unsigned i_group = var_GetInteger( p_access,
                                              SOUT_CFG_PREFIX "group" );
     int i_to_send = i_group;
@@ -362,60 +580,78 @@ static void* ThreadWrite( void *data )
     for (;;)
     {
         block_t *p_pk = block_FifoGet( p_sys->p_fifo );
-        vlc_tick_t    i_date, i_sent;
 
-        i_date = p_sys->i_caching + p_pk->i_dts;
-        if( i_date_last > 0 )
+        while( p_pk != NULL )
         {
-            if( i_date - i_date_last > 2000000 )
+            vlc_tick_t    i_date;
+
+            i_date = p_sys->i_caching + p_pk->i_dts;
+            if( i_date_last > 0 )
             {
-                if( !i_dropped_packets )
-                    msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
-                             i_date - i_date_last );
+                if( i_date - i_date_last > 2000000 )
+                {
+                    if( !i_dropped_packets )
+                        msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                                 i_date - i_date_last );
 
-                block_Release( p_pk );
+                    block_Release( p_pk );
 
-                i_date_last = i_date;
-                i_dropped_packets++;
-                continue;
+                    i_date_last = i_date;
+                    i_dropped_packets++;
+                    goto next;
+                }
+                else if( i_date - i_date_last < VLC_TICK_FROM_MS(-1) )
+                {
+                    if( !i_dropped_packets )
+                        msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
+                                 i_date_last - i_date );
+                }
             }
-            else if( i_date - i_date_last < VLC_TICK_FROM_MS(-1) )
+
+            i_to_send--;
+            const bool b_paced = !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK);
+            if( b_paced
+             && (i_slot_end == VLC_TICK_INVALID || i_date > i_slot_end)
+             && i_date > vlc_tick_now() )
             {
-                if( !i_dropped_packets )
-                    msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
-                             i_date_last - i_date );
+                /* Flush the previous slot, then wait for this one */
+                SendBatch( p_access );
+
+                block_cleanup_push( p_pk );
+                vlc_tick_wait( i_date );
+                vlc_cleanup_pop();
+                i_to_send = i_group;
+                i_slot_end = i_date + PACING_SLOT;
+            }
+            else
+            {
+                /* Due already, or within the current slot */
+                if( !i_to_send )
+                    i_to_send = i_group;
+                if( p_sys->i_batch == MAX_BATCH_PACKETS )
+                    SendBatch( p_access );
             }
-        }
 
-        block_cleanup_push( p_pk );
-        i_to_send--;
-        if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
-        {
-            vlc_tick_wait( i_date );
-            i_to_send = i_group;
-        }
-        if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
-            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
-        vlc_cleanup_pop();
+            /* Lateness is measured once sent, whether it waited or not */
+            p_sys->pi_batch_date[p_sys->i_batch] = b_paced ? i_date
+                                                           : VLC_TICK_INVALID;
+            p_sys->pp_batch[p_sys->i_batch++] = p_pk;
 
-        if( i_dropped_packets )
-        {
-            msg_Dbg( p_access, "dropped %i packets", i_dropped_packets );
-            i_dropped_packets = 0;
-        }
+            if( i_dropped_packets )
+            {
+                msg_Dbg( p_access, "dropped %i packets", i_dropped_packets );
+                i_dropped_packets = 0;
+            }
 
-#if 1
-        i_sent = vlc_tick_now();
-        if ( i_sent > i_date + VLC_TICK_FROM_MS(20) )
-        {
-            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
-                     i_sent - i_date );
+            i_date_last = i_date;
+next:
+            /* Coalesce whatever is already queued without blocking */
+            vlc_fifo_Lock( p_sys->p_fifo );
+            p_pk = vlc_fifo_DequeueUnlocked( p_sys->p_fifo );
+            vlc_fifo_Unlock( p_sys->p_fifo );
         }
-#endif
-
-        block_Release( p_pk );
 
-        i_date_last = i_date;
+        SendBatch( p_access );
     }
     return NULL;
 }
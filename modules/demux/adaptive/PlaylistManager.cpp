@@ -31,6 +31,7 @@
 #include "playlist/BaseRepresentation.h"
 #include "http/HTTPConnectionManager.h"
 #include "http/AuthStorage.hpp"
+#include "http/SegmentCache.hpp"
 #include "logic/AlwaysBestAdaptationLogic.h"
 #include "logic/RateBasedAdaptationLogic.h"
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
@@ -40,6 +41,8 @@
 #include <vlc_stream.h>
 #include <vlc_demux.h>
 #include <vlc_threads.h>
+#include <vlc_es_out.h>
+#include <vlc_input_item.h>
 
 #include <algorithm>
 #include <ctime>
@@ -77,6 +80,11 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
     cached.i_length = 0;
     cached.f_position = 0.0;
     cached.i_time = VLC_TICK_INVALID;
+    cached.i_liveedge = VLC_TICK_INVALID;
+    cached.i_liveedgeinfo = 0;
+
+    if(var_InheritBool(p_demux, "adaptive-lowlatency"))
+        playlist->setLowLatency(VLC_TICK_FROM_MS(var_InheritInteger(p_demux, "adaptive-livedelay")));
 }
 
 PlaylistManager::~PlaylistManager   ()
@@ -117,7 +125,8 @@ bool PlaylistManager::setupPeriod()
         BaseAdaptationSet *set = *it;
         if(set && streamFactory)
         {
-            SegmentTracker *tracker = new (std::nothrow) SegmentTracker(logic, set);
+            SegmentTracker *tracker = new (std::nothrow) SegmentTracker(logic, set,
+                                            var_InheritInteger(p_demux, "adaptive-prefetch"));
             if(!tracker)
                 continue;
 
@@ -160,6 +169,10 @@ bool PlaylistManager::start()
       )
         return false;
 
+    /* Live segments are seldom played twice */
+    if(!playlist->isLive())
+        conManager->setSegmentCache(SegmentCache::create(VLC_OBJECT(p_demux)));
+
     if(!setupPeriod())
         return false;
 
@@ -483,6 +496,8 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
             es_out_Control(p_demux->out, ES_OUT_SET_GROUP_PCR, 0, pcr);
         }
         vlc_mutex_unlock(&demux.lock);
+        if(playlist->isLowLatency())
+            followLiveEdge(increment);
         break;
     }
 
@@ -597,7 +612,11 @@ int PlaylistManager::doControl(int i_query, va_list args)
         }
 
         case DEMUX_GET_PTS_DELAY:
-            *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
+            if(playlist->isLowLatency())
+                *va_arg (args, vlc_tick_t *) = std::min(VLC_TICK_FROM_SEC(1),
+                                                        playlist->getLiveDelay() / 4);
+            else
+                *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
             break;
 
         default:
@@ -643,6 +662,8 @@ void PlaylistManager::Run()
 
         int canc = vlc_savecancel();
         AbstractStream::buffering_status i_return = bufferize(i_nzpcr, i_min_buffering, i_extra_buffering);
+        if(playlist->isLowLatency())
+            updateLiveEdgeDistance();
         vlc_restorecancel( canc );
 
         if(i_return != AbstractStream::buffering_lessthanmin)
@@ -671,6 +692,58 @@ void PlaylistManager::Run()
     vlc_mutex_unlock(&lock);
 }
 
+void PlaylistManager::updateLiveEdgeDistance()
+{
+    /* Media published but not played yet: the demuxed queue,
+       plus what the playlist already lists past the download */
+    vlc_tick_t i_distance = VLC_TICK_INVALID;
+    std::vector<AbstractStream *>::const_iterator it;
+    for(it=streams.begin(); it!=streams.end(); ++it)
+    {
+        const AbstractStream *st = *it;
+        if(st->isDisabled() || !st->isSelected())
+            continue;
+        const vlc_tick_t i_ahead = st->getMinAheadTime() + st->getDemuxedAmount();
+        if(i_distance == VLC_TICK_INVALID || i_ahead < i_distance)
+            i_distance = i_ahead;
+    }
+
+    vlc_mutex_locker locker(&cached.lock);
+    cached.i_liveedge = i_distance;
+}
+
+void PlaylistManager::followLiveEdge(vlc_tick_t increment)
+{
+    vlc_tick_t i_distance;
+    bool b_info = false;
+    {
+        vlc_mutex_locker locker(&cached.lock);
+        i_distance = cached.i_liveedge;
+        const vlc_tick_t now = vlc_tick_now();
+        if(i_distance != VLC_TICK_INVALID && now - cached.i_liveedgeinfo >= VLC_TICK_FROM_SEC(1))
+        {
+            cached.i_liveedgeinfo = now;
+            b_info = true;
+        }
+    }
+    if(i_distance == VLC_TICK_INVALID)
+        return;
+
+    if(b_info && p_demux->p_input_item)
+        input_item_AddInfo(p_demux->p_input_item, _("Adaptive"), _("Live edge distance"),
+                           "%" PRId64 " ms", MS_FROM_VLC_TICK(i_distance));
+
+    /* Playing 5% faster until back within a segment chunk of the
+       target delay: moving the clock origin earlier by 1/20 of each
+       demuxed increment is not noticeable, unlike a rate change */
+    if(i_distance <= playlist->getLiveDelay() + VLC_TICK_FROM_MS(500))
+        return;
+
+    vlc_tick_t i_system, i_delay;
+    if(es_out_ControlGetPcrSystem(p_demux->out, &i_system, &i_delay) == VLC_SUCCESS)
+        es_out_ControlModifyPcrSystem(p_demux->out, true, i_system - increment / 20);
+}
+
 void * PlaylistManager::managerThread(void *opaque)
 {
     static_cast<PlaylistManager *>(opaque)->Run();
@@ -755,6 +828,7 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             if(predictivelogic)
                 conn->setDownloadRateObserver(predictivelogic);
             logic = predictivelogic;
+            break;
         }
 
         default:
@@ -765,6 +839,13 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
     {
         logic->setMaxDeviceResolution( var_InheritInteger(p_demux, "adaptive-maxwidth"),
                                        var_InheritInteger(p_demux, "adaptive-maxheight") );
+
+        char *psz_estimator = var_InheritString(p_demux, "adaptive-bw-estimator");
+        BandwidthMeter &meter = logic->getBandwidthMeter();
+        meter.setEstimator(BandwidthEstimator::create(psz_estimator ? psz_estimator : ""));
+        free(psz_estimator);
+        if(var_InheritBool(p_demux, "adaptive-bw-trace"))
+            meter.setTrace(VLC_OBJECT(p_demux));
     }
 
     return logic;
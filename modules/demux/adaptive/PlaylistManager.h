@@ -89,6 +89,8 @@ namespace adaptive
 
             void updateControlsPosition();
             void updateControlsContentType();
+            void updateLiveEdgeDistance();
+            void followLiveEdge(vlc_tick_t);
 
             /* local factories */
             virtual AbstractAdaptationLogic *createLogic(AbstractAdaptationLogic::LogicType,
@@ -124,6 +126,8 @@ namespace adaptive
                 vlc_tick_t  i_length;
                 vlc_tick_t  i_time;
                 double      f_position;
+                vlc_tick_t  i_liveedge; /* distance to the live edge */
+                vlc_tick_t  i_liveedgeinfo; /* last statistics update */
                 vlc_mutex_t lock;
             } cached;
 
@@ -76,9 +76,23 @@ SegmentTrackerEvent::SegmentTrackerEvent(const ID &id, vlc_tick_t duration)
     u.segment.id = &id;
 }
 
-SegmentTracker::SegmentTracker(AbstractAdaptationLogic *logic_, BaseAdaptationSet *adaptSet)
+SegmentTracker::PrefetchStats::PrefetchStats()
+{
+    hits = dry = cancelled = 0;
+}
+
+SegmentTracker::Prefetch::Prefetch(uint64_t number_, ISegment *segment_, SegmentChunk *chunk_)
+{
+    number = number_;
+    segment = segment_;
+    chunk = chunk_;
+}
+
+SegmentTracker::SegmentTracker(AbstractAdaptationLogic *logic_, BaseAdaptationSet *adaptSet,
+                               unsigned prefetch)
 {
     first = true;
+    prefetchDepth = prefetch;
     curNumber = next = 0;
     initializing = true;
     index_sent = false;
@@ -127,6 +141,7 @@ bool SegmentTracker::segmentsListReady() const
 
 void SegmentTracker::reset()
 {
+    flushPrefetched();
     notify(SegmentTrackerEvent(curRepresentation, NULL));
     curRepresentation = NULL;
     init_sent = false;
@@ -165,6 +180,7 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
 
     if(rep != curRepresentation)
     {
+        flushPrefetched();
         notify(SegmentTrackerEvent(curRepresentation, rep));
         prevRep = curRepresentation;
         curRepresentation = rep;
@@ -246,7 +262,9 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
         initializing = false;
     }
 
-    SegmentChunk *chunk = segment->toChunk(next, rep, connManager);
+    SegmentChunk *chunk = takePrefetched(segment, next);
+    if(!chunk)
+        chunk = segment->toChunk(next, rep, connManager);
 
     /* Notify new segment length for stats / logic */
     if(chunk)
@@ -273,11 +291,75 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
     {
         curNumber = next;
         next++;
+        prefetchChunks(rep, connManager);
     }
 
     return chunk;
 }
 
+SegmentChunk * SegmentTracker::takePrefetched(const ISegment *segment, uint64_t number)
+{
+    if(prefetchDepth == 0)
+        return NULL;
+
+    if(!prefetched.empty() &&
+       prefetched.front().segment == segment &&
+       prefetched.front().number == number)
+    {
+        SegmentChunk *chunk = prefetched.front().chunk;
+        prefetched.pop_front();
+        prefetchStats.hits++;
+        return chunk;
+    }
+
+    /* Lookahead is empty, or out of sequence (playlist update, gap) */
+    flushPrefetched();
+    prefetchStats.dry++;
+    return NULL;
+}
+
+void SegmentTracker::prefetchChunks(BaseRepresentation *rep, AbstractConnectionManager *connManager)
+{
+    uint64_t number = prefetched.empty() ? next : prefetched.back().number + 1;
+    while(prefetched.size() < prefetchDepth)
+    {
+        /* Don't request live segments that might not be published yet */
+        if(rep->getPlaylist()->isLive() && rep->getMinAheadTime(number) == 0)
+            break;
+
+        bool b_gap = false;
+        uint64_t found;
+        ISegment *segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA,
+                                                number, &found, &b_gap);
+        /* Gaps are discontinuities, which are handled when reached */
+        if(!segment || b_gap)
+            break;
+
+        SegmentChunk *chunk = segment->toChunk(found, rep, connManager);
+        if(!chunk)
+            break;
+
+        prefetched.push_back(Prefetch(found, segment, chunk));
+        number = found + 1;
+    }
+}
+
+void SegmentTracker::flushPrefetched()
+{
+    /* Deleting the chunks cancels their downloads */
+    while(!prefetched.empty())
+    {
+        delete prefetched.front().chunk;
+        prefetched.pop_front();
+        prefetchStats.cancelled++;
+    }
+}
+
+const SegmentTracker::PrefetchStats & SegmentTracker::getPrefetchStats() const
+{
+    return prefetchStats;
+}
+
 bool SegmentTracker::setPositionByTime(vlc_tick_t time, bool restarted, bool tryonly)
 {
     uint64_t segnumber;
@@ -297,6 +379,7 @@ bool SegmentTracker::setPositionByTime(vlc_tick_t time, bool restarted, bool try
 
 void SegmentTracker::setPositionByNumber(uint64_t segnumber, bool restarted)
 {
+    flushPrefetched();
     if(restarted)
     {
         initializing = true;
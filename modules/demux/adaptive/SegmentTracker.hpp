@@ -43,6 +43,7 @@ namespace adaptive
     {
         class BaseAdaptationSet;
         class BaseRepresentation;
+        class ISegment;
         class SegmentChunk;
     }
 
@@ -112,9 +113,18 @@ namespace adaptive
     class SegmentTracker
     {
         public:
-            SegmentTracker(AbstractAdaptationLogic *, BaseAdaptationSet *);
+            SegmentTracker(AbstractAdaptationLogic *, BaseAdaptationSet *, unsigned = 0);
             ~SegmentTracker();
 
+            class PrefetchStats
+            {
+                public:
+                    PrefetchStats();
+                    unsigned hits; /* media chunks served from the lookahead */
+                    unsigned dry; /* media chunks requested on demand */
+                    unsigned cancelled; /* lookahead chunks dropped */
+            };
+
             StreamFormat getCurrentFormat() const;
             bool segmentsListReady() const;
             void reset();
@@ -127,10 +137,22 @@ namespace adaptive
             void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t) const;
             void registerListener(SegmentTrackerListenerInterface *);
             void updateSelected();
+            const PrefetchStats & getPrefetchStats() const;
 
         private:
+            class Prefetch
+            {
+                public:
+                    Prefetch(uint64_t, ISegment *, SegmentChunk *);
+                    uint64_t number;
+                    ISegment *segment;
+                    SegmentChunk *chunk;
+            };
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const SegmentTrackerEvent &) const;
+            SegmentChunk * takePrefetched(const ISegment *, uint64_t);
+            void prefetchChunks(BaseRepresentation *, AbstractConnectionManager *);
+            void flushPrefetched();
             bool first;
             bool initializing;
             bool index_sent;
@@ -142,6 +164,9 @@ namespace adaptive
             BaseAdaptationSet *adaptationSet;
             BaseRepresentation *curRepresentation;
             std::list<SegmentTrackerListenerInterface *> listeners;
+            std::list<Prefetch> prefetched; /* of curRepresentation, in order */
+            unsigned prefetchDepth;
+            PrefetchStats prefetchStats;
     };
 }
 
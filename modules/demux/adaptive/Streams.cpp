@@ -103,7 +103,14 @@ AbstractStream::~AbstractStream()
 {
     delete currentChunk;
     if(segmentTracker)
+    {
+        const SegmentTracker::PrefetchStats &stats = segmentTracker->getPrefetchStats();
+        if(stats.hits || stats.dry)
+            msg_Dbg(p_realdemux, "%s stream %s prefetch: %u hits, ran dry %u times, "
+                    "%u cancelled", format.str().c_str(), description.c_str(),
+                    stats.hits, stats.dry, stats.cancelled);
         segmentTracker->notifyBufferingState(false);
+    }
     delete segmentTracker;
 
     delete demuxer;
@@ -642,6 +649,13 @@ void AbstractStream::trackerEvent(const SegmentTrackerEvent &event)
             }
             break;
 
+        case SegmentTrackerEvent::BUFFERING_LEVEL_CHANGE:
+            /* Lets the downloader serve the most starving stream first */
+            if(connManager)
+                connManager->updateBufferingLevel(*event.u.buffering_level.id,
+                                                  event.u.buffering_level.current);
+            break;
+
         default:
             break;
     }
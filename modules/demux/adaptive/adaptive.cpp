@@ -73,9 +73,53 @@ static void Close   (vlc_object_t *);
 
 #define ADAPT_LOGIC_TEXT N_("Adaptive Logic")
 
+#define ADAPT_BW_ESTIMATOR_TEXT N_("Bandwidth estimator")
+#define ADAPT_BW_ESTIMATOR_LONGTEXT N_("How the download rate samples of all " \
+                                       "streams are turned into the bandwidth " \
+                                       "estimate used by the adaptive logic")
+
+#define ADAPT_BW_TRACE_TEXT N_("Trace bandwidth estimates")
+#define ADAPT_BW_TRACE_LONGTEXT N_("Log every bandwidth sample along with " \
+                                   "the resulting estimate")
+
+#define ADAPT_DOWNLOADS_TEXT N_("Parallel downloads")
+#define ADAPT_DOWNLOADS_LONGTEXT N_("Maximum number of segments downloaded " \
+                                    "at the same time, across all streams")
+
+#define ADAPT_STREAM_DOWNLOADS_TEXT N_("Parallel downloads per stream")
+#define ADAPT_STREAM_DOWNLOADS_LONGTEXT N_("Maximum number of segments of " \
+                                           "a single stream downloaded at the same time")
+
+#define ADAPT_PREFETCH_TEXT N_("Segments prefetch")
+#define ADAPT_PREFETCH_LONGTEXT N_("Number of segments requested ahead " \
+                                   "of the one being demuxed")
+
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using HTTP access instead of custom HTTP code")
 
+#define ADAPT_HTTP2_TEXT N_("Use HTTP/2")
+#define ADAPT_HTTP2_LONGTEXT N_("Fetch HTTPS segments over a single shared " \
+                                "connection per server, using HTTP/2 when " \
+                                "the server supports it")
+
+#define ADAPT_CACHE_SIZE_TEXT N_("Segments cache size (MiB)")
+#define ADAPT_CACHE_SIZE_LONGTEXT N_("Keep downloaded on demand segments on " \
+                                     "disk, shared by all players, up to " \
+                                     "this size. 0 disables the cache")
+
+#define ADAPT_CACHE_DIR_TEXT N_("Segments cache directory")
+#define ADAPT_CACHE_DIR_LONGTEXT N_("Where the segments cache is stored, " \
+                                    "instead of the user cache directory")
+
+#define ADAPT_LOWLATENCY_TEXT N_("Low latency live")
+#define ADAPT_LOWLATENCY_LONGTEXT N_("Start live streams at the edge, read " \
+                                     "segments while they are being published " \
+                                     "and play slightly faster to keep up")
+
+#define ADAPT_LIVEDELAY_TEXT N_("Low latency live delay (ms)")
+#define ADAPT_LIVEDELAY_LONGTEXT N_("Target distance to the live edge when " \
+                                    "low latency is enabled")
+
 static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::Default,
                                 AbstractAdaptationLogic::Predictive,
@@ -102,6 +146,22 @@ static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Lowest Bandwidth/Quality"),
                                            N_("Highest Bandwidth/Quality")};
 
+static const char *const ppsz_bw_estimators_values[] = {
+                                "",
+                                "ewma",
+                                "window",
+                                "percentile",
+                                "vhf"};
+
+static const char *const ppsz_bw_estimators[] = { N_("Default"),
+                                                  N_("Exponential moving averages"),
+                                                  N_("Sliding window"),
+                                                  N_("Low percentile"),
+                                                  N_("Vertical Horizontal Filter")};
+
+static_assert( ARRAY_SIZE( ppsz_bw_estimators ) == ARRAY_SIZE( ppsz_bw_estimators_values ),
+    "ppsz_bw_estimators and ppsz_bw_estimators_values shall have the same number of elements" );
+
 static_assert( ARRAY_SIZE( pi_logics ) == ARRAY_SIZE( ppsz_logics ),
     "pi_logics and ppsz_logics shall have the same number of elements" );
 
@@ -121,7 +181,32 @@ vlc_module_begin ()
         add_integer( "adaptive-maxheight", 0,
                      ADAPT_HEIGHT_TEXT, ADAPT_HEIGHT_TEXT, false )
         add_integer( "adaptive-bw",     250, ADAPT_BW_TEXT,     ADAPT_BW_LONGTEXT,     false )
+        add_string( "adaptive-bw-estimator", "", ADAPT_BW_ESTIMATOR_TEXT,
+                    ADAPT_BW_ESTIMATOR_LONGTEXT, true )
+            change_string_list( ppsz_bw_estimators_values, ppsz_bw_estimators )
+        add_bool   ( "adaptive-bw-trace", false, ADAPT_BW_TRACE_TEXT,
+                     ADAPT_BW_TRACE_LONGTEXT, true )
         add_bool   ( "adaptive-use-access", false, ADAPT_ACCESS_TEXT, ADAPT_ACCESS_LONGTEXT, true );
+        add_bool   ( "adaptive-http2", true, ADAPT_HTTP2_TEXT, ADAPT_HTTP2_LONGTEXT, true )
+        add_integer( "adaptive-downloads", 3, ADAPT_DOWNLOADS_TEXT,
+                     ADAPT_DOWNLOADS_LONGTEXT, true )
+            change_integer_range( 1, 16 )
+        add_integer( "adaptive-stream-downloads", 1, ADAPT_STREAM_DOWNLOADS_TEXT,
+                     ADAPT_STREAM_DOWNLOADS_LONGTEXT, true )
+            change_integer_range( 1, 4 )
+        add_integer( "adaptive-prefetch", 1, ADAPT_PREFETCH_TEXT,
+                     ADAPT_PREFETCH_LONGTEXT, true )
+            change_integer_range( 0, 8 )
+        add_bool   ( "adaptive-lowlatency", false, ADAPT_LOWLATENCY_TEXT,
+                     ADAPT_LOWLATENCY_LONGTEXT, true )
+        add_integer( "adaptive-livedelay", 3000, ADAPT_LIVEDELAY_TEXT,
+                     ADAPT_LIVEDELAY_LONGTEXT, true )
+            change_integer_range( 500, 30000 )
+        add_integer( "adaptive-cache-size", 0, ADAPT_CACHE_SIZE_TEXT,
+                     ADAPT_CACHE_SIZE_LONGTEXT, true )
+            change_integer_range( 0, 1 << 20 )
+        add_directory( "adaptive-cache-dir", NULL, ADAPT_CACHE_DIR_TEXT,
+                       ADAPT_CACHE_DIR_LONGTEXT )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
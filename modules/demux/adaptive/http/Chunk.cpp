@@ -37,6 +37,10 @@
 
 using namespace adaptive::http;
 
+/* A low latency read lasting longer than this waited for the
+   encoder to publish the next chunk, not for the network */
+#define LOWLATENCY_IDLE_READ VLC_TICK_FROM_MS(100)
+
 AbstractChunkSource::AbstractChunkSource()
 {
     contentLength = 0;
@@ -215,7 +219,7 @@ block_t * HTTPChunkSource::read(size_t readsize)
         if((size_t)ret < readsize)
             eof = true;
         if(ret && time)
-            connManager->updateDownloadRate(sourceid, p_block->i_buffer, time);
+            connManager->updateDownloadRate(sourceid, p_block->i_buffer, time, vlc_tick_now());
     }
 
     return p_block;
@@ -224,10 +228,7 @@ block_t * HTTPChunkSource::read(size_t readsize)
 std::string HTTPChunkSource::getContentType() const
 {
     vlc_mutex_locker locker(&lock);
-    if(connection)
-        return connection->getContentType();
-    else
-        return std::string();
+    return contentType;
 }
 
 bool HTTPChunkSource::prepare()
@@ -255,13 +256,10 @@ bool HTTPChunkSource::prepare()
         {
             if(i_ret == VLC_ETIMEOUT) /* redirection */
             {
-                HTTPConnection *httpconn = dynamic_cast<HTTPConnection *>(connection);
-                if(httpconn)
-                    connparams = httpconn->getRedirection();
+                connparams = connection->getRedirection();
                 connection->setUsed(false);
                 connection = NULL;
-                if(httpconn)
-                    continue;
+                continue;
             }
             break;
         }
@@ -269,6 +267,7 @@ bool HTTPChunkSource::prepare()
         /* Because we don't know Chunk size at start, we need to get size
                from content length */
         contentLength = connection->getContentLength();
+        contentType = connection->getContentType();
         prepared = true;
         return true;
     }
@@ -293,6 +292,10 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
     eof = false;
     held = false;
     downloadstart = 0;
+    activesize = 0;
+    activetime = 0;
+    cachefile = NULL;
+    cachewriter = NULL;
 }
 
 HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
@@ -314,6 +317,8 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
     buffered = 0;
     vlc_mutex_unlock(&lock);
 
+    finishCache();
+
     vlc_cond_destroy(&avail);
 }
 
@@ -336,7 +341,7 @@ void HTTPChunkBufferedSource::release()
     vlc_cond_signal(&avail);
 }
 
-void HTTPChunkBufferedSource::bufferize(size_t readsize)
+void HTTPChunkBufferedSource::bufferize(size_t readsize, bool lowlatency)
 {
     vlc_mutex_lock(&lock);
     if(!prepare())
@@ -348,12 +353,18 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         return;
     }
 
-    if(readsize < HTTPChunkSource::CHUNK_SIZE)
-        readsize = HTTPChunkSource::CHUNK_SIZE;
+    /* Small reads hand over the chunks of a segment still being
+       produced as soon as they are received */
+    const size_t minsize = lowlatency ? HTTPChunkSource::LOWLATENCY_CHUNK_SIZE
+                                      : HTTPChunkSource::CHUNK_SIZE;
+    if(readsize < minsize)
+        readsize = minsize;
 
     if(contentLength && readsize > contentLength - buffered)
         readsize = contentLength - buffered;
 
+    FILE *file = cachefile;
+
     vlc_mutex_unlock(&lock);
 
     block_t *p_block = block_Alloc(readsize);
@@ -368,16 +379,31 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         size_t size;
         vlc_tick_t time;
     } rate = {0,0};
+    bool b_finished = false;
 
-    ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    const vlc_tick_t readstart = vlc_tick_now();
+    ssize_t ret;
+    if(file)
+    {
+        const size_t i_read = fread(p_block->p_buffer, 1, readsize, file);
+        ret = (i_read == 0 && ferror(file)) ? -1 : (ssize_t) i_read;
+    }
+    else
+    {
+        ret = connection->read(p_block->p_buffer, readsize);
+        if(ret > 0 && cachewriter)
+            cachewriter->write(p_block->p_buffer, ret);
+    }
+    const vlc_tick_t readend = vlc_tick_now();
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = NULL;
         vlc_mutex_locker locker( &lock );
         done = true;
+        b_finished = true;
         rate.size = buffered + consumed;
-        rate.time = vlc_tick_now() - downloadstart;
+        rate.time = readend - downloadstart;
         downloadstart = 0;
     }
     else
@@ -386,29 +412,79 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_mutex_locker locker( &lock );
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
+        if(lowlatency && readend - readstart < LOWLATENCY_IDLE_READ)
+        {
+            activesize += p_block->i_buffer;
+            activetime += readend - readstart;
+        }
         if((size_t) ret < readsize)
         {
             done = true;
+            b_finished = true;
             rate.size = buffered + consumed;
-            rate.time = vlc_tick_now() - downloadstart;
+            rate.time = readend - downloadstart;
             downloadstart = 0;
         }
     }
 
-    if(rate.size && rate.time)
+    /* The wall clock time of a segment read at the live edge is its
+       duration: only measure the network when it was the bottleneck */
+    if(rate.size && activetime && activesize >= rate.size / 2)
+    {
+        rate.size = activesize;
+        rate.time = activetime;
+    }
+
+    if(rate.size && rate.time && !file)
     {
-        connManager->updateDownloadRate(sourceid, rate.size, rate.time);
+        connManager->updateDownloadRate(sourceid, rate.size, rate.time, readend);
     }
 
+    if(b_finished)
+        finishCache();
+
     vlc_cond_signal(&avail);
 }
 
+void HTTPChunkBufferedSource::finishCache()
+{
+    /* Only ever called from the downloading thread, or once it is gone */
+    if(cachefile)
+    {
+        fclose(cachefile);
+        cachefile = NULL;
+    }
+
+    if(cachewriter)
+    {
+        connManager->getSegmentCache()->commit(cachewriter);
+        cachewriter = NULL;
+    }
+}
+
 bool HTTPChunkBufferedSource::prepare()
 {
     if(!prepared)
     {
         downloadstart = vlc_tick_now();
-        return HTTPChunkSource::prepare();
+        activesize = 0;
+        activetime = 0;
+
+        SegmentCache *cache = connManager ? connManager->getSegmentCache() : NULL;
+        if(cache && (cachefile = cache->open(params.getUrl(), bytesRange,
+                                           &contentLength, &contentType)))
+        {
+            prepared = true;
+            return true;
+        }
+
+        if(!HTTPChunkSource::prepare())
+            return false;
+
+        /* Unknown lengths are live or generated content */
+        if(cache && contentLength)
+            cachewriter = cache->store(params.getUrl(), bytesRange,
+                                       contentLength, contentType);
     }
     return true;
 }
@@ -27,6 +27,7 @@
 
 #include "BytesRange.hpp"
 #include "ConnectionParams.hpp"
+#include "SegmentCache.hpp"
 #include "../ID.hpp"
 #include <vector>
 #include <string>
@@ -96,6 +97,7 @@ namespace adaptive
                 virtual std::string getContentType  () const; /* reimpl */
 
                 static const size_t CHUNK_SIZE = 32768;
+                static const size_t LOWLATENCY_CHUNK_SIZE = 4096;
 
             protected:
                 virtual bool        prepare();
@@ -106,10 +108,11 @@ namespace adaptive
                 bool                prepared;
                 bool                eof;
                 ID                  sourceid;
+                ConnectionParams    params;
+                std::string         contentType;
 
             private:
                 bool init(const std::string &);
-                ConnectionParams    params;
         };
 
         class HTTPChunkBufferedSource : public HTTPChunkSource
@@ -128,8 +131,9 @@ namespace adaptive
 
             protected:
                 virtual bool       prepare(); /* reimpl */
-                void               bufferize(size_t);
+                void               bufferize(size_t, bool = false);
                 bool               isDone() const;
+                void               finishCache();
 
             private:
                 block_t            *p_head; /* read cache buffer */
@@ -138,6 +142,10 @@ namespace adaptive
                 bool                done;
                 bool                eof;
                 vlc_tick_t          downloadstart;
+                size_t              activesize; /* low latency, excluding encoder waits */
+                vlc_tick_t          activetime;
+                FILE               *cachefile; /* read from the segments cache */
+                SegmentCache::Writer *cachewriter;
                 vlc_cond_t          avail;
                 bool                held;
         };
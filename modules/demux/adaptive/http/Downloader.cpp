@@ -25,47 +25,59 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Job::Job(HTTPChunkBufferedSource *source_)
+{
+    source = source_;
+    busy = false;
+    cancelled = false;
+}
+
+Downloader::Downloader(unsigned workers, unsigned perstream, bool lowlatency_)
 {
     vlc_mutex_init(&lock);
     vlc_cond_init(&waitcond);
+    vlc_cond_init(&donecond);
     killed = false;
-    thread_handle_valid = false;
+    maxworkers = std::max(workers, 1U);
+    maxperstream = std::max(perstream, 1U);
+    lowlatency = lowlatency_;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    while(threads.size() < maxworkers)
     {
-        return false;
+        vlc_thread_t thread_handle;
+        if(vlc_clone(&thread_handle, downloaderThread,
+                     static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
+        threads.push_back(thread_handle);
     }
-    thread_handle_valid = true;
-    return true;
+    return !threads.empty();
 }
 
 Downloader::~Downloader()
 {
     vlc_mutex_lock( &lock );
     killed = true;
-    vlc_cond_signal(&waitcond);
+    vlc_cond_broadcast(&waitcond);
     vlc_mutex_unlock( &lock );
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, NULL);
+    for(size_t i=0; i<threads.size(); i++)
+        vlc_join(threads[i], NULL);
     vlc_mutex_destroy(&lock);
     vlc_cond_destroy(&waitcond);
+    vlc_cond_destroy(&donecond);
 }
 void Downloader::schedule(HTTPChunkBufferedSource *source)
 {
     vlc_mutex_lock(&lock);
     source->hold();
-    chunks.push_back(source);
+    chunks.push_back(Job(source));
     vlc_cond_signal(&waitcond);
     vlc_mutex_unlock(&lock);
 }
@@ -73,8 +85,23 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc_mutex_lock(&lock);
+    JobList::iterator it = findJob(source);
+    if(it != chunks.end())
+    {
+        /* Wait for the worker to leave the source */
+        (*it).cancelled = true;
+        while((*it).busy)
+            vlc_cond_wait(&donecond, &lock);
+        chunks.erase(it);
+    }
     source->release();
-    chunks.remove(source);
+    vlc_mutex_unlock(&lock);
+}
+
+void Downloader::updateBufferingLevel(const ID &id, vlc_tick_t level)
+{
+    vlc_mutex_lock(&lock);
+    levels[id] = level;
     vlc_mutex_unlock(&lock);
 }
 
@@ -90,7 +117,55 @@ void * Downloader::downloaderThread(void *opaque)
 void Downloader::DownloadSource(HTTPChunkBufferedSource *source)
 {
     if(!source->isDone())
-        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(lowlatency ? HTTPChunkSource::LOWLATENCY_CHUNK_SIZE
+                                     : HTTPChunkSource::CHUNK_SIZE, lowlatency);
+}
+
+Downloader::JobList::iterator Downloader::findJob(HTTPChunkBufferedSource *source)
+{
+    JobList::iterator it;
+    for(it = chunks.begin(); it != chunks.end(); ++it)
+        if((*it).source == source)
+            break;
+    return it;
+}
+
+unsigned Downloader::streamDownloads(const ID &id) const
+{
+    unsigned count = 0;
+    JobList::const_iterator it;
+    for(it = chunks.begin(); it != chunks.end(); ++it)
+        if((*it).busy && (*it).source->sourceid == id)
+            count++;
+    return count;
+}
+
+/* Picks the oldest queued source of the stream with the least
+ * buffered data, among those that can take one more download. */
+Downloader::JobList::iterator Downloader::nextJob()
+{
+    JobList::iterator best = chunks.end();
+    vlc_tick_t bestlevel = 0;
+
+    JobList::iterator it;
+    for(it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        const Job &job = *it;
+        if(job.busy || job.cancelled)
+            continue;
+
+        std::map<ID, vlc_tick_t>::const_iterator lit = levels.find(job.source->sourceid);
+        const vlc_tick_t level = (lit != levels.end()) ? (*lit).second : 0;
+        if(best != chunks.end() && level >= bestlevel)
+            continue;
+
+        if(streamDownloads(job.source->sourceid) >= maxperstream)
+            continue;
+
+        best = it;
+        bestlevel = level;
+    }
+    return best;
 }
 
 void Downloader::Run()
@@ -98,22 +173,30 @@ void Downloader::Run()
     vlc_mutex_lock(&lock);
     while(1)
     {
-        while(chunks.empty() && !killed)
+        JobList::iterator it;
+        while(!killed && (it = nextJob()) == chunks.end())
             vlc_cond_wait(&waitcond, &lock);
 
         if(killed)
             break;
 
-        if(!chunks.empty())
+        /* The job stays in the list while busy, as cancel() waits for it */
+        HTTPChunkBufferedSource *source = (*it).source;
+        (*it).busy = true;
+        vlc_mutex_unlock(&lock);
+
+        DownloadSource(source);
+
+        vlc_mutex_lock(&lock);
+        (*it).busy = false;
+        if(source->isDone() && !(*it).cancelled)
         {
-            HTTPChunkBufferedSource *source = chunks.front();
-            DownloadSource(source);
-            if(source->isDone())
-            {
-                chunks.pop_front();
-                source->release();
-            }
+            chunks.erase(it);
+            source->release();
         }
+        vlc_cond_broadcast(&donecond);
+        /* A download slot was freed for that stream */
+        vlc_cond_signal(&waitcond);
     }
     vlc_mutex_unlock(&lock);
 }
@@ -24,6 +24,8 @@
 
 #include <vlc_common.h>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace adaptive
 {
@@ -34,22 +36,40 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1, unsigned = 1, bool = false);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
+                void updateBufferingLevel(const ID &, vlc_tick_t);
 
             private:
+                class Job
+                {
+                    public:
+                        Job(HTTPChunkBufferedSource *);
+                        HTTPChunkBufferedSource *source;
+                        bool busy; /* a worker is downloading it */
+                        bool cancelled;
+                };
+                typedef std::list<Job> JobList;
+
                 static void * downloaderThread(void *);
                 void Run();
                 void DownloadSource(HTTPChunkBufferedSource *);
-                vlc_thread_t thread_handle;
+                JobList::iterator nextJob();
+                JobList::iterator findJob(HTTPChunkBufferedSource *);
+                unsigned streamDownloads(const ID &) const;
+                std::vector<vlc_thread_t> threads;
                 vlc_mutex_t  lock;
                 vlc_cond_t   waitcond;
-                bool         thread_handle_valid;
+                vlc_cond_t   donecond;
                 bool         killed;
-                std::list<HTTPChunkBufferedSource *> chunks;
+                unsigned     maxworkers;
+                unsigned     maxperstream;
+                bool         lowlatency;
+                JobList      chunks;
+                std::map<ID, vlc_tick_t> levels; /* buffered ahead, per stream */
         };
 
     }
@@ -28,8 +28,18 @@
 #include "../tools/Helper.h"
 
 #include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <vlc_stream.h>
+#include <vlc_block.h>
+
+extern "C"
+{
+    #include "../../../access/http/resource.h"
+    #include "../../../access/http/file.h"
+    #include "../../../access/http/message.h"
+    #include "../../../access/http/connmgr.h"
+}
 
 using namespace adaptive::http;
 
@@ -65,6 +75,11 @@ const std::string & AbstractConnection::getContentType() const
     return contentType;
 }
 
+const ConnectionParams & AbstractConnection::getRedirection() const
+{
+    return locationparams;
+}
+
 HTTPConnection::HTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
                                Transport *socket_, const ConnectionParams &proxy, bool persistent)
     : AbstractConnection( p_object_ )
@@ -353,8 +368,7 @@ std::string HTTPConnection::readLine()
 
 void HTTPConnection::setUsed( bool b )
 {
-    available = !b;
-    if(available)
+    if(!b)
     {
         if(!connectionClose && contentLength == bytesRead )
         {
@@ -366,6 +380,7 @@ void HTTPConnection::setUsed( bool b )
         else  /* We can't resend request if we haven't finished reading */
             disconnect();
     }
+    available = !b;
 }
 
 void HTTPConnection::onHeader(const std::string &key,
@@ -452,11 +467,6 @@ std::string HTTPConnection::extraRequestHeaders() const
     return ss.str();
 }
 
-const ConnectionParams & HTTPConnection::getRedirection() const
-{
-    return locationparams;
-}
-
 StreamUrlConnection::StreamUrlConnection(vlc_object_t *p_object)
     : AbstractConnection(p_object)
 {
@@ -562,9 +572,275 @@ ssize_t StreamUrlConnection::read(void *p_buffer, size_t len)
 
 void StreamUrlConnection::setUsed( bool b )
 {
-    available = !b;
-    if(available && contentLength == bytesRead)
+    if(!b && contentLength == bytesRead)
        reset();
+    available = !b;
+}
+
+LibVLCHTTPOrigin::LibVLCHTTPOrigin(vlc_object_t *p_object, AuthStorage *auth,
+                                   const ConnectionParams &params)
+{
+    scheme = params.getScheme();
+    hostname = params.getHostname();
+    port = params.getPort();
+    manager = vlc_http_mgr_create(p_object, auth ? auth->getJar() : NULL);
+    vlc_mutex_init(&lock);
+    b_multiplexed = true;
+}
+
+LibVLCHTTPOrigin::~LibVLCHTTPOrigin()
+{
+    if(manager)
+        vlc_http_mgr_destroy(manager);
+    vlc_mutex_destroy(&lock);
+}
+
+bool LibVLCHTTPOrigin::matches(const ConnectionParams &params) const
+{
+    return params.getScheme() == scheme &&
+           params.getHostname() == hostname &&
+           params.getPort() == port;
+}
+
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, LibVLCHTTPOrigin *origin_)
+    : AbstractConnection(p_object_)
+{
+    origin = origin_;
+    manager = NULL;
+    resource = NULL;
+    b_shared = false;
+    p_pending = NULL;
+    psz_useragent = var_InheritString(p_object_, "http-user-agent");
+}
+
+LibVLCHTTPConnection::~LibVLCHTTPConnection()
+{
+    reset();
+    if(manager)
+        vlc_http_mgr_destroy(manager);
+    free(psz_useragent);
+}
+
+void LibVLCHTTPConnection::reset()
+{
+    if(p_pending)
+        block_Release(p_pending);
+    p_pending = NULL;
+    /* Only closes our stream, the connection stays up for others */
+    if(resource)
+    {
+        if(b_shared)
+            vlc_mutex_lock(&origin->lock);
+        vlc_http_res_destroy(resource);
+        if(b_shared)
+            vlc_mutex_unlock(&origin->lock);
+    }
+    resource = NULL;
+    b_shared = false;
+    bytesRead = 0;
+    contentLength = 0;
+    contentType = std::string();
+    bytesRange = BytesRange();
+}
+
+bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
+{
+    return available && !params_.usesAccess() && origin->matches(params_);
+}
+
+int LibVLCHTTPConnection::request(const std::string &path, const BytesRange &range)
+{
+    reset();
+
+    /* Set new path for this query */
+    params.setPath(path);
+    locationparams = ConnectionParams();
+
+    msg_Dbg(p_object, "Retrieving %s @%zu", params.getUrl().c_str(),
+                      range.isValid() ? range.getStartByte() : 0);
+
+    if(!origin->manager)
+        return VLC_EGENERIC;
+
+    const uintmax_t start = range.isValid() ? range.getStartByte() : 0;
+    const uintmax_t end = (range.isValid() && range.getEndByte() > 0)
+                        ? range.getEndByte() : UINTMAX_MAX;
+    int status = -1;
+
+    /* Streams are multiplexed over the origin connection with HTTP/2.
+     * HTTP/1.x carries one at a time, so each connection then gets its own. */
+    vlc_mutex_lock(&origin->lock);
+    b_shared = origin->b_multiplexed;
+    if(b_shared)
+    {
+        status = open(origin->manager, start, end);
+        if(status >= 0 && !vlc_http_mgr_is_multiplexed(origin->manager))
+            origin->b_multiplexed = false;
+    }
+    vlc_mutex_unlock(&origin->lock);
+
+    if(!b_shared)
+    {
+        if(!manager)
+            manager = vlc_http_mgr_create(p_object,
+                                          vlc_http_mgr_get_jar(origin->manager));
+        if(manager)
+            status = open(manager, start, end);
+    }
+
+    if(status < 0)
+        return VLC_EGENERIC;
+
+    char *psz_redirect = vlc_http_file_get_redirect(resource);
+    if(psz_redirect)
+    {
+        locationparams = ConnectionParams(psz_redirect);
+        free(psz_redirect);
+        msg_Info(p_object, "%d redirection to %s", status, locationparams.getUrl().c_str());
+        return VLC_ETIMEOUT;
+    }
+
+    /* A server ignoring our range would send the whole resource */
+    if(status >= 300 || (start > 0 && status != 206))
+    {
+        msg_Err(p_object, "Failed reading %s: HTTP %d", params.getUrl().c_str(), status);
+        return VLC_ENOOBJ;
+    }
+
+    char *psz_type = vlc_http_file_get_type(resource);
+    if(psz_type)
+    {
+        contentType = std::string(psz_type);
+        free(psz_type);
+    }
+
+    uintmax_t size = vlc_http_file_get_size(resource);
+    if(size != (uintmax_t)-1 && size > start)
+        contentLength = size - start;
+    if(range.isValid() && range.getEndByte() > 0)
+    {
+        bytesRange = range;
+        contentLength = range.getEndByte() - range.getStartByte() + 1;
+    }
+    return VLC_SUCCESS;
+}
+
+int LibVLCHTTPConnection::open(struct vlc_http_mgr *mgr, uintmax_t start, uintmax_t end)
+{
+    resource = vlc_http_file_create(mgr, params.getUrl().c_str(),
+                                    psz_useragent, NULL);
+    if(!resource)
+        return -1;
+
+    /* Bounded ranges let the server keep the connection alive */
+    if(start > 0 || end != UINTMAX_MAX)
+        return vlc_http_file_seek_range(resource, start, end) ? -1
+                                                              : vlc_http_file_get_status(resource);
+    return vlc_http_file_get_status(resource);
+}
+
+ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
+{
+    if(!resource)
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    /* Data comes in frames, fill up the whole buffer */
+    size_t copied = 0;
+    while(copied < len)
+    {
+        if(!p_pending)
+        {
+            block_t *p_block = vlc_http_res_read(resource);
+            if(p_block == vlc_http_error)
+            {
+                if(copied == 0)
+                {
+                    reset();
+                    return -1;
+                }
+                break;
+            }
+            if(p_block == NULL) /* EOF */
+                break;
+            p_pending = p_block;
+        }
+
+        size_t chunk = std::min(len - copied, p_pending->i_buffer);
+        memcpy(&((uint8_t *)p_buffer)[copied], p_pending->p_buffer, chunk);
+        p_pending->p_buffer += chunk;
+        p_pending->i_buffer -= chunk;
+        if(p_pending->i_buffer == 0)
+        {
+            block_Release(p_pending);
+            p_pending = NULL;
+        }
+        copied += chunk;
+    }
+
+    bytesRead += copied;
+
+    if(copied < len || contentLength == bytesRead) /* set EOF */
+        reset();
+
+    return copied;
+}
+
+void LibVLCHTTPConnection::setUsed( bool b )
+{
+    if(!b)
+        reset();
+    available = !b;
+}
+
+LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
+    : AbstractConnectionFactory()
+{
+    authStorage = auth;
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    std::list<LibVLCHTTPOrigin *>::const_iterator it;
+    for(it = origins.begin(); it != origins.end(); ++it)
+        delete *it;
+}
+
+AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
+                                                                   const ConnectionParams &params)
+{
+    if((params.getScheme() != "http" && params.getScheme() != "https") || params.getHostname().empty())
+        return NULL;
+
+    LibVLCHTTPOrigin *origin = NULL;
+    std::list<LibVLCHTTPOrigin *>::const_iterator it;
+    for(it = origins.begin(); it != origins.end(); ++it)
+    {
+        if((*it)->matches(params))
+        {
+            origin = *it;
+            break;
+        }
+    }
+
+    if(!origin)
+    {
+        origin = new (std::nothrow) LibVLCHTTPOrigin(p_object, authStorage, params);
+        if(!origin)
+            return NULL;
+        origins.push_back(origin);
+    }
+
+    return new (std::nothrow) LibVLCHTTPConnection(p_object, origin);
 }
 
 NativeConnectionFactory::NativeConnectionFactory( AuthStorage *auth )
@@ -628,12 +904,14 @@ ConnectionFactory::ConnectionFactory( AuthStorage *authstorage )
 {
     native = new NativeConnectionFactory( authstorage );
     streamurl = new StreamUrlConnectionFactory();
+    libvlchttp = new LibVLCHTTPConnectionFactory( authstorage );
 }
 
 ConnectionFactory::~ConnectionFactory()
 {
     delete native;
     delete streamurl;
+    delete libvlchttp;
 }
 
 AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
@@ -642,6 +920,9 @@ AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
     bool b_streamurl = var_InheritBool(p_object, "adaptive-use-access");
     if(!b_streamurl && !params.usesAccess())
     {
+        /* HTTP/2 is only negotiated over TLS */
+        if(params.getScheme() == "https" && var_InheritBool(p_object, "adaptive-http2"))
+            return libvlchttp->createConnection(p_object, params);
         return native->createConnection(p_object, params);
     }
     else
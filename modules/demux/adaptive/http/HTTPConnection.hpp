@@ -29,6 +29,11 @@
 #include "BytesRange.hpp"
 #include <vlc_common.h>
 #include <string>
+#include <list>
+#include <atomic>
+
+struct vlc_http_mgr;
+struct vlc_http_resource;
 
 namespace adaptive
 {
@@ -52,11 +57,14 @@ namespace adaptive
                 virtual size_t  getContentLength() const;
                 virtual const std::string & getContentType() const;
                 virtual void    setUsed( bool ) = 0;
+                const ConnectionParams &getRedirection() const;
 
             protected:
                 vlc_object_t      *p_object;
                 ConnectionParams   params;
-                bool               available;
+                ConnectionParams   locationparams;
+                /* released without the manager lock, and only once reset */
+                std::atomic<bool>  available;
                 size_t             contentLength;
                 std::string        contentType;
                 BytesRange         bytesRange;
@@ -75,7 +83,6 @@ namespace adaptive
                 virtual ssize_t read        (void *p_buffer, size_t len);
 
                 void setUsed( bool );
-                const ConnectionParams &getRedirection() const;
                 static const unsigned MAX_REDIRECTS = 3;
 
             protected:
@@ -96,7 +103,6 @@ namespace adaptive
                 char * psz_useragent;
 
                 AuthStorage        *authStorage;
-                ConnectionParams    locationparams;
                 ConnectionParams    proxyparams;
                 bool                connectionClose;
                 bool                chunked;
@@ -128,6 +134,50 @@ namespace adaptive
                 stream_t *p_streamurl;
        };
 
+       /* Shared state of all libvlc HTTP connections to a same server.
+          The libvlc HTTP manager keeps a single connection, multiplexing
+          all requests when HTTP/2 is negotiated. */
+       class LibVLCHTTPOrigin
+       {
+            public:
+                LibVLCHTTPOrigin(vlc_object_t *, AuthStorage *, const ConnectionParams &);
+                ~LibVLCHTTPOrigin();
+                bool matches(const ConnectionParams &) const;
+
+                struct vlc_http_mgr *manager;
+                vlc_mutex_t lock; /* the manager is not thread-safe */
+                bool b_multiplexed; /* until the manager connects with HTTP/1.x */
+
+            private:
+                std::string scheme;
+                std::string hostname;
+                uint16_t port;
+       };
+
+       class LibVLCHTTPConnection : public AbstractConnection
+       {
+            public:
+                LibVLCHTTPConnection(vlc_object_t *, LibVLCHTTPOrigin *);
+                virtual ~LibVLCHTTPConnection();
+
+                virtual bool    canReuse     (const ConnectionParams &) const;
+
+                virtual int     request     (const std::string& path, const BytesRange & = BytesRange());
+                virtual ssize_t read        (void *p_buffer, size_t len);
+
+                virtual void    setUsed( bool );
+
+            protected:
+                void reset();
+                int open(struct vlc_http_mgr *, uintmax_t start, uintmax_t end);
+                LibVLCHTTPOrigin *origin;
+                struct vlc_http_mgr *manager; /* own one, without HTTP/2 */
+                struct vlc_http_resource *resource;
+                bool b_shared; /* resource from the origin manager */
+                block_t *p_pending; /* remainder of the last received data */
+                char *psz_useragent;
+       };
+
        class AbstractConnectionFactory
        {
            public:
@@ -154,6 +204,17 @@ namespace adaptive
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
        };
 
+       class LibVLCHTTPConnectionFactory : public AbstractConnectionFactory
+       {
+           public:
+               LibVLCHTTPConnectionFactory( AuthStorage * );
+               virtual ~LibVLCHTTPConnectionFactory();
+               virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
+           private:
+               AuthStorage *authStorage;
+               std::list<LibVLCHTTPOrigin *> origins;
+       };
+
        class ConnectionFactory : public AbstractConnectionFactory
        {
            public:
@@ -163,6 +224,7 @@ namespace adaptive
            private:
                NativeConnectionFactory *native;
                StreamUrlConnectionFactory *streamurl;
+               LibVLCHTTPConnectionFactory *libvlchttp;
        };
     }
 }
@@ -30,6 +30,7 @@
 #include "ConnectionParams.hpp"
 #include "Transport.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
 
@@ -40,17 +41,19 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
 {
     p_object = p_object_;
     rateObserver = NULL;
+    segmentCache = NULL;
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
 {
-
+    delete segmentCache;
 }
 
-void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size, vlc_tick_t time)
+void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size,
+                                                   vlc_tick_t time, vlc_tick_t end)
 {
     if(rateObserver)
-        rateObserver->updateDownloadRate(sourceid, size, time);
+        rateObserver->updateDownloadRate(sourceid, size, time, end);
 }
 
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
@@ -58,12 +61,22 @@ void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *o
     rateObserver = obs;
 }
 
+void AbstractConnectionManager::setSegmentCache(SegmentCache *cache)
+{
+    delete segmentCache;
+    segmentCache = cache;
+}
+
+SegmentCache * AbstractConnectionManager::getSegmentCache() const
+{
+    return segmentCache;
+}
+
 HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, AbstractConnectionFactory *factory_)
     : AbstractConnectionManager( p_object_ )
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
-    downloader->start();
+    createDownloader();
     factory = factory_;
 }
 
@@ -71,16 +84,27 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, AuthSt
     : AbstractConnectionManager( p_object_ )
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
-    downloader->start();
+    createDownloader();
     factory = new ConnectionFactory(storage);
 }
 
+void HTTPConnectionManager::createDownloader()
+{
+    /* By default, three workers and at most one per stream, so that a slow
+       audio, video or subtitles segment download does not stall the others */
+    unsigned workers = var_InheritInteger(p_object, "adaptive-downloads");
+    unsigned perstream = var_InheritInteger(p_object, "adaptive-stream-downloads");
+    bool lowlatency = var_InheritBool(p_object, "adaptive-lowlatency");
+    downloader = new (std::nothrow) Downloader(workers, perstream, lowlatency);
+    downloader->start();
+}
+
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
     delete downloader;
-    delete factory;
+    /* connections can depend on state owned by their factory */
     this->closeAllConnections();
+    delete factory;
     vlc_mutex_destroy(&lock);
 }
 
@@ -154,3 +178,8 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
     if(src)
         downloader->cancel(src);
 }
+
+void HTTPConnectionManager::updateBufferingLevel(const adaptive::ID &id, vlc_tick_t level)
+{
+    downloader->updateBufferingLevel(id, level);
+}
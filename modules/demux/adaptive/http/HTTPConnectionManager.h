@@ -42,6 +42,7 @@ namespace adaptive
         class AuthStorage;
         class Downloader;
         class AbstractChunkSource;
+        class SegmentCache;
 
         class AbstractConnectionManager : public IDownloadRateObserver
         {
@@ -52,15 +53,19 @@ namespace adaptive
                 virtual AbstractConnection * getConnection(ConnectionParams &) = 0;
                 virtual void start(AbstractChunkSource *) = 0;
                 virtual void cancel(AbstractChunkSource *) = 0;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t) = 0;
 
-                virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t); /* impl */
+                virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t, vlc_tick_t); /* impl */
                 void setDownloadRateObserver(IDownloadRateObserver *);
+                void setSegmentCache(SegmentCache *);
+                SegmentCache * getSegmentCache() const;
 
             protected:
                 vlc_object_t                                       *p_object;
 
             private:
                 IDownloadRateObserver                              *rateObserver;
+                SegmentCache                                       *segmentCache;
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
@@ -75,8 +80,10 @@ namespace adaptive
 
                 virtual void start(AbstractChunkSource *) /* impl */;
                 virtual void cancel(AbstractChunkSource *) /* impl */;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t) /* impl */;
 
             private:
+                void    createDownloader();
                 void    releaseAllConnections ();
                 Downloader                                         *downloader;
                 vlc_mutex_t                                         lock;
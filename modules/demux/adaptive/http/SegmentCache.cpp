@@ -0,0 +1,342 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+#include "BytesRange.hpp"
+
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include <vlc_configuration.h>
+
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+#include <vector>
+
+using namespace adaptive::http;
+
+#define SEGMENTCACHE_EXT ".seg"
+#define SEGMENTCACHE_TMP_EXT ".XXXXXX"
+#define SEGMENTCACHE_TYPE_MAX 255
+/* Temporary files left over by sessions which did not complete their write */
+#define SEGMENTCACHE_ORPHAN_AGE 3600
+
+SegmentCache::Writer::Writer(const std::string &key_, const std::string &tmppath_,
+                             int fd_, size_t expected_)
+{
+    key = key_;
+    tmppath = tmppath_;
+    fd = fd_;
+    expected = expected_;
+    written = 0;
+    failed = false;
+}
+
+bool SegmentCache::Writer::write(const void *data, size_t len)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while(!failed && len)
+    {
+        ssize_t ret = vlc_write(fd, p, len);
+        if(ret < 0 && errno == EINTR)
+            continue;
+        if(ret <= 0)
+        {
+            failed = true;
+            break;
+        }
+        p += ret;
+        len -= ret;
+        written += ret;
+    }
+    return !failed;
+}
+
+SegmentCache::SegmentCache(vlc_object_t *obj, const std::string &dir, uint64_t max)
+{
+    p_object = obj;
+    directory = dir;
+    maxsize = max;
+    totalsize = 0;
+    vlc_mutex_init(&lock);
+}
+
+SegmentCache::~SegmentCache()
+{
+    vlc_mutex_destroy(&lock);
+}
+
+SegmentCache * SegmentCache::create(vlc_object_t *obj)
+{
+    const uint64_t maxsize = (uint64_t) var_InheritInteger(obj, "adaptive-cache-size") << 20;
+    if(maxsize == 0)
+        return NULL;
+
+    std::string dir;
+    char *psz_dir = var_InheritString(obj, "adaptive-cache-dir");
+    if(psz_dir && *psz_dir)
+    {
+        dir = psz_dir;
+    }
+    else
+    {
+        char *psz_cachedir = config_GetUserDir(VLC_CACHE_DIR);
+        if(psz_cachedir)
+        {
+            vlc_mkdir(psz_cachedir, 0700);
+            dir = std::string(psz_cachedir) + DIR_SEP "adaptive";
+            free(psz_cachedir);
+        }
+    }
+    free(psz_dir);
+
+    if(dir.empty())
+        return NULL;
+    vlc_mkdir(dir.c_str(), 0700);
+
+    SegmentCache *cache = new (std::nothrow) SegmentCache(obj, dir, maxsize);
+    if(cache)
+    {
+        cache->scan();
+        msg_Dbg(obj, "segments cache %s, %" PRIu64 "/%" PRIu64 " MiB used",
+                dir.c_str(), cache->totalsize >> 20, maxsize >> 20);
+    }
+    return cache;
+}
+
+std::string SegmentCache::getKey(const std::string &url, const BytesRange &range) const
+{
+    std::ostringstream ss;
+    ss.imbue(std::locale("C"));
+    ss << url;
+    if(range.isValid())
+        ss << ' ' << range.getStartByte() << '-' << range.getEndByte();
+    const std::string str = ss.str();
+
+    struct md5_s md5;
+    InitMD5(&md5);
+    AddMD5(&md5, str.c_str(), str.length());
+    EndMD5(&md5);
+
+    std::string key;
+    char *psz_hash = psz_md5_hash(&md5);
+    if(psz_hash)
+    {
+        key = psz_hash;
+        free(psz_hash);
+    }
+    return key;
+}
+
+std::string SegmentCache::getPath(const std::string &key) const
+{
+    return directory + DIR_SEP + key + SEGMENTCACHE_EXT;
+}
+
+/* The content type comes first, on its own line */
+static bool readContentType(FILE *file, std::string *ptype)
+{
+    ptype->clear();
+    for(;;)
+    {
+        int c = getc(file);
+        if(c == EOF || ptype->length() > SEGMENTCACHE_TYPE_MAX)
+            return false;
+        if(c == '\n')
+            return true;
+        ptype->push_back((char) c);
+    }
+}
+
+FILE * SegmentCache::open(const std::string &url, const BytesRange &range, size_t *psize,
+                          std::string *ptype)
+{
+    const std::string key = getKey(url, range);
+    if(key.empty())
+        return NULL;
+
+    /* Always look on disk: other sessions can have stored it since */
+    FILE *file = vlc_fopen(getPath(key).c_str(), "rb");
+    struct stat st;
+    if(file && (fstat(fileno(file), &st) || !readContentType(file, ptype) ||
+                st.st_size <= ftell(file)))
+    {
+        fclose(file);
+        file = NULL;
+    }
+
+    vlc_mutex_locker locker(&lock);
+    std::map<std::string, Entry>::iterator it = entries.find(key);
+    if(!file)
+    {
+        if(it != entries.end()) /* evicted by another session */
+        {
+            totalsize -= (*it).second.size;
+            entries.erase(it);
+        }
+        return NULL;
+    }
+
+    if(it == entries.end())
+    {
+        Entry entry;
+        entry.size = st.st_size;
+        it = entries.insert(std::pair<std::string, Entry>(key, entry)).first;
+        totalsize += entry.size;
+    }
+    (*it).second.used = time(NULL);
+
+    *psize = st.st_size - ftell(file);
+    return file;
+}
+
+SegmentCache::Writer * SegmentCache::store(const std::string &url, const BytesRange &range,
+                                           size_t size, const std::string &type)
+{
+    if(size == 0 || size > maxsize / 4)
+        return NULL;
+
+    const std::string key = getKey(url, range);
+    if(key.empty())
+        return NULL;
+
+    /* Written aside and renamed once complete, so that
+       readers never see a partial segment */
+    const std::string tmppath = getPath(key) + SEGMENTCACHE_TMP_EXT;
+    std::vector<char> psz_tmp(tmppath.begin(), tmppath.end());
+    psz_tmp.push_back('\0');
+    int fd = vlc_mkstemp(&psz_tmp[0]);
+    if(fd == -1)
+        return NULL;
+
+    std::string header = type.substr(0, type.find_first_of("\r\n"));
+    if(header.length() > SEGMENTCACHE_TYPE_MAX)
+        header.clear();
+    header.push_back('\n');
+
+    Writer *writer = new (std::nothrow) Writer(key, &psz_tmp[0], fd, header.length() + size);
+    if(!writer || !writer->write(header.c_str(), header.length()))
+    {
+        delete writer;
+        vlc_close(fd);
+        vlc_unlink(&psz_tmp[0]);
+        return NULL;
+    }
+    return writer;
+}
+
+void SegmentCache::commit(Writer *writer)
+{
+    bool b_ok = !writer->failed && writer->written == writer->expected;
+    if(vlc_close(writer->fd))
+        b_ok = false;
+
+    if(b_ok && vlc_rename(writer->tmppath.c_str(), getPath(writer->key).c_str()) == 0)
+    {
+        vlc_mutex_locker locker(&lock);
+        Entry &entry = entries[writer->key];
+        totalsize = totalsize - entry.size + writer->written;
+        entry.size = writer->written;
+        entry.used = time(NULL);
+        evict();
+    }
+    else
+    {
+        vlc_unlink(writer->tmppath.c_str());
+    }
+    delete writer;
+}
+
+static bool compareEntryUse(const std::pair<time_t, std::string> &a,
+                            const std::pair<time_t, std::string> &b)
+{
+    return a.first < b.first;
+}
+
+void SegmentCache::evict()
+{
+    if(totalsize <= maxsize)
+        return;
+
+    std::vector<std::pair<time_t, std::string> > lru;
+    lru.reserve(entries.size());
+    std::map<std::string, Entry>::const_iterator it;
+    for(it = entries.begin(); it != entries.end(); ++it)
+        lru.push_back(std::pair<time_t, std::string>((*it).second.used, (*it).first));
+    std::sort(lru.begin(), lru.end(), compareEntryUse);
+
+    std::vector<std::pair<time_t, std::string> >::const_iterator lit;
+    for(lit = lru.begin(); lit != lru.end() && totalsize > maxsize; ++lit)
+    {
+        vlc_unlink(getPath((*lit).second).c_str());
+        std::map<std::string, Entry>::iterator eit = entries.find((*lit).second);
+        totalsize -= (*eit).second.size;
+        entries.erase(eit);
+    }
+}
+
+void SegmentCache::scan()
+{
+    DIR *dir = vlc_opendir(directory.c_str());
+    if(!dir)
+        return;
+
+    /* Sessions do not track each other's accesses: on start,
+       segments are ordered by the time they were stored */
+    vlc_mutex_locker locker(&lock);
+    const time_t now = time(NULL);
+    const char *psz_name;
+    while((psz_name = vlc_readdir(dir)) != NULL)
+    {
+        const std::string name(psz_name);
+        const size_t extlen = sizeof(SEGMENTCACHE_EXT) - 1;
+        const size_t tmpextlen = sizeof(SEGMENTCACHE_TMP_EXT) - 1;
+        if(name.length() < 32 + extlen || name.compare(32, extlen, SEGMENTCACHE_EXT))
+            continue;
+
+        const std::string path = directory + DIR_SEP + name;
+        struct stat st;
+        if(vlc_stat(path.c_str(), &st) || !S_ISREG(st.st_mode))
+            continue;
+
+        if(name.length() == 32 + extlen + tmpextlen)
+        {
+            /* Not renamed in time: its writer was interrupted */
+            if(now - st.st_mtime > SEGMENTCACHE_ORPHAN_AGE)
+                vlc_unlink(path.c_str());
+            continue;
+        }
+        else if(name.length() != 32 + extlen)
+            continue;
+
+        Entry entry;
+        entry.size = st.st_size;
+        entry.used = st.st_mtime;
+        entries[name.substr(0, 32)] = entry;
+        totalsize += entry.size;
+    }
+    closedir(dir);
+
+    evict();
+}
@@ -0,0 +1,91 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include <vlc_common.h>
+
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <string>
+
+namespace adaptive
+{
+    namespace http
+    {
+        class BytesRange;
+
+        /* On disk segments cache, shared by all sessions using the same
+           directory. Files are named after the hash of their url and
+           bytes range, and evicted least recently used first. Each file
+           starts with the segment content type, on its own line. */
+        class SegmentCache
+        {
+            public:
+                class Writer
+                {
+                    friend class SegmentCache;
+
+                    public:
+                        bool write(const void *, size_t);
+
+                    private:
+                        Writer(const std::string &, const std::string &, int, size_t);
+                        std::string key;
+                        std::string tmppath;
+                        int         fd;
+                        size_t      expected;
+                        size_t      written;
+                        bool        failed;
+                };
+
+                static SegmentCache * create(vlc_object_t *);
+                ~SegmentCache();
+
+                FILE *   open(const std::string &, const BytesRange &, size_t *, std::string *);
+                Writer * store(const std::string &, const BytesRange &, size_t, const std::string &);
+                void     commit(Writer *); /* keeps it only if fully written */
+
+            private:
+                SegmentCache(vlc_object_t *, const std::string &, uint64_t);
+                std::string getKey(const std::string &, const BytesRange &) const;
+                std::string getPath(const std::string &) const;
+                void scan();
+                void evict();
+
+                class Entry
+                {
+                    public:
+                        size_t   size;
+                        time_t   used;
+                };
+
+                vlc_object_t *p_object;
+                vlc_mutex_t   lock;
+                std::string   directory;
+                uint64_t      maxsize;
+                uint64_t      totalsize;
+                std::map<std::string, Entry> entries;
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
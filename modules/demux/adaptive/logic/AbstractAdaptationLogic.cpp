@@ -41,8 +41,15 @@ AbstractAdaptationLogic::~AbstractAdaptationLogic   ()
 {
 }
 
-void AbstractAdaptationLogic::updateDownloadRate    (const adaptive::ID &, size_t, vlc_tick_t)
+void AbstractAdaptationLogic::updateDownloadRate    (const adaptive::ID &, size_t size,
+                                                     vlc_tick_t time, vlc_tick_t end)
 {
+    bandwidth.push(size, time, end);
+}
+
+BandwidthMeter & AbstractAdaptationLogic::getBandwidthMeter()
+{
+    return bandwidth;
 }
 
 void AbstractAdaptationLogic::setMaxDeviceResolution (int w, int h)
@@ -0,0 +1,221 @@
+/*
+ * BandwidthEstimator.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "BandwidthEstimator.hpp"
+
+#include <vlc_threads.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace adaptive::logic;
+
+BandwidthEstimator * BandwidthEstimator::create(const std::string &name)
+{
+    if(name == "vhf")
+        return new (std::nothrow) VHFBandwidthEstimator();
+    else if(name == "window")
+        return new (std::nothrow) SlidingWindowBandwidthEstimator();
+    else if(name == "percentile")
+        return new (std::nothrow) PercentileBandwidthEstimator();
+    else /* default */
+        return new (std::nothrow) EWMABandwidthEstimator();
+}
+
+VHFBandwidthEstimator::VHFBandwidthEstimator()
+{
+    estimate = 0;
+}
+
+void VHFBandwidthEstimator::push(uint64_t bps, vlc_tick_t)
+{
+    estimate = average.push(bps);
+}
+
+uint64_t VHFBandwidthEstimator::getEstimate() const
+{
+    return estimate;
+}
+
+EWMABandwidthEstimator::Average::Average(vlc_tick_t halflife)
+{
+    alpha = std::exp(std::log(0.5) / secf_from_vlc_tick(halflife));
+    value = 0.0;
+    weight = 0.0;
+}
+
+void EWMABandwidthEstimator::Average::push(double sample, double seconds)
+{
+    const double a = std::pow(alpha, seconds);
+    value = a * value + (1.0 - a) * sample;
+    weight += seconds;
+}
+
+double EWMABandwidthEstimator::Average::get() const
+{
+    /* Unbias the first samples, the average starting from 0 */
+    const double zerofactor = 1.0 - std::pow(alpha, weight);
+    return (zerofactor > 0.0) ? value / zerofactor : 0.0;
+}
+
+EWMABandwidthEstimator::EWMABandwidthEstimator(vlc_tick_t fasthalflife,
+                                               vlc_tick_t slowhalflife)
+    : fast(fasthalflife), slow(slowhalflife)
+{
+}
+
+void EWMABandwidthEstimator::push(uint64_t bps, vlc_tick_t duration)
+{
+    const double seconds = secf_from_vlc_tick(duration);
+    fast.push(bps, seconds);
+    slow.push(bps, seconds);
+}
+
+uint64_t EWMABandwidthEstimator::getEstimate() const
+{
+    return std::min(fast.get(), slow.get());
+}
+
+SlidingWindowBandwidthEstimator::SlidingWindowBandwidthEstimator(vlc_tick_t window_)
+{
+    window = window_;
+    duration = 0;
+    bits = 0.0;
+}
+
+void SlidingWindowBandwidthEstimator::push(uint64_t bps, vlc_tick_t sampleduration)
+{
+    const double samplebits = bps * secf_from_vlc_tick(sampleduration);
+    samples.push_back(std::pair<double, vlc_tick_t>(samplebits, sampleduration));
+    bits += samplebits;
+    duration += sampleduration;
+
+    /* Always keep the last sample, even if longer than the window */
+    while(samples.size() > 1 && duration - samples.front().second >= window)
+    {
+        bits -= samples.front().first;
+        duration -= samples.front().second;
+        samples.pop_front();
+    }
+}
+
+uint64_t SlidingWindowBandwidthEstimator::getEstimate() const
+{
+    if(duration <= 0)
+        return 0;
+    return bits / secf_from_vlc_tick(duration);
+}
+
+PercentileBandwidthEstimator::PercentileBandwidthEstimator(unsigned percentile_, size_t count_)
+{
+    percentile = std::min(percentile_, 100U);
+    count = std::max(count_, (size_t) 1);
+}
+
+void PercentileBandwidthEstimator::push(uint64_t bps, vlc_tick_t)
+{
+    samples.push_back(bps);
+    if(samples.size() > count)
+        samples.pop_front();
+}
+
+uint64_t PercentileBandwidthEstimator::getEstimate() const
+{
+    if(samples.empty())
+        return 0;
+    std::vector<uint64_t> sorted(samples.begin(), samples.end());
+    const size_t index = (sorted.size() - 1) * percentile / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+BandwidthMeter::BandwidthMeter()
+{
+    estimator = NULL;
+    p_trace = NULL;
+    busyend = VLC_TICK_INVALID;
+    pendingtime = 0;
+    pendingsize = 0;
+    vlc_mutex_init(&lock);
+}
+
+BandwidthMeter::~BandwidthMeter()
+{
+    delete estimator;
+    vlc_mutex_destroy(&lock);
+}
+
+void BandwidthMeter::setEstimator(BandwidthEstimator *estimator_)
+{
+    vlc_mutex_locker locker(&lock);
+    delete estimator;
+    estimator = estimator_;
+}
+
+void BandwidthMeter::setTrace(vlc_object_t *obj)
+{
+    vlc_mutex_locker locker(&lock);
+    p_trace = obj;
+}
+
+void BandwidthMeter::push(size_t size, vlc_tick_t time, vlc_tick_t end)
+{
+    if(unlikely(time <= 0))
+        return;
+
+    vlc_mutex_locker locker(&lock);
+    if(!estimator && !(estimator = BandwidthEstimator::create(std::string())))
+        return;
+
+    /* Overlapping downloads share the link: only count the time
+       not already accounted for by another download */
+    const vlc_tick_t start = end - time;
+    if(busyend == VLC_TICK_INVALID || start >= busyend)
+        pendingtime += time;
+    else if(end > busyend)
+        pendingtime += end - busyend;
+    if(busyend == VLC_TICK_INVALID || end > busyend)
+        busyend = end;
+    pendingsize += size;
+
+    if(pendingtime < MIN_SAMPLE_DURATION)
+        return;
+
+    const uint64_t bps = CLOCK_FREQ * pendingsize * 8 / pendingtime;
+    estimator->push(bps, pendingtime);
+
+    if(p_trace)
+        msg_Dbg(p_trace, "bandwidth sample %" PRIu64 " kbps over %" PRId64 " ms,"
+                " estimate %" PRIu64 " kbps", bps / 1000,
+                MS_FROM_VLC_TICK(pendingtime), estimator->getEstimate() / 1000);
+
+    pendingtime = 0;
+    pendingsize = 0;
+}
+
+uint64_t BandwidthMeter::getEstimate() const
+{
+    vlc_mutex_locker locker(&lock);
+    return estimator ? estimator->getEstimate() : 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * BandwidthEstimator.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef BANDWIDTHESTIMATOR_HPP
+#define BANDWIDTHESTIMATOR_HPP
+
+#include "../tools/MovingAverage.hpp"
+
+#include <vlc_common.h>
+#include <deque>
+#include <string>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        /* Turns throughput samples, weighted by their duration,
+           into a bandwidth estimate in bits per second */
+        class BandwidthEstimator
+        {
+            public:
+                virtual ~BandwidthEstimator() {}
+                virtual void     push(uint64_t bps, vlc_tick_t duration) = 0;
+                virtual uint64_t getEstimate() const = 0;
+
+                static BandwidthEstimator * create(const std::string &);
+        };
+
+        /* Vertical Horizontal Filter, the historical estimator */
+        class VHFBandwidthEstimator : public BandwidthEstimator
+        {
+            public:
+                VHFBandwidthEstimator();
+                virtual void     push(uint64_t, vlc_tick_t); /* impl */
+                virtual uint64_t getEstimate() const; /* impl */
+
+            private:
+                MovingAverage<uint64_t> average;
+                uint64_t estimate;
+        };
+
+        /* Slow and fast exponential averages over time, keeping the lowest:
+           drops are followed quickly, increases only once they last */
+        class EWMABandwidthEstimator : public BandwidthEstimator
+        {
+            public:
+                EWMABandwidthEstimator(vlc_tick_t = VLC_TICK_FROM_SEC(2),
+                                       vlc_tick_t = VLC_TICK_FROM_SEC(8));
+                virtual void     push(uint64_t, vlc_tick_t); /* impl */
+                virtual uint64_t getEstimate() const; /* impl */
+
+            private:
+                class Average
+                {
+                    public:
+                        Average(vlc_tick_t);
+                        void   push(double, double);
+                        double get() const;
+
+                    private:
+                        double alpha;
+                        double value;
+                        double weight;
+                };
+                Average fast;
+                Average slow;
+        };
+
+        /* Bits received over the last window of download time */
+        class SlidingWindowBandwidthEstimator : public BandwidthEstimator
+        {
+            public:
+                SlidingWindowBandwidthEstimator(vlc_tick_t = VLC_TICK_FROM_SEC(10));
+                virtual void     push(uint64_t, vlc_tick_t); /* impl */
+                virtual uint64_t getEstimate() const; /* impl */
+
+            private:
+                std::deque<std::pair<double, vlc_tick_t> > samples;
+                vlc_tick_t window;
+                vlc_tick_t duration;
+                double     bits;
+        };
+
+        /* Low percentile of the recent samples, ignoring bursts */
+        class PercentileBandwidthEstimator : public BandwidthEstimator
+        {
+            public:
+                PercentileBandwidthEstimator(unsigned = 30, size_t = 20);
+                virtual void     push(uint64_t, vlc_tick_t); /* impl */
+                virtual uint64_t getEstimate() const; /* impl */
+
+            private:
+                std::deque<uint64_t> samples;
+                unsigned percentile;
+                size_t   count;
+        };
+
+        /* Shared by all the streams: merges the samples of parallel
+           downloads, and excludes the idle time between downloads */
+        class BandwidthMeter
+        {
+            public:
+                BandwidthMeter();
+                ~BandwidthMeter();
+                void     setEstimator(BandwidthEstimator *);
+                void     setTrace(vlc_object_t *);
+                void     push(size_t, vlc_tick_t, vlc_tick_t);
+                uint64_t getEstimate() const;
+
+                static const vlc_tick_t MIN_SAMPLE_DURATION = VLC_TICK_FROM_MS(250);
+
+            private:
+                BandwidthEstimator *estimator;
+                vlc_object_t       *p_trace;
+                vlc_tick_t          busyend;
+                vlc_tick_t          pendingtime;
+                size_t              pendingsize;
+                mutable vlc_mutex_t lock;
+        };
+    }
+}
+
+#endif // BANDWIDTHESTIMATOR_HPP
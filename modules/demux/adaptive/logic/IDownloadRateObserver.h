@@ -34,7 +34,8 @@ namespace adaptive
     class IDownloadRateObserver
     {
         public:
-            virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t) = 0;
+            /* size bytes received in time, ending at the given date */
+            virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t, vlc_tick_t) = 0;
             virtual ~IDownloadRateObserver(){}
     };
 }
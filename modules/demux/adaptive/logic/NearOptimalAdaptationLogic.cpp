@@ -47,12 +47,10 @@ NearOptimalContext::NearOptimalContext()
     : buffering_min( minimumBufferS )
     , buffering_level( 0 )
     , buffering_target( bufferTargetS )
-    , last_download_rate( 0 )
 { }
 
 NearOptimalAdaptationLogic::NearOptimalAdaptationLogic()
     : AbstractAdaptationLogic()
-    , currentBps( 0 )
     , usedBps( 0 )
 {
     vlc_mutex_init(&lock);
@@ -101,7 +99,7 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     }
     NearOptimalContext ctxcopy = (*it).second;
 
-    const unsigned bps = getAvailableBw(currentBps, prevRep);
+    const unsigned bps = getAvailableBw(bandwidth.getEstimate(), prevRep);
 
     vlc_mutex_unlock(&lock);
 
@@ -168,28 +166,6 @@ unsigned NearOptimalAdaptationLogic::getAvailableBw(unsigned i_bw, const BaseRep
     return i_remain > i_bw ? i_remain : i_bw;
 }
 
-unsigned NearOptimalAdaptationLogic::getMaxCurrentBw() const
-{
-    unsigned i_max_bitrate = 0;
-    for(std::map<ID, NearOptimalContext>::const_iterator it = streams.begin();
-                                                         it != streams.end(); ++it)
-        i_max_bitrate = std::max(i_max_bitrate, ((*it).second).last_download_rate);
-    return i_max_bitrate;
-}
-
-void NearOptimalAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, vlc_tick_t time)
-{
-    vlc_mutex_lock(&lock);
-    std::map<ID, NearOptimalContext>::iterator it = streams.find(id);
-    if(it != streams.end())
-    {
-        NearOptimalContext &ctx = (*it).second;
-        ctx.last_download_rate = ctx.average.push(CLOCK_FREQ * dlsize * 8 / time);
-    }
-    currentBps = getMaxCurrentBw();
-    vlc_mutex_unlock(&lock);
-}
-
 void NearOptimalAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
 {
     switch(event.type)
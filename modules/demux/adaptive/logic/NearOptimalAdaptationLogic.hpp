@@ -22,7 +22,6 @@
 
 #include "AbstractAdaptationLogic.h"
 #include "Representationselectors.hpp"
-#include "../tools/MovingAverage.hpp"
 #include <map>
 
 namespace adaptive
@@ -40,8 +39,6 @@ namespace adaptive
                 vlc_tick_t buffering_min;
                 vlc_tick_t buffering_level;
                 vlc_tick_t buffering_target;
-                unsigned last_download_rate;
-                MovingAverage<unsigned> average;
         };
 
         class NearOptimalAdaptationLogic : public AbstractAdaptationLogic
@@ -51,7 +48,6 @@ namespace adaptive
                 virtual ~NearOptimalAdaptationLogic();
 
                 virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
-                virtual void                updateDownloadRate     (const ID &, size_t, vlc_tick_t); /* reimpl */
                 virtual void                trackerEvent           (const SegmentTrackerEvent &); /* reimpl */
 
             private:
@@ -60,10 +56,8 @@ namespace adaptive
                                                                  vlc_tick_t Q /*current buffer level*/);
                 float                       getUtility(const BaseRepresentation *);
                 unsigned                    getAvailableBw(unsigned, const BaseRepresentation *) const;
-                unsigned                    getMaxCurrentBw() const;
                 std::map<adaptive::ID, NearOptimalContext> streams;
                 std::map<uint64_t, float>   utilities;
-                unsigned                    currentBps;
                 unsigned                    usedBps;
                 vlc_mutex_t                 lock;
         };
@@ -45,13 +45,12 @@ PredictiveStats::PredictiveStats()
     segments_count = 0;
     buffering_level = 0;
     buffering_target = 1;
-    last_download_rate = 0;
     last_duration = 1;
 }
 
 bool PredictiveStats::starting() const
 {
-    return (segments_count < 3) || !last_download_rate;
+    return segments_count < 3;
 }
 
 PredictiveAdaptationLogic::PredictiveAdaptationLogic(vlc_object_t *p_obj_)
@@ -85,7 +84,8 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
 
         double f_buffering_level = (double)stats.buffering_level / stats.buffering_target;
         double f_min_buffering_level = f_buffering_level;
-        unsigned i_max_bitrate = 0;
+        /* Link throughput, all streams downloads included */
+        const unsigned i_max_bitrate = bandwidth.getEstimate();
         if(streams.size() > 1)
         {
             std::map<ID, PredictiveStats>::const_iterator it2 = streams.begin();
@@ -97,11 +97,10 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
                 const PredictiveStats &other = (*it2).second;
                 f_min_buffering_level = std::min((double)other.buffering_level / other.buffering_target,
                                                  f_min_buffering_level);
-                i_max_bitrate = std::max(i_max_bitrate, other.last_download_rate);
             }
         }
 
-        if(stats.starting())
+        if(stats.starting() || !i_max_bitrate)
         {
             rep = selector.highest(adaptSet);
         }
@@ -153,18 +152,6 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
     return rep;
 }
 
-void PredictiveAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, vlc_tick_t time)
-{
-    vlc_mutex_lock(&lock);
-    std::map<ID, PredictiveStats>::iterator it = streams.find(id);
-    if(it != streams.end())
-    {
-        PredictiveStats &stats = (*it).second;
-        stats.last_download_rate = stats.average.push(CLOCK_FREQ * dlsize * 8 / time);
-    }
-    vlc_mutex_unlock(&lock);
-}
-
 unsigned PredictiveAdaptationLogic::getAvailableBw(unsigned i_bw, const BaseRepresentation *curRep) const
 {
     unsigned i_remain = i_bw;
@@ -21,7 +21,6 @@
 #define PREDICTIVEADAPTATIONLOGIC_HPP
 
 #include "AbstractAdaptationLogic.h"
-#include "../tools/MovingAverage.hpp"
 #include <map>
 
 namespace adaptive
@@ -40,9 +39,7 @@ namespace adaptive
                 size_t  segments_count;
                 vlc_tick_t buffering_level;
                 vlc_tick_t buffering_target;
-                unsigned last_download_rate;
                 vlc_tick_t last_duration;
-                MovingAverage<unsigned> average;
         };
 
         class PredictiveAdaptationLogic : public AbstractAdaptationLogic
@@ -52,7 +49,6 @@ namespace adaptive
                 virtual ~PredictiveAdaptationLogic();
 
                 virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
-                virtual void                updateDownloadRate     (const ID &, size_t, vlc_tick_t); /* reimpl */
                 virtual void                trackerEvent           (const SegmentTrackerEvent &); /* reimpl */
 
             private:
@@ -37,14 +37,10 @@ using namespace adaptive::logic;
 using namespace adaptive;
 
 RateBasedAdaptationLogic::RateBasedAdaptationLogic  (vlc_object_t *p_obj_) :
-                          AbstractAdaptationLogic   (),
-                          bpsAvg(0),
-                          currentBps(0)
+                          AbstractAdaptationLogic   ()
 {
     usedBps = 0;
-    dllength = 0;
     p_obj = p_obj_;
-    dlsize = 0;
     vlc_mutex_init(&lock);
 }
 
@@ -58,6 +54,8 @@ BaseRepresentation *RateBasedAdaptationLogic::getNextRepresentation(BaseAdaptati
     if(adaptSet == NULL)
         return NULL;
 
+    const size_t currentBps = bandwidth.getEstimate() * 3/4;
+
     vlc_mutex_lock(const_cast<vlc_mutex_t *>(&lock));
     size_t availBps = currentBps + ((currep) ? currep->getBandwidth() : 0);
     vlc_mutex_unlock(const_cast<vlc_mutex_t *>(&lock));
@@ -78,35 +76,6 @@ BaseRepresentation *RateBasedAdaptationLogic::getNextRepresentation(BaseAdaptati
     return rep;
 }
 
-void RateBasedAdaptationLogic::updateDownloadRate(const ID &, size_t size, vlc_tick_t time)
-{
-    if(unlikely(time == 0))
-        return;
-    /* Accumulate up to observation window */
-    dllength += time;
-    dlsize += size;
-
-    if(dllength < VLC_TICK_FROM_MS(250))
-        return;
-
-    const size_t bps = CLOCK_FREQ * dlsize * 8 / dllength;
-
-    vlc_mutex_lock(&lock);
-    bpsAvg = average.push(bps);
-
-//    BwDebug(msg_Dbg(p_obj, "alpha1 %lf alpha0 %lf dmax %ld ds %ld", alpha,
-//                    (double)deltamax / diffsum, deltamax, diffsum));
-    BwDebug(msg_Dbg(p_obj, "bw estimation bps %zu -> avg %zu",
-                            bps / 8000, bpsAvg / 8000));
-
-    currentBps = bpsAvg * 3/4;
-    dlsize = dllength = 0;
-
-    BwDebug(msg_Info(p_obj, "Current bandwidth %zu KiB/s using %u%%",
-                    (bpsAvg / 8000), (bpsAvg) ? (unsigned)(usedBps * 100.0 / bpsAvg) : 0));
-    vlc_mutex_unlock(&lock);
-}
-
 void RateBasedAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
 {
     if(event.type == SegmentTrackerEvent::SWITCHING)
@@ -117,7 +86,8 @@ void RateBasedAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
         if(event.u.switching.next)
             usedBps += event.u.switching.next->getBandwidth();
 
-        BwDebug(msg_Info(p_obj, "New bandwidth usage %zu KiB/s %u%%",
+        BwDebug(const uint64_t bpsAvg = bandwidth.getEstimate();
+                msg_Info(p_obj, "New bandwidth usage %zu KiB/s %u%%",
                         (usedBps / 8000), (bpsAvg) ? (unsigned)(usedBps * 100.0 / bpsAvg) : 0 ));
         vlc_mutex_unlock(&lock);
     }
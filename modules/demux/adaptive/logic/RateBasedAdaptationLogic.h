@@ -26,7 +26,6 @@
 #define RATEBASEDADAPTATIONLOGIC_H_
 
 #include "AbstractAdaptationLogic.h"
-#include "../tools/MovingAverage.hpp"
 
 namespace adaptive
 {
@@ -40,20 +39,12 @@ namespace adaptive
                 virtual ~RateBasedAdaptationLogic   ();
 
                 BaseRepresentation *getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
-                virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t); /* reimpl */
                 virtual void trackerEvent(const SegmentTrackerEvent &); /* reimpl */
 
             private:
-                size_t                  bpsAvg;
-                size_t                  currentBps;
                 size_t                  usedBps;
                 vlc_object_t *          p_obj;
 
-                MovingAverage<size_t>   average;
-
-                size_t                  dlsize;
-                vlc_tick_t              dllength;
-
                 vlc_mutex_t             lock;
         };
 
@@ -0,0 +1,465 @@
+/*****************************************************************************
+ * abrsim_test.cpp: offline simulator for the adaptation logics
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Replays bandwidth traces through the adaptation logics, the same way
+ * SegmentTracker and AbstractStream drive them: one getNextRepresentation()
+ * per segment, updateDownloadRate() per HTTPChunkSource block, and the
+ * tracker events for switching, segment and buffering changes.
+ *
+ * The HTTP server is simulated: each request pays a fixed round trip,
+ * then the body arrives at the trace throughput. Playback consumes the
+ * buffer in real time, stalls when it runs dry and resumes once the
+ * minimum buffering is reached again.
+ *
+ * Logics using the download rate are replayed once per bandwidth estimator.
+ *
+ * Usage: adaptive_abrsim_test [trace...]
+ * A trace file has one "<duration ms> <kbps>" step per line, and loops.
+ * Without arguments, built-in traces are replayed and sanity checked.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "AbstractAdaptationLogic.h"
+#include "AlwaysBestAdaptationLogic.h"
+#include "AlwaysLowestAdaptationLogic.hpp"
+#include "BandwidthEstimator.hpp"
+#include "NearOptimalAdaptationLogic.hpp"
+#include "PredictiveAdaptationLogic.hpp"
+#include "RateBasedAdaptationLogic.h"
+
+#include "../playlist/AbstractPlaylist.hpp"
+#include "../playlist/BasePeriod.h"
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../http/Chunk.h"
+#include "../SegmentTracker.hpp"
+#include "../ID.hpp"
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::logic;
+using namespace adaptive::playlist;
+using namespace adaptive::http;
+
+namespace
+{
+    class SimPlaylist : public AbstractPlaylist
+    {
+        public:
+            SimPlaylist() : AbstractPlaylist(NULL) {}
+            virtual bool isLive() const { return false; } /* impl */
+            virtual void debug() {} /* impl */
+    };
+
+    struct TraceStep
+    {
+        vlc_tick_t duration;
+        uint64_t   bps;
+    };
+
+    /* Piecewise constant throughput, looping over its steps */
+    class BandwidthTrace
+    {
+        public:
+            BandwidthTrace(const std::string &name_) : name(name_), length(0) {}
+
+            void add(vlc_tick_t duration, uint64_t bps)
+            {
+                TraceStep step;
+                step.duration = duration;
+                step.bps = bps;
+                steps.push_back(step);
+                length += duration;
+            }
+
+            bool isValid() const
+            {
+                std::vector<TraceStep>::const_iterator it;
+                for(it = steps.begin(); it != steps.end(); ++it)
+                    if((*it).bps && (*it).duration > 0)
+                        return true;
+                return false;
+            }
+
+            /* Returns the time needed to receive size bytes from start */
+            vlc_tick_t transfer(vlc_tick_t start, size_t size) const
+            {
+                double bits = size * 8.0;
+                vlc_tick_t now = start;
+                vlc_tick_t offset = start % length;
+                size_t i = 0;
+                while(offset >= steps[i].duration)
+                    offset -= steps[i++].duration;
+                for(;;)
+                {
+                    const TraceStep &step = steps[i];
+                    const vlc_tick_t remain = step.duration - offset;
+                    const double capacity = step.bps * secf_from_vlc_tick(remain);
+                    if(capacity >= bits)
+                    {
+                        now += vlc_tick_from_sec(bits / step.bps);
+                        break;
+                    }
+                    bits -= capacity;
+                    now += remain;
+                    offset = 0;
+                    i = (i + 1) % steps.size();
+                }
+                return std::max(now - start, VLC_TICK_FROM_US(1));
+            }
+
+            std::string name;
+
+        private:
+            std::vector<TraceStep> steps;
+            vlc_tick_t length;
+    };
+
+    struct SimParams
+    {
+        vlc_tick_t segment_duration;
+        unsigned   segment_count;
+        vlc_tick_t rtt;
+        vlc_tick_t min_buffering;
+        vlc_tick_t max_buffering;
+    };
+
+    struct SimResult
+    {
+        vlc_tick_t startup;
+        vlc_tick_t rebuffering;
+        unsigned   stalls;
+        unsigned   switches;
+        uint64_t   avg_bitrate;
+        uint64_t   first_bitrate;
+        uint64_t   downloaded;
+    };
+
+    class Player
+    {
+        public:
+            Player(const SimParams &params_) : params(params_)
+            {
+                now = 0;
+                buffer = 0;
+                started = playing = false;
+            }
+
+            /* Advances the clock, consuming the buffer when playing */
+            void elapse(vlc_tick_t duration, SimResult *res)
+            {
+                now += duration;
+                if(!started)
+                    return;
+                if(!playing)
+                {
+                    res->rebuffering += duration;
+                }
+                else if(duration > buffer)
+                {
+                    res->rebuffering += duration - buffer;
+                    res->stalls++;
+                    buffer = 0;
+                    playing = false;
+                }
+                else buffer -= duration;
+            }
+
+            void feed(vlc_tick_t duration, bool last, SimResult *res)
+            {
+                buffer += duration;
+                if(!playing && (buffer >= params.min_buffering || last))
+                {
+                    if(!started)
+                        res->startup = now;
+                    started = playing = true;
+                }
+            }
+
+            vlc_tick_t now;
+            vlc_tick_t buffer;
+            const SimParams &params;
+
+        private:
+            bool started;
+            bool playing;
+    };
+}
+
+static SimResult simulate(AbstractAdaptationLogic *logic, BaseAdaptationSet *set,
+                          const BandwidthTrace &trace, const SimParams &params)
+{
+    SimResult res;
+    memset(&res, 0, sizeof(res));
+
+    Player player(params);
+    const ID &id = set->getID();
+    BaseRepresentation *rep = NULL;
+    uint64_t bitrates = 0;
+    const size_t chunk = HTTPChunkSource::CHUNK_SIZE;
+
+    logic->trackerEvent(SegmentTrackerEvent(id, true));
+    logic->trackerEvent(SegmentTrackerEvent(id, params.min_buffering, 0,
+                                            params.max_buffering));
+
+    for(unsigned n = 0; n < params.segment_count; n++)
+    {
+        /* Buffer full: wait until a segment can be appended */
+        if(player.buffer + params.segment_duration > params.max_buffering)
+            player.elapse(player.buffer + params.segment_duration
+                          - params.max_buffering, &res);
+
+        BaseRepresentation *next = logic->getNextRepresentation(set, rep);
+        assert(next);
+        if(next != rep)
+        {
+            logic->trackerEvent(SegmentTrackerEvent(rep, next));
+            if(rep)
+                res.switches++;
+            else
+                res.first_bitrate = next->getBandwidth();
+            rep = next;
+        }
+        logic->trackerEvent(SegmentTrackerEvent(id, params.segment_duration));
+
+        const size_t size = rep->getBandwidth() * secf_from_vlc_tick(params.segment_duration) / 8;
+        player.elapse(params.rtt, &res);
+        for(size_t done = 0; done < size; )
+        {
+            const size_t block = std::min(size - done, chunk);
+            const vlc_tick_t time = trace.transfer(player.now, block);
+            player.elapse(time, &res);
+            logic->updateDownloadRate(id, block, time, player.now);
+            done += block;
+
+            /* Demuxed amount grows as the data arrives */
+            player.feed(params.segment_duration * block / size,
+                        n + 1 == params.segment_count && done == size, &res);
+            logic->trackerEvent(SegmentTrackerEvent(id, params.min_buffering,
+                                                    player.buffer,
+                                                    params.max_buffering));
+        }
+        res.downloaded += size;
+        bitrates += rep->getBandwidth();
+    }
+
+    logic->trackerEvent(SegmentTrackerEvent(rep, NULL));
+    logic->trackerEvent(SegmentTrackerEvent(id, false));
+
+    res.avg_bitrate = bitrates / params.segment_count;
+    return res;
+}
+
+static BaseAdaptationSet * createAdaptationSet(AbstractPlaylist *playlist)
+{
+    static const uint64_t ladder[] = { 300000, 750000, 1200000, 1850000,
+                                       2850000, 4300000, 6000000, 8000000 };
+
+    BasePeriod *period = new BasePeriod(playlist);
+    playlist->addPeriod(period);
+    BaseAdaptationSet *set = new BaseAdaptationSet(period);
+    set->setID(ID("video"));
+    period->addAdaptationSet(set);
+    for(size_t i = 0; i < ARRAY_SIZE(ladder); i++)
+    {
+        BaseRepresentation *rep = new BaseRepresentation(set);
+        rep->setBandwidth(ladder[i]);
+        set->addRepresentation(rep);
+    }
+    return set;
+}
+
+static AbstractAdaptationLogic * createLogic(AbstractAdaptationLogic::LogicType type)
+{
+    switch(type)
+    {
+        case AbstractAdaptationLogic::AlwaysBest:
+            return new AlwaysBestAdaptationLogic();
+        case AbstractAdaptationLogic::AlwaysLowest:
+            return new AlwaysLowestAdaptationLogic();
+        case AbstractAdaptationLogic::RateBased:
+            return new RateBasedAdaptationLogic(NULL);
+        case AbstractAdaptationLogic::Predictive:
+            return new PredictiveAdaptationLogic(NULL);
+        case AbstractAdaptationLogic::NearOptimal:
+            return new NearOptimalAdaptationLogic();
+        default:
+            return NULL;
+    }
+}
+
+static const struct
+{
+    AbstractAdaptationLogic::LogicType type;
+    const char *name;
+} logics[] = {
+    { AbstractAdaptationLogic::AlwaysLowest, "lowest" },
+    { AbstractAdaptationLogic::AlwaysBest,   "highest" },
+    { AbstractAdaptationLogic::RateBased,    "rate" },
+    { AbstractAdaptationLogic::Predictive,   "predictive" },
+    { AbstractAdaptationLogic::NearOptimal,  "nearoptimal" },
+};
+
+static const char *const estimators[] = { "ewma", "window", "percentile", "vhf" };
+
+static bool loadTrace(const char *path, BandwidthTrace *trace)
+{
+    FILE *file = fopen(path, "r");
+    if(!file)
+        return false;
+
+    char line[256];
+    while(fgets(line, sizeof(line), file))
+    {
+        unsigned long ms, kbps;
+        if(line[0] == '#')
+            continue;
+        if(sscanf(line, "%lu %lu", &ms, &kbps) == 2)
+            trace->add(VLC_TICK_FROM_MS(ms), (uint64_t) kbps * 1000);
+    }
+    fclose(file);
+    return trace->isValid();
+}
+
+static std::vector<BandwidthTrace> builtinTraces()
+{
+    std::vector<BandwidthTrace> traces;
+
+    BandwidthTrace fast("constant 20M");
+    fast.add(VLC_TICK_FROM_SEC(1), 20000000);
+    traces.push_back(fast);
+
+    BandwidthTrace slow("constant 1M");
+    slow.add(VLC_TICK_FROM_SEC(1), 1000000);
+    traces.push_back(slow);
+
+    BandwidthTrace step("step 10M/1.5M");
+    step.add(VLC_TICK_FROM_SEC(120), 10000000);
+    step.add(VLC_TICK_FROM_SEC(120), 1500000);
+    traces.push_back(step);
+
+    BandwidthTrace oscillating("oscillating");
+    oscillating.add(VLC_TICK_FROM_SEC(15), 6000000);
+    oscillating.add(VLC_TICK_FROM_SEC(15), 800000);
+    traces.push_back(oscillating);
+
+    /* Deterministic cellular-like profile, with short outages */
+    BandwidthTrace cellular("cellular");
+    uint32_t seed = 1;
+    for(unsigned i = 0; i < 300; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        const unsigned r = (seed >> 16) % 100;
+        const uint64_t bps = r < 5 ? 0 : 400000 + r * 60000;
+        cellular.add(VLC_TICK_FROM_MS(500 + (seed >> 8) % 1500), bps);
+    }
+    traces.push_back(cellular);
+
+    return traces;
+}
+
+int main(int argc, char *argv[])
+{
+    SimParams params;
+    params.segment_duration = VLC_TICK_FROM_SEC(4);
+    params.segment_count = 150;
+    params.rtt = VLC_TICK_FROM_MS(50);
+
+    SimPlaylist playlist;
+    params.min_buffering = playlist.getMinBuffering();
+    params.max_buffering = playlist.getMaxBuffering();
+    BaseAdaptationSet *set = createAdaptationSet(&playlist);
+    const std::vector<BaseRepresentation *> &reps = set->getRepresentations();
+
+    std::vector<BandwidthTrace> traces;
+    for(int i = 1; i < argc; i++)
+    {
+        BandwidthTrace trace(argv[i]);
+        if(!loadTrace(argv[i], &trace))
+        {
+            fprintf(stderr, "cannot load trace %s\n", argv[i]);
+            return 1;
+        }
+        traces.push_back(trace);
+    }
+    const bool builtin = traces.empty();
+    if(builtin)
+        traces = builtinTraces();
+
+    printf("%-16s %-12s %-10s %9s %9s %6s %9s %8s\n", "trace", "logic", "estimator",
+           "startup", "rebuffer", "stalls", "kbps", "switches");
+
+    std::vector<BandwidthTrace>::const_iterator it;
+    for(it = traces.begin(); it != traces.end(); ++it)
+    {
+        for(size_t i = 0; i < ARRAY_SIZE(logics); i++)
+        for(size_t j = 0; j < ARRAY_SIZE(estimators); j++)
+        {
+            const bool b_fixed = logics[i].type == AbstractAdaptationLogic::AlwaysLowest ||
+                                 logics[i].type == AbstractAdaptationLogic::AlwaysBest;
+            if(b_fixed && j > 0)
+                break;
+
+            AbstractAdaptationLogic *logic = createLogic(logics[i].type);
+            assert(logic);
+            logic->getBandwidthMeter().setEstimator(BandwidthEstimator::create(estimators[j]));
+            const SimResult res = simulate(logic, set, *it, params);
+            delete logic;
+
+            printf("%-16s %-12s %-10s %8.2fs %8.2fs %6u %9" PRIu64 " %8u\n",
+                   (*it).name.c_str(), logics[i].name, b_fixed ? "-" : estimators[j],
+                   secf_from_vlc_tick(res.startup),
+                   secf_from_vlc_tick(res.rebuffering), res.stalls,
+                   res.avg_bitrate / 1000, res.switches);
+
+            assert(res.startup > 0);
+            assert(res.rebuffering >= 0);
+            assert(res.avg_bitrate >= reps.front()->getBandwidth());
+            assert(res.avg_bitrate <= reps.back()->getBandwidth());
+
+            if(b_fixed)
+                assert(res.switches == 0);
+
+            if(!builtin)
+                continue;
+
+            /* Enough bandwidth for every representation */
+            if(it == traces.begin())
+                assert(res.rebuffering == 0);
+            /* The lowest representation fits in the slowest link */
+            if(logics[i].type == AbstractAdaptationLogic::AlwaysLowest &&
+               (*it).name != "cellular")
+                assert(res.rebuffering == 0);
+        }
+    }
+
+    return 0;
+}
@@ -44,6 +44,7 @@ AbstractPlaylist::AbstractPlaylist (vlc_object_t *p_object_) :
     minUpdatePeriod.Set( VLC_TICK_FROM_SEC(2) );
     maxSegmentDuration.Set( 0 );
     minBufferTime = 0;
+    lowLatencyDelay = 0;
     timeShiftBufferDepth.Set( 0 );
     suggestedPresentationDelay.Set( 0 );
 }
@@ -86,15 +87,35 @@ void AbstractPlaylist::setMinBuffering( vlc_tick_t min )
 
 vlc_tick_t AbstractPlaylist::getMinBuffering() const
 {
+    if(isLowLatency())
+        return lowLatencyDelay / 2;
     return std::max(minBufferTime, VLC_TICK_FROM_SEC(6));
 }
 
 vlc_tick_t AbstractPlaylist::getMaxBuffering() const
 {
+    /* Anything buffered past the target delay is latency */
+    if(isLowLatency())
+        return lowLatencyDelay;
     const vlc_tick_t minbuf = getMinBuffering();
     return std::max(minbuf, VLC_TICK_FROM_SEC(60));
 }
 
+void AbstractPlaylist::setLowLatency( vlc_tick_t delay )
+{
+    lowLatencyDelay = delay;
+}
+
+bool AbstractPlaylist::isLowLatency() const
+{
+    return lowLatencyDelay > 0 && isLive();
+}
+
+vlc_tick_t AbstractPlaylist::getLiveDelay() const
+{
+    return lowLatencyDelay;
+}
+
 Url AbstractPlaylist::getUrlSegment() const
 {
     Url ret;
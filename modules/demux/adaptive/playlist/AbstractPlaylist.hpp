@@ -45,6 +45,9 @@ namespace adaptive
                 void                            setMinBuffering( vlc_tick_t );
                 vlc_tick_t                      getMinBuffering() const;
                 vlc_tick_t                      getMaxBuffering() const;
+                void                            setLowLatency( vlc_tick_t );
+                bool                            isLowLatency() const;
+                vlc_tick_t                      getLiveDelay() const;
                 virtual void                    debug() = 0;
 
                 void    addPeriod               (BasePeriod *period);
@@ -77,6 +80,7 @@ namespace adaptive
                 std::string                         playlistUrl;
                 std::string                         type;
                 vlc_tick_t                          minBufferTime;
+                vlc_tick_t                          lowLatencyDelay;
         };
     }
 }
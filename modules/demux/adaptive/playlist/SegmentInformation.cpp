@@ -164,11 +164,15 @@ std::size_t SegmentInformation::getAllSegments(std::vector<ISegment *> &retSegme
 
 uint64_t SegmentInformation::getLiveStartSegmentNumber(uint64_t def) const
 {
-    const vlc_tick_t i_max_buffering = getPlaylist()->getMaxBuffering() +
-                                    /* FIXME: add dynamic pts-delay */ VLC_TICK_FROM_SEC(1);
+    /* Low latency starts on the segment being produced, which
+       is then consumed chunk by chunk as it is being published */
+    const bool b_lowlatency = getPlaylist()->isLowLatency();
+    vlc_tick_t i_max_buffering = getPlaylist()->getMaxBuffering();
+    if( !b_lowlatency )
+        i_max_buffering += /* FIXME: add dynamic pts-delay */ VLC_TICK_FROM_SEC(1);
 
     /* Try to never buffer up to really end */
-    const uint64_t OFFSET_FROM_END = 3;
+    const uint64_t OFFSET_FROM_END = b_lowlatency ? 0 : 3;
 
     if( mediaSegmentTemplate )
     {
@@ -203,7 +207,9 @@ uint64_t SegmentInformation::getLiveStartSegmentNumber(uint64_t def) const
             if( i_delay == 0 || i_delay > getPlaylist()->timeShiftBufferDepth.Get() )
                  i_delay = getPlaylist()->timeShiftBufferDepth.Get();
 
-            if( i_delay < getPlaylist()->getMinBuffering() )
+            if( b_lowlatency )
+                i_delay = getPlaylist()->getLiveDelay();
+            else if( i_delay < getPlaylist()->getMinBuffering() )
                 i_delay = getPlaylist()->getMinBuffering();
 
             const uint64_t startnumber = mediaSegmentTemplate->startNumber.Get();
@@ -476,6 +482,20 @@ void SegmentInformation::mergeWithTimeline(SegmentTimeline *updated)
     }
 }
 
+void SegmentInformation::mergeWithTemplateTimeline(SegmentTimeline *updated, vlc_tick_t prunetime)
+{
+    if(mediaSegmentTemplate)
+        mediaSegmentTemplate->mergeWithTimeline(updated, prunetime);
+}
+
+bool SegmentInformation::getLastListedSegmentNumber(uint64_t *ret) const
+{
+    if(!segmentList || segmentList->getSegments().empty())
+        return false;
+    *ret = segmentList->getSegments().back()->getSequenceNumber();
+    return true;
+}
+
 void SegmentInformation::pruneByPlaybackTime(vlc_tick_t time)
 {
     if(segmentList)
@@ -82,6 +82,8 @@ namespace adaptive
                 uint64_t getLiveStartSegmentNumber(uint64_t) const;
                 virtual void mergeWith(SegmentInformation *, vlc_tick_t);
                 virtual void mergeWithTimeline(SegmentTimeline *); /* ! don't use with global merge */
+                void mergeWithTemplateTimeline(SegmentTimeline *, vlc_tick_t); /* own template only */
+                bool getLastListedSegmentNumber(uint64_t *) const; /* own list only */
                 virtual void pruneBySegmentNumber(uint64_t);
                 virtual void pruneByPlaybackTime(vlc_tick_t);
                 virtual uint64_t translateSegmentNumber(uint64_t, const SegmentInformation *) const;
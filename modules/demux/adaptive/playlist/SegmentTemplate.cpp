@@ -43,17 +43,24 @@ MediaSegmentTemplate::MediaSegmentTemplate( SegmentInformation *parent ) :
     debugName = "SegmentTemplate";
     classId = Segment::CLASSID_SEGMENT;
     startNumber.Set( 1 );
+    availabilityTimeOffset.Set( 0 );
     initialisationSegment.Set( NULL );
     templated = true;
     parentSegmentInformation = parent;
 }
 
 void MediaSegmentTemplate::mergeWith(MediaSegmentTemplate *updated, vlc_tick_t prunebarrier)
+{
+    if(updated->segmentTimeline.Get())
+        mergeWithTimeline(updated->segmentTimeline.Get(), prunebarrier);
+}
+
+void MediaSegmentTemplate::mergeWithTimeline(SegmentTimeline *updated, vlc_tick_t prunebarrier)
 {
     SegmentTimeline *timeline = segmentTimeline.Get();
-    if(timeline && updated->segmentTimeline.Get())
+    if(timeline)
     {
-        timeline->mergeWith(*updated->segmentTimeline.Get());
+        timeline->mergeWith(*updated);
         if(prunebarrier)
         {
             const Timescale timescale = timeline->inheritTimescale();
@@ -90,7 +97,18 @@ uint64_t MediaSegmentTemplate::getCurrentLiveTemplateNumber() const
         time_t streamstart = parentSegmentInformation->getPlaylist()->availabilityStartTime.Get();
         streamstart += parentSegmentInformation->getPeriodStart();
         stime_t elapsed = timescale.ToScaled(vlc_tick_from_sec(playbacktime - streamstart));
-        number += elapsed / dur - 2;
+        if(parentSegmentInformation->getPlaylist()->isLowLatency())
+        {
+            /* Segments are published availabilityTimeOffset before their end,
+               so that the one being produced can be read as chunked transfer */
+            elapsed += timescale.ToScaled(availabilityTimeOffset.Get());
+            if(elapsed >= dur)
+                number += elapsed / dur - 1;
+        }
+        else
+        {
+            number += elapsed / dur - 2;
+        }
     }
 
     return number;
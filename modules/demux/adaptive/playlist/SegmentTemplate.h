@@ -51,6 +51,7 @@ namespace adaptive
                 MediaSegmentTemplate( SegmentInformation * = NULL );
                 virtual void setSourceUrl( const std::string &url ); /* reimpl */
                 void mergeWith( MediaSegmentTemplate *, vlc_tick_t );
+                void mergeWithTimeline( SegmentTimeline *, vlc_tick_t );
                 virtual uint64_t getSequenceNumber() const; /* reimpl */
                 uint64_t getCurrentLiveTemplateNumber() const;
                 stime_t getMinAheadScaledTime(uint64_t) const;
@@ -58,6 +59,7 @@ namespace adaptive
                 size_t pruneBySequenceNumber(uint64_t);
                 virtual void debug(vlc_object_t *, int = 0) const; /* reimpl */
                 Property<size_t>        startNumber;
+                Property<vlc_tick_t>    availabilityTimeOffset;
 
             protected:
                 SegmentInformation *parentSegmentInformation;
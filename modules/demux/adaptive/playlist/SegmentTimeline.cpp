@@ -43,111 +43,107 @@ SegmentTimeline::SegmentTimeline(uint64_t scale)
 
 SegmentTimeline::~SegmentTimeline()
 {
-    std::list<Element *>::iterator it;
-    for(it = elements.begin(); it != elements.end(); ++it)
-        delete *it;
 }
 
 void SegmentTimeline::addElement(uint64_t number, stime_t d, uint64_t r, stime_t t)
 {
-    Element *element = new (std::nothrow) Element(number, d, r, t);
-    if(element)
+    Element element(number, d, r, t);
+    if(!elements.empty())
     {
-        if(!elements.empty() && !t)
-        {
-            const Element *el = elements.back();
-            element->t = el->t + (el->d * (el->r + 1));
-        }
-        elements.push_back(element);
+        const Element &el = elements.back();
+        if(!t)
+            element.t = el.t + el.span();
+        element.elapsed = el.elapsed + el.span();
     }
+    elements.push_back(element);
 }
 
-vlc_tick_t SegmentTimeline::getMinAheadScaledTime(uint64_t number) const
+bool SegmentTimeline::lastNumberLess(const Element &el, uint64_t number)
 {
-    stime_t totalscaledtime = 0;
-
-    std::list<Element *>::const_reverse_iterator it;
-    for(it = elements.rbegin(); it != elements.rend(); ++it)
-    {
-        const Element *el = *it;
+    return el.last() < number;
+}
 
-        if(number < el->number)
-        {
-            totalscaledtime += (el->d * (el->r + 1));
-            break;
-        }
-        else if(number <= el->number + el->r)
-        {
-            totalscaledtime += el->d * (el->number + el->r - number);
-        }
-        else break;
-    }
+bool SegmentTimeline::timeLess(stime_t time, const Element &el)
+{
+    return time < el.t;
+}
 
-    return totalscaledtime;
+std::vector<SegmentTimeline::Element>::const_iterator
+SegmentTimeline::findByNumber(uint64_t number) const
+{
+    /* first element ending at or after number */
+    return std::lower_bound(elements.begin(), elements.end(),
+                            number, lastNumberLess);
 }
 
-uint64_t SegmentTimeline::getElementNumberByScaledPlaybackTime(stime_t scaled) const
+stime_t SegmentTimeline::getMinAheadScaledTime(uint64_t number) const
 {
-    uint64_t prevnumber = 0;
-    std::list<Element *>::const_iterator it;
-    for(it = elements.begin(); it != elements.end(); ++it)
-    {
-        const Element *el = *it;
-        if(it == elements.begin())
-        {
-            scaled -= el->t;
-            prevnumber = el->number;
-        }
+    if(elements.empty())
+        return 0;
 
-        for(uint64_t repeat = 1 + el->r; repeat; repeat--)
-        {
-            if(el->d >= scaled)
-                return prevnumber;
+    const Element &last = elements.back();
+    const stime_t total = last.elapsed + last.span();
 
-            scaled -= el->d;
-            prevnumber++;
-        }
+    std::vector<Element>::const_iterator it = findByNumber(number);
+    if(it == elements.end())
+        return 0;
+    if(number < it->number)
+        return total - it->elapsed;
+    return total - it->elapsed - it->d * (number - it->number + 1);
+}
 
-        /* might have been discontinuity */
-        prevnumber = el->number;
-    }
+uint64_t SegmentTimeline::getElementNumberByScaledPlaybackTime(stime_t scaled) const
+{
+    if(elements.empty())
+        return 0;
 
-    return prevnumber;
+    /* last element starting at or before that time */
+    std::vector<Element>::const_iterator it =
+            std::upper_bound(elements.begin(), elements.end(),
+                             scaled, timeLess);
+    if(it == elements.begin())
+        return it->number;
+
+    const Element &el = *(--it);
+    if(el.d == 0)
+        return el.number;
+
+    const uint64_t offset = (scaled - el.t) / el.d;
+    if(offset <= el.r)
+        return el.number + offset;
+
+    /* in a gap, or past the end */
+    if(++it != elements.end())
+        return it->number;
+    return el.last();
 }
 
 bool SegmentTimeline::getScaledPlaybackTimeDurationBySegmentNumber(uint64_t number,
                                                                    stime_t *time, stime_t *duration) const
 {
-    stime_t totalscaledtime = 0;
-    stime_t lastduration = 0;
-
-    std::list<Element *>::const_iterator it;
-    for(it = elements.begin(); it != elements.end(); ++it)
+    if(elements.empty())
     {
-        const Element *el = *it;
-
-        /* set start time, or from discontinuity */
-        if(it == elements.begin() || el->t)
-        {
-            totalscaledtime = el->t;
-        }
-
-        lastduration = el->d;
-
-        if(number <= el->number)
-            break;
-
-        if(number <= el->number + el->r)
-        {
-            totalscaledtime += el->d * (number - el->number);
-            break;
-        }
-
-        totalscaledtime += (el->d * (el->r + 1));
+        *time = *duration = 0;
+        return true;
     }
 
-    *time = totalscaledtime;
-    *duration = lastduration;
+    std::vector<Element>::const_iterator it = findByNumber(number);
+    if(it == elements.end())
+    {
+        const Element &last = elements.back();
+        *time = last.t + last.span();
+        *duration = last.d;
+    }
+    else if(number <= it->number)
+    {
+        *time = it->t;
+        *duration = it->d;
+    }
+    else
+    {
+        *time = it->t + it->d * (number - it->number);
+        *duration = it->d;
+    }
     return true;
 }
 
@@ -162,16 +158,14 @@ uint64_t SegmentTimeline::maxElementNumber() const
 {
     if(elements.empty())
         return 0;
-
-    const Element *e = elements.back();
-    return e->number + e->r;
+    return elements.back().last();
 }
 
 uint64_t SegmentTimeline::minElementNumber() const
 {
     if(elements.empty())
         return 0;
-    return elements.front()->number;
+    return elements.front().number;
 }
 
 void SegmentTimeline::pruneByPlaybackTime(vlc_tick_t time)
@@ -183,31 +177,25 @@ void SegmentTimeline::pruneByPlaybackTime(vlc_tick_t time)
 
 size_t SegmentTimeline::pruneBySequenceNumber(uint64_t number)
 {
+    if(elements.empty() || number <= elements.front().number)
+        return 0;
+
+    std::vector<Element>::iterator it = elements.begin() + (findByNumber(number) - elements.begin());
     size_t prunednow = 0;
-    while(elements.size())
+
+    for(std::vector<Element>::const_iterator el = elements.begin(); el != it; ++el)
+        prunednow += el->r + 1;
+    it = elements.erase(elements.begin(), it);
+
+    if(it != elements.end() && number > it->number) /* middle of a repeat */
     {
-        Element *el = elements.front();
-        if(el->number >= number)
-        {
-            break;
-        }
-        else if(el->number + el->r >= number)
-        {
-            uint64_t count = number - el->number;
-            el->number += count;
-            el->t += count * el->d;
-            el->r -= count;
-            prunednow += count;
-            break;
-        }
-        else
-        {
-            prunednow += el->r + 1;
-            elements.pop_front();
-            delete el;
-        }
+        const uint64_t count = number - it->number;
+        it->number += count;
+        it->t += count * it->d;
+        it->elapsed += count * it->d;
+        it->r -= count;
+        prunednow += count;
     }
-
     return prunednow;
 }
 
@@ -215,37 +203,30 @@ void SegmentTimeline::mergeWith(SegmentTimeline &other)
 {
     if(elements.empty())
     {
-        while(other.elements.size())
-        {
-            elements.push_back(other.elements.front());
-            other.elements.pop_front();
-        }
+        elements.swap(other.elements);
         return;
     }
 
-    Element *last = elements.back();
-    while(other.elements.size())
-    {
-        Element *el = other.elements.front();
-        other.elements.pop_front();
+    elements.reserve(elements.size() + other.elements.size());
 
-        if(last->contains(el->t)) /* Same element, but prev could have been middle of repeat */
-        {
-            const uint64_t count = (el->t - last->t) / last->d;
-            last->r = std::max(last->r, el->r + count);
-            delete el;
-        }
-        else if(el->t < last->t)
+    std::vector<Element>::const_iterator it;
+    for(it = other.elements.begin(); it != other.elements.end(); ++it)
+    {
+        Element &last = elements.back();
+        if(last.contains(it->t)) /* Same element, but prev could have been middle of repeat */
         {
-            delete el;
+            const uint64_t count = (it->t - last.t) / last.d;
+            last.r = std::max(last.r, it->r + count);
         }
-        else /* Did not exist in previous list */
+        else if(it->t >= last.t) /* Did not exist in previous list */
         {
+            Element el = *it;
+            el.number = last.last() + 1;
+            el.elapsed = last.elapsed + last.span();
             elements.push_back(el);
-            el->number = last->number + last->r + 1;
-            last = el;
         }
     }
+    other.elements.clear();
 }
 
 void SegmentTimeline::debug(vlc_object_t *obj, int indent) const
@@ -254,9 +235,9 @@ void SegmentTimeline::debug(vlc_object_t *obj, int indent) const
     ss << std::string(indent, ' ') << "Timeline";
     msg_Dbg(obj, "%s", ss.str().c_str());
 
-    std::list<Element *>::const_iterator it;
+    std::vector<Element>::const_iterator it;
     for(it = elements.begin(); it != elements.end(); ++it)
-        (*it)->debug(obj, indent + 1);
+        it->debug(obj, indent + 1);
 }
 
 SegmentTimeline::Element::Element(uint64_t number_, stime_t d_, uint64_t r_, stime_t t_)
@@ -265,11 +246,22 @@ SegmentTimeline::Element::Element(uint64_t number_, stime_t d_, uint64_t r_, sti
     d = d_;
     t = t_;
     r = r_;
+    elapsed = 0;
+}
+
+stime_t SegmentTimeline::Element::span() const
+{
+    return d * (stime_t)(r + 1);
+}
+
+uint64_t SegmentTimeline::Element::last() const
+{
+    return number + r;
 }
 
 bool SegmentTimeline::Element::contains(stime_t time) const
 {
-    if(time >= t && time < t + (stime_t)(r + 1) * d)
+    if(time >= t && time < t + span())
         return true;
     return false;
 }
@@ -26,7 +26,7 @@
 
 #include "SegmentInfoCommon.h"
 #include <vlc_common.h>
-#include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -34,8 +34,6 @@ namespace adaptive
     {
         class SegmentTimeline : public TimescaleAble
         {
-            class Element;
-
             public:
                 SegmentTimeline(TimescaleAble *);
                 SegmentTimeline(uint64_t);
@@ -53,19 +51,26 @@ namespace adaptive
                 void debug(vlc_object_t *, int = 0) const;
 
             private:
-                std::list<Element *> elements;
-
                 class Element
                 {
                     public:
                         Element(uint64_t, stime_t, uint64_t, stime_t);
                         void debug(vlc_object_t *, int = 0) const;
                         bool contains(stime_t) const;
+                        stime_t  span() const;
+                        uint64_t last() const;
                         stime_t  t;
                         stime_t  d;
                         uint64_t r;
                         uint64_t number;
+                        stime_t  elapsed; /* total duration of the previous elements */
                 };
+
+                /* Sorted by both time and number */
+                std::vector<Element> elements;
+                std::vector<Element>::const_iterator findByNumber(uint64_t) const;
+                static bool lastNumberLess(const Element &, uint64_t);
+                static bool timeLess(stime_t, const Element &);
         };
     }
 }
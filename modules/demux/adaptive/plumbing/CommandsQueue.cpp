@@ -28,7 +28,6 @@
 #include <vlc_block.h>
 #include <vlc_meta.h>
 #include <algorithm>
-#include <set>
 
 using namespace adaptive;
 
@@ -185,8 +184,33 @@ void EsOutMetaCommand::Execute( es_out_t *out )
  * Commands Default Factory
  */
 
+CommandsFactory::CommandsFactory()
+{
+    vlc_mutex_init(&lock);
+}
+
+CommandsFactory::~CommandsFactory()
+{
+    std::vector<EsOutSendCommand *>::const_iterator it;
+    for( it = pool.begin(); it != pool.end(); ++it )
+        delete *it;
+    vlc_mutex_destroy(&lock);
+}
+
 EsOutSendCommand * CommandsFactory::createEsOutSendCommand( FakeESOutID *id, block_t *p_block ) const
 {
+    /* One per packet, reuse released ones */
+    vlc_mutex_lock(&lock);
+    if( !pool.empty() )
+    {
+        EsOutSendCommand *command = pool.back();
+        pool.pop_back();
+        vlc_mutex_unlock(&lock);
+        command->p_fakeid = id;
+        command->p_block = p_block;
+        return command;
+    }
+    vlc_mutex_unlock(&lock);
     return new (std::nothrow) EsOutSendCommand( id, p_block );
 }
 
@@ -226,6 +250,28 @@ EsOutMetaCommand * CommandsFactory::createEsOutMetaCommand( int group, const vlc
     return NULL;
 }
 
+void CommandsFactory::releaseCommand( AbstractCommand *command ) const
+{
+    if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
+    {
+        EsOutSendCommand *sendcommand = static_cast<EsOutSendCommand *>(command);
+        if( sendcommand->p_block )
+        {
+            block_Release( sendcommand->p_block );
+            sendcommand->p_block = NULL;
+        }
+        vlc_mutex_lock(&lock);
+        if( pool.size() < MAX_POOLED )
+        {
+            pool.push_back( sendcommand );
+            vlc_mutex_unlock(&lock);
+            return;
+        }
+        vlc_mutex_unlock(&lock);
+    }
+    delete command;
+}
+
 /*
  * Commands Queue management
  */
@@ -249,47 +295,54 @@ CommandsQueue::CommandsQueue( CommandsFactory *f )
     b_eof = false;
     commandsFactory = f;
     vlc_mutex_init(&lock);
+    vlc_mutex_init(&incominglock);
 }
 
 CommandsQueue::~CommandsQueue()
 {
     Abort( false );
     delete commandsFactory;
+    vlc_mutex_destroy(&incominglock);
     vlc_mutex_destroy(&lock);
 }
 
-static bool compareCommands( AbstractCommand *a, AbstractCommand *b )
+static bool compareKeys( const std::pair<vlc_tick_t, AbstractCommand *> &a,
+                         const std::pair<vlc_tick_t, AbstractCommand *> &b )
 {
-    if(a->getTime() == b->getTime())
-    {
-        /* Reorder the initial clock PCR setting PCR0 DTS0 PCR0 DTS1 PCR1
-           so it appears after the block, avoiding it not being output */
-        if(a->getType() == ES_OUT_SET_GROUP_PCR &&
-           b->getType() == ES_OUT_PRIVATE_COMMAND_SEND)
-            return false;
-        return true;
-    }
-    else return (a->getTime() < b->getTime() && a->getTime() != VLC_TICK_INVALID);
+    return a.first < b.first;
 }
 
 void CommandsQueue::Schedule( AbstractCommand *command )
 {
-    vlc_mutex_lock(&lock);
-    if( b_drop )
-    {
-        delete command;
-    }
-    else if( command->getType() == ES_OUT_SET_GROUP_PCR )
+    if( command->getType() == ES_OUT_SET_GROUP_PCR )
     {
-        bufferinglevel = command->getTime();
-        LockedCommit();
-        commands.push_back( command );
+        vlc_mutex_lock(&lock);
+        vlc_mutex_lock(&incominglock);
+        const bool b_dropping = b_drop;
+        vlc_mutex_unlock(&incominglock);
+        if( b_dropping )
+        {
+            commandsFactory->releaseCommand( command );
+        }
+        else
+        {
+            bufferinglevel = command->getTime();
+            LockedCommit();
+            commands.push_back( command );
+        }
+        vlc_mutex_unlock(&lock);
+        return;
     }
-    else
+
+    vlc_mutex_lock(&incominglock);
+    if( b_drop )
     {
-        incoming.push_back( command );
+        vlc_mutex_unlock(&incominglock);
+        commandsFactory->releaseCommand( command );
+        return;
     }
-    vlc_mutex_unlock(&lock);
+    incoming.push_back( command );
+    vlc_mutex_unlock(&incominglock);
 }
 
 const CommandsFactory * CommandsQueue::factory() const
@@ -300,7 +353,6 @@ const CommandsFactory * CommandsQueue::factory() const
 vlc_tick_t CommandsQueue::Process( es_out_t *out, vlc_tick_t barrier )
 {
     vlc_tick_t lastdts = barrier;
-    std::set<const void *> disabled_esids;
     bool b_datasent = false;
 
     /* We need to filter the current commands list
@@ -310,16 +362,11 @@ vlc_tick_t CommandsQueue::Process( es_out_t *out, vlc_tick_t barrier )
        ex: for a target time of 2, you must dequeue <= 2 until >= PCR2
        A0,A1,A2,B0,PCR0,B1,B2,PCR2,B3,A3,PCR3
     */
-    std::list<AbstractCommand *> output;
-    std::list<AbstractCommand *> in;
-
     vlc_mutex_lock(&lock);
 
-    in.splice( in.end(), commands );
-
-    while( !in.empty() )
+    while( !commands.empty() )
     {
-        AbstractCommand *command = in.front();
+        AbstractCommand *command = commands.front();
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_DEL && b_datasent )
             break;
@@ -330,29 +377,32 @@ vlc_tick_t CommandsQueue::Process( es_out_t *out, vlc_tick_t barrier )
         if(command->getType() == ES_OUT_SET_GROUP_PCR && command->getTime() > barrier )
             break;
 
-        in.pop_front();
+        commands.pop_front();
         b_datasent = true;
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
         {
-            EsOutSendCommand *sendcommand = dynamic_cast<EsOutSendCommand *>(command);
+            EsOutSendCommand *sendcommand = static_cast<EsOutSendCommand *>(command);
             /* We need a stream identifier to send NON DATED data following DATA for the same ES */
-            const void *id = (sendcommand) ? sendcommand->esIdentifier() : 0;
+            const void *id = sendcommand->esIdentifier();
 
             /* Not for now */
             if( command->getTime() > barrier ) /* Not for now */
             {
                 /* ensure no more non dated for that ES is sent
                  * since we're sure that data is above barrier */
-                disabled_esids.insert( id );
-                commands.push_back( command );
+                if( std::find( disabled_esids.begin(), disabled_esids.end(), id )
+                        == disabled_esids.end() )
+                    disabled_esids.push_back( id );
+                delayed.push_back( command );
             }
             else if( command->getTime() == VLC_TICK_INVALID )
             {
-                if( disabled_esids.find( id ) == disabled_esids.end() )
+                if( std::find( disabled_esids.begin(), disabled_esids.end(), id )
+                        == disabled_esids.end() )
                     output.push_back( command );
                 else
-                    commands.push_back( command );
+                    delayed.push_back( command );
             }
             else /* Falls below barrier, send */
             {
@@ -362,17 +412,19 @@ vlc_tick_t CommandsQueue::Process( es_out_t *out, vlc_tick_t barrier )
         else output.push_back( command ); /* will discard below */
     }
 
-    /* push remaining ones if broke above */
-    commands.splice( commands.end(), in );
+    /* put back the delayed ones before the remaining ones */
+    commands.insert( commands.begin(), delayed.begin(), delayed.end() );
+    delayed.clear();
+    disabled_esids.clear();
 
     if(commands.empty() && b_draining)
         b_draining = false;
 
     /* Now execute our selected commands */
-    while( !output.empty() )
+    std::vector<AbstractCommand *>::const_iterator it;
+    for( it = output.begin(); it != output.end(); ++it )
     {
-        AbstractCommand *command = output.front();
-        output.pop_front();
+        AbstractCommand *command = *it;
 
         if( command->getType() == ES_OUT_PRIVATE_COMMAND_SEND )
         {
@@ -382,8 +434,9 @@ vlc_tick_t CommandsQueue::Process( es_out_t *out, vlc_tick_t barrier )
         }
 
         command->Execute( out );
-        delete command;
+        commandsFactory->releaseCommand( command );
     }
+    output.clear();
     pcr = lastdts; /* Warn! no PCR update/lock release until execution */
 
     vlc_mutex_unlock(&lock);
@@ -393,9 +446,58 @@ vlc_tick_t CommandsQueue::Process( es_out_t *out, vlc_tick_t barrier )
 
 void CommandsQueue::LockedCommit()
 {
-    /* reorder all blocks by time between 2 PCR and merge with main list */
-    incoming.sort( compareCommands );
-    commands.splice( commands.end(), incoming );
+    /* reorder all blocks by time between 2 PCR and merge with main list.
+       Data of a same ES stays in order, non dated one following the data
+       it was sent after. Other commands are kept in place. */
+    vlc_mutex_lock(&incominglock);
+    committing.swap( incoming );
+    vlc_mutex_unlock(&incominglock);
+
+    std::vector<std::pair<const void *, vlc_tick_t> > lasttimes;
+    std::vector<AbstractCommand *>::const_iterator it;
+    for( it = committing.begin(); it != committing.end(); ++it )
+    {
+        AbstractCommand *command = *it;
+        if( command->getType() != ES_OUT_PRIVATE_COMMAND_SEND )
+        {
+            LockedFlushSorted();
+            lasttimes.clear();
+            commands.push_back( command );
+            continue;
+        }
+
+        const void *id = static_cast<EsOutSendCommand *>(command)->esIdentifier();
+        std::vector<std::pair<const void *, vlc_tick_t> >::iterator last;
+        for( last = lasttimes.begin(); last != lasttimes.end(); ++last )
+            if( (*last).first == id )
+                break;
+
+        vlc_tick_t time = command->getTime();
+        if( time == VLC_TICK_INVALID )
+        {
+            if( last != lasttimes.end() )
+                time = (*last).second;
+            else if( !sorting.empty() )
+                time = sorting.back().first;
+        }
+
+        if( last != lasttimes.end() )
+            (*last).second = time;
+        else
+            lasttimes.push_back( std::pair<const void *, vlc_tick_t>( id, time ) );
+        sorting.push_back( std::pair<vlc_tick_t, AbstractCommand *>( time, command ) );
+    }
+    LockedFlushSorted();
+    committing.clear();
+}
+
+void CommandsQueue::LockedFlushSorted()
+{
+    std::stable_sort( sorting.begin(), sorting.end(), compareKeys );
+    std::vector<std::pair<vlc_tick_t, AbstractCommand *> >::const_iterator it;
+    for( it = sorting.begin(); it != sorting.end(); ++it )
+        commands.push_back( (*it).second );
+    sorting.clear();
 }
 
 void CommandsQueue::Commit()
@@ -408,12 +510,18 @@ void CommandsQueue::Commit()
 void CommandsQueue::Abort( bool b_reset )
 {
     vlc_mutex_lock(&lock);
-    commands.splice( commands.end(), incoming );
-    while( !commands.empty() )
-    {
-        delete commands.front();
-        commands.pop_front();
-    }
+    vlc_mutex_lock(&incominglock);
+    committing.swap( incoming );
+    vlc_mutex_unlock(&incominglock);
+
+    std::deque<AbstractCommand *>::const_iterator it;
+    for( it = commands.begin(); it != commands.end(); ++it )
+        commandsFactory->releaseCommand( *it );
+    commands.clear();
+    std::vector<AbstractCommand *>::const_iterator it2;
+    for( it2 = committing.begin(); it2 != committing.end(); ++it2 )
+        commandsFactory->releaseCommand( *it2 );
+    committing.clear();
 
     if( b_reset )
     {
@@ -428,16 +536,18 @@ void CommandsQueue::Abort( bool b_reset )
 bool CommandsQueue::isEmpty() const
 {
     vlc_mutex_lock(const_cast<vlc_mutex_t *>(&lock));
+    vlc_mutex_lock(const_cast<vlc_mutex_t *>(&incominglock));
     bool b_empty = commands.empty() && incoming.empty();
+    vlc_mutex_unlock(const_cast<vlc_mutex_t *>(&incominglock));
     vlc_mutex_unlock(const_cast<vlc_mutex_t *>(&lock));
     return b_empty;
 }
 
 void CommandsQueue::setDrop( bool b )
 {
-    vlc_mutex_lock(&lock);
+    vlc_mutex_lock(&incominglock);
     b_drop = b;
-    vlc_mutex_unlock(&lock);
+    vlc_mutex_unlock(&incominglock);
 }
 
 void CommandsQueue::setDraining()
@@ -490,7 +600,7 @@ vlc_tick_t CommandsQueue::getBufferingLevel() const
 
 vlc_tick_t CommandsQueue::getFirstDTS() const
 {
-    std::list<AbstractCommand *>::const_iterator it;
+    std::deque<AbstractCommand *>::const_iterator it;
     vlc_mutex_lock(const_cast<vlc_mutex_t *>(&lock));
     vlc_tick_t i_firstdts = pcr;
     for( it = commands.begin(); it != commands.end(); ++it )
@@ -24,7 +24,8 @@
 #include <vlc_es.h>
 
 #include <atomic>
-#include <list>
+#include <deque>
+#include <vector>
 
 namespace adaptive
 {
@@ -137,7 +138,8 @@ namespace adaptive
     class CommandsFactory
     {
         public:
-            virtual ~CommandsFactory() {}
+            CommandsFactory();
+            virtual ~CommandsFactory();
             virtual EsOutSendCommand * createEsOutSendCommand( FakeESOutID *, block_t * ) const;
             virtual EsOutDelCommand * createEsOutDelCommand( FakeESOutID * ) const;
             virtual EsOutAddCommand * createEsOutAddCommand( FakeESOutID * ) const;
@@ -145,6 +147,13 @@ namespace adaptive
             virtual EsOutControlResetPCRCommand * creatEsOutControlResetPCRCommand() const;
             virtual EsOutDestroyCommand * createEsOutDestroyCommand() const;
             virtual EsOutMetaCommand * createEsOutMetaCommand( int, const vlc_meta_t * ) const;
+            /* Destroys, or keeps data commands for reuse */
+            virtual void releaseCommand( AbstractCommand * ) const;
+
+        private:
+            static const size_t MAX_POOLED = 1024;
+            mutable vlc_mutex_t lock;
+            mutable std::vector<EsOutSendCommand *> pool;
     };
 
     /* Queuing for doing all the stuff in order */
@@ -173,13 +182,25 @@ namespace adaptive
             CommandsFactory *commandsFactory;
             vlc_mutex_t lock;
             void LockedCommit();
+            void LockedFlushSorted();
             void LockedSetDraining();
-            std::list<AbstractCommand *> incoming;
-            std::list<AbstractCommand *> commands;
+            /* Commands since the last PCR, in arrival order. Has its own lock
+               so that the demuxer never waits for a Process() in progress.
+               Always taken after the main lock. */
+            vlc_mutex_t incominglock;
+            std::vector<AbstractCommand *> incoming;
+            bool b_drop;
+            /* Ordered commands */
+            std::deque<AbstractCommand *> commands;
+            /* Scratch storage, kept to avoid reallocating on each call */
+            std::vector<AbstractCommand *> committing;
+            std::vector<std::pair<vlc_tick_t, AbstractCommand *> > sorting;
+            std::vector<AbstractCommand *> output;
+            std::vector<AbstractCommand *> delayed;
+            std::vector<const void *> disabled_esids;
             vlc_tick_t bufferinglevel;
             vlc_tick_t pcr;
             bool b_draining;
-            bool b_drop;
             bool b_eof;
     };
 }
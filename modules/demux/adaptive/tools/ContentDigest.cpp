@@ -0,0 +1,60 @@
+/*
+ * ContentDigest.cpp
+ *****************************************************************************
+ * Copyright © 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ContentDigest.hpp"
+
+#include <vlc_block.h>
+#include <vlc_md5.h>
+
+#include <cstring>
+
+using namespace adaptive;
+
+ContentDigest::ContentDigest()
+{
+    reset();
+}
+
+void ContentDigest::reset()
+{
+    valid = false;
+    size = 0;
+    memset(digest, 0, sizeof(digest));
+}
+
+bool ContentDigest::update(const block_t *p_block)
+{
+    struct md5_s md5;
+    InitMD5(&md5);
+    AddMD5(&md5, p_block->p_buffer, p_block->i_buffer);
+    EndMD5(&md5);
+
+    if(valid && size == p_block->i_buffer &&
+       !memcmp(digest, md5.buf, sizeof(digest)))
+        return false;
+
+    valid = true;
+    size = p_block->i_buffer;
+    memcpy(digest, md5.buf, sizeof(digest));
+    return true;
+}
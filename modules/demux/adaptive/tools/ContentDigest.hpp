@@ -0,0 +1,44 @@
+/*
+ * ContentDigest.hpp
+ *****************************************************************************
+ * Copyright © 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef CONTENTDIGEST_HPP
+#define CONTENTDIGEST_HPP
+
+#include <vlc_common.h>
+
+namespace adaptive
+{
+    /* Remembers the last retrieved version of a live manifest,
+     * so that unchanged refreshes can skip parsing and merging */
+    class ContentDigest
+    {
+        public:
+            ContentDigest();
+            /* Returns true if the content differs from the previous one */
+            bool update(const block_t *);
+            void reset();
+
+        private:
+            bool    valid;
+            size_t  size;
+            uint8_t digest[16];
+    };
+}
+
+#endif // CONTENTDIGEST_HPP
@@ -32,6 +32,7 @@
 #include "DASHManager.h"
 #include "mpd/ProgramInformation.h"
 #include "mpd/IsoffMainParser.h"
+#include "mpd/IsoffMainUpdater.h"
 #include "xml/DOMParser.h"
 #include "xml/Node.h"
 #include "../adaptive/tools/Helper.h"
@@ -106,9 +107,42 @@ bool DASHManager::updatePlaylist()
         if(!p_block)
             return false;
 
+        /* Nothing to parse nor merge if the MPD did not change */
+        if(!mpdDigest.update(p_block))
+        {
+            msg_Dbg(p_demux, "MPD unchanged, skipping update");
+            block_Release(p_block);
+            return true;
+        }
+
+        vlc_tick_t minsegmentTime = 0;
+        std::vector<AbstractStream *>::iterator it;
+        for(it=streams.begin(); it!=streams.end(); it++)
+        {
+            vlc_tick_t segmentTime = (*it)->getPlaybackTime();
+            if(!minsegmentTime || segmentTime < minsegmentTime)
+                minsegmentTime = segmentTime;
+        }
+
+        /* Try merging the timelines in place first */
         stream_t *mpdstream = vlc_stream_MemoryNew(p_demux, p_block->p_buffer, p_block->i_buffer, true);
+        if(mpdstream)
+        {
+            IsoffMainUpdater updater(VLC_OBJECT(p_demux), mpdstream);
+            bool b_updated = updater.update(playlist, minsegmentTime);
+            vlc_stream_Delete(mpdstream);
+            if(b_updated)
+            {
+                block_Release(p_block);
+                return true;
+            }
+        }
+
+        /* Otherwise parse and merge a full new MPD */
+        mpdstream = vlc_stream_MemoryNew(p_demux, p_block->p_buffer, p_block->i_buffer, true);
         if(!mpdstream)
         {
+            mpdDigest.reset();
             block_Release(p_block);
             return false;
         }
@@ -116,20 +150,12 @@ bool DASHManager::updatePlaylist()
         xml::DOMParser parser(mpdstream);
         if(!parser.parse(true))
         {
+            mpdDigest.reset();
             vlc_stream_Delete(mpdstream);
             block_Release(p_block);
             return false;
         }
 
-        vlc_tick_t minsegmentTime = 0;
-        std::vector<AbstractStream *>::iterator it;
-        for(it=streams.begin(); it!=streams.end(); it++)
-        {
-            vlc_tick_t segmentTime = (*it)->getPlaybackTime();
-            if(!minsegmentTime || segmentTime < minsegmentTime)
-                minsegmentTime = segmentTime;
-        }
-
         IsoffMainParser mpdparser(parser.getRootNode(), VLC_OBJECT(p_demux),
                                   mpdstream, Helper::getDirectoryPath(url).append("/"));
         MPD *newmpd = mpdparser.parse();
@@ -138,6 +164,7 @@ bool DASHManager::updatePlaylist()
             playlist->mergeWith(newmpd, minsegmentTime);
             delete newmpd;
         }
+        else mpdDigest.reset();
         vlc_stream_Delete(mpdstream);
         block_Release(p_block);
     }
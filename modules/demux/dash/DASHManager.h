@@ -27,6 +27,7 @@
 
 #include "../adaptive/PlaylistManager.h"
 #include "../adaptive/logic/AbstractAdaptationLogic.h"
+#include "../adaptive/tools/ContentDigest.hpp"
 #include "mpd/MPD.h"
 
 namespace adaptive
@@ -59,6 +60,9 @@ namespace dash
 
         protected:
             virtual int doControl(int, va_list); /* reimpl */
+
+        private:
+            ContentDigest mpdDigest;
     };
 
 }
@@ -44,7 +44,9 @@
 #include "../adaptive/tools/Debug.hpp"
 #include "../adaptive/tools/Conversions.hpp"
 #include <vlc_stream.h>
+#include <vlc_charset.h>
 #include <cstdio>
+#include <cmath>
 
 using namespace dash::mpd;
 using namespace adaptive::xml;
@@ -176,6 +178,13 @@ size_t IsoffMainParser::parseSegmentTemplate(Node *templateNode, SegmentInformat
     if(templateNode->hasAttribute("duration"))
         mediaTemplate->duration.Set(Integer<stime_t>(templateNode->getAttributeValue("duration")));
 
+    if(templateNode->hasAttribute("availabilityTimeOffset"))
+    {
+        double offset = us_strtod(templateNode->getAttributeValue("availabilityTimeOffset").c_str(), NULL);
+        if(offset > 0 && std::isfinite(offset)) /* ignore INF */
+            mediaTemplate->availabilityTimeOffset.Set(vlc_tick_from_sec(offset));
+    }
+
     InitSegmentTemplate *initTemplate = NULL;
 
     if(templateNode->hasAttribute("initialization"))
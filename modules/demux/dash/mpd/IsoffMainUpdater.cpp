@@ -0,0 +1,300 @@
+/*
+ * IsoffMainUpdater.cpp
+ *****************************************************************************
+ * Copyright © 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "IsoffMainUpdater.h"
+#include "../adaptive/playlist/SegmentTimeline.h"
+#include "../adaptive/playlist/SegmentInformation.hpp"
+#include "../adaptive/playlist/AbstractPlaylist.hpp"
+#include "../adaptive/playlist/BasePeriod.h"
+#include "../adaptive/playlist/BaseAdaptationSet.h"
+#include "../adaptive/playlist/BaseRepresentation.h"
+#include "../adaptive/tools/Conversions.hpp"
+#include "../adaptive/ID.hpp"
+
+#include <vlc_xml.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace dash::mpd;
+using namespace adaptive;
+
+IsoffMainUpdater::Frame::Frame(Kind kind_, SegmentInformation *info_)
+{
+    kind = kind_;
+    info = info_;
+    nextid = 0;
+    b_template = false;
+    b_timeline = false;
+    startNumber = 0;
+    timescale = 1;
+    update = 0;
+}
+
+IsoffMainUpdater::IsoffMainUpdater(vlc_object_t *p_object_, stream_t *p_stream_)
+{
+    p_object = p_object_;
+    p_stream = p_stream_;
+    periodIndex = 0;
+}
+
+IsoffMainUpdater::~IsoffMainUpdater()
+{
+    std::vector<Update>::const_iterator it;
+    for(it = updates.begin(); it != updates.end(); ++it)
+        delete (*it).timeline;
+}
+
+void IsoffMainUpdater::readAttributes(xml_reader_t *reader)
+{
+    const char *psz_name, *psz_value;
+
+    attributes.clear();
+    while((psz_name = xml_ReaderNextAttr(reader, &psz_value)) != NULL)
+        attributes.push_back(std::make_pair(std::string(psz_name),
+                                            std::string(psz_value)));
+}
+
+const std::string * IsoffMainUpdater::getAttribute(const char *name) const
+{
+    std::vector<std::pair<std::string, std::string> >::const_iterator it;
+    for(it = attributes.begin(); it != attributes.end(); ++it)
+    {
+        if((*it).first == name)
+            return &(*it).second;
+    }
+    return NULL;
+}
+
+IsoffMainUpdater::Frame * IsoffMainUpdater::getNearest(Kind a, Kind b)
+{
+    std::vector<Frame>::reverse_iterator it;
+    for(it = frames.rbegin(); it != frames.rend(); ++it)
+    {
+        if((*it).kind == a || (*it).kind == b)
+            return &(*it);
+    }
+    return NULL;
+}
+
+void IsoffMainUpdater::matchElement(SegmentInformation **info)
+{
+    /* Only the first element with the same ID gets merged */
+    if(*info == NULL)
+        return;
+    if(std::find(matched.begin(), matched.end(), *info) != matched.end())
+        *info = NULL;
+    else
+        matched.push_back(*info);
+}
+
+bool IsoffMainUpdater::startElement(AbstractPlaylist *playlist, const char *name)
+{
+    Kind kind = OTHER;
+    SegmentInformation *info = NULL;
+    size_t update = 0;
+
+    if(frames.empty()) /* root */
+    {
+        if(strcmp(name, "MPD"))
+            return false;
+    }
+    /* Same elements lookup as the IsoffMainParser */
+    else if(!strcmp(name, "Period"))
+    {
+        if(!getNearest(PERIOD, PERIOD))
+        {
+            kind = PERIOD;
+            const std::vector<BasePeriod *> &periods = playlist->getPeriods();
+            if(periodIndex < periods.size())
+                info = periods.at(periodIndex);
+            periodIndex++;
+        }
+    }
+    else if(!strcmp(name, "AdaptationSet"))
+    {
+        Frame *period = getNearest(PERIOD, ADAPTATIONSET);
+        if(period && period->kind == PERIOD)
+        {
+            kind = ADAPTATIONSET;
+            const std::string *id = getAttribute("id");
+            const ID setid = id ? ID(*id) : ID(period->nextid++);
+            if(period->info)
+                info = static_cast<BasePeriod *>(period->info)->getAdaptationSetByID(setid);
+            matchElement(&info);
+        }
+    }
+    else if(!strcmp(name, "Representation"))
+    {
+        Frame *adaptSet = getNearest(ADAPTATIONSET, REPRESENTATION);
+        if(adaptSet && adaptSet->kind == ADAPTATIONSET)
+        {
+            kind = REPRESENTATION;
+            const std::string *id = getAttribute("id");
+            const ID repid = id ? ID(*id) : ID(adaptSet->nextid++);
+            if(adaptSet->info)
+                info = static_cast<BaseAdaptationSet *>(adaptSet->info)->getRepresentationByID(repid);
+            matchElement(&info);
+        }
+    }
+    else if(!strcmp(name, "SegmentList"))
+    {
+        Frame &parent = frames.back();
+        /* Lists are only merged by the full update */
+        if(parent.info && (parent.kind == PERIOD ||
+                           parent.kind == ADAPTATIONSET ||
+                           parent.kind == REPRESENTATION))
+            return false;
+    }
+    else if(!strcmp(name, "SegmentTemplate"))
+    {
+        Frame &parent = frames.back();
+        if((parent.kind == PERIOD || parent.kind == ADAPTATIONSET ||
+            parent.kind == REPRESENTATION) && !parent.b_template)
+        {
+            parent.b_template = true;
+            const std::string *media = getAttribute("media");
+            if(parent.info && media && !media->empty())
+            {
+                kind = TEMPLATE;
+                info = parent.info;
+            }
+        }
+    }
+    else if(!strcmp(name, "SegmentTimeline"))
+    {
+        Frame &parent = frames.back();
+        if(parent.kind == TEMPLATE && !parent.b_timeline)
+        {
+            parent.b_timeline = true;
+
+            Update u;
+            u.info = parent.info;
+            const std::string *startNumber = getAttribute("startNumber");
+            u.number = startNumber ? Integer<uint64_t>(*startNumber)
+                                   : parent.startNumber;
+            u.timeline = new (std::nothrow) SegmentTimeline(parent.timescale);
+            if(!u.timeline)
+                return false;
+            updates.push_back(u);
+
+            kind = TIMELINE;
+            info = parent.info;
+            update = updates.size() - 1;
+        }
+    }
+    else if(!strcmp(name, "S"))
+    {
+        Frame *timeline = getNearest(TIMELINE, TIMELINE_S);
+        if(timeline && timeline->kind == TIMELINE)
+        {
+            kind = TIMELINE_S;
+            Update &u = updates.at(timeline->update);
+            const std::string *d = getAttribute("d");
+            if(d) /* Mandatory */
+            {
+                const std::string *r = getAttribute("r");
+                const std::string *t = getAttribute("t");
+                uint64_t repeat = r ? Integer<uint64_t>(*r) : 0;
+                if(t)
+                    u.timeline->addElement(u.number, Integer<stime_t>(*d), repeat,
+                                           Integer<stime_t>(*t));
+                else
+                    u.timeline->addElement(u.number, Integer<stime_t>(*d), repeat);
+                u.number += (1 + repeat);
+            }
+        }
+    }
+
+    Frame frame(kind, info);
+    frame.update = update;
+    if(kind == TEMPLATE)
+    {
+        const std::string *value = getAttribute("startNumber");
+        if(value)
+            frame.startNumber = Integer<uint64_t>(*value);
+        value = getAttribute("timescale");
+        if(value)
+            frame.timescale = Integer<uint64_t>(*value);
+    }
+    frames.push_back(frame);
+    return true;
+}
+
+bool IsoffMainUpdater::update(AbstractPlaylist *playlist, vlc_tick_t prunetime)
+{
+    xml_reader_t *reader = xml_ReaderCreate(p_object, p_stream);
+    if(!reader)
+        return false;
+
+    const char *name;
+    int type;
+    bool b_ok = true;
+    bool b_done = false;
+
+    while(b_ok && !b_done && (type = xml_ReaderNextNode(reader, &name)) > 0)
+    {
+        switch(type)
+        {
+            case XML_READER_STARTELEM:
+            {
+                const bool b_empty = xml_ReaderIsEmptyElement(reader);
+                readAttributes(reader);
+                b_ok = startElement(playlist, name);
+                if(b_ok && b_empty)
+                {
+                    frames.pop_back();
+                    b_done = frames.empty();
+                }
+                break;
+            }
+
+            case XML_READER_ENDELEM:
+                if(frames.empty())
+                {
+                    b_ok = false;
+                    break;
+                }
+                frames.pop_back();
+                b_done = frames.empty();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    xml_ReaderDelete(reader);
+
+    /* Nothing gets applied from an incomplete or unsupported document */
+    if(!b_ok || !b_done)
+        return false;
+
+    std::vector<Update>::const_iterator it;
+    for(it = updates.begin(); it != updates.end(); ++it)
+        (*it).info->mergeWithTemplateTimeline((*it).timeline, prunetime);
+
+    msg_Dbg(p_object, "MPD updated in place, %zu timelines merged", updates.size());
+    return true;
+}
@@ -0,0 +1,111 @@
+/*
+ * IsoffMainUpdater.h
+ *****************************************************************************
+ * Copyright © 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef ISOFFMAINUPDATER_H_
+#define ISOFFMAINUPDATER_H_
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+
+#include <string>
+#include <vector>
+
+namespace adaptive
+{
+    namespace playlist
+    {
+        class AbstractPlaylist;
+        class SegmentInformation;
+        class SegmentTimeline;
+    }
+}
+
+namespace dash
+{
+    namespace mpd
+    {
+        using namespace adaptive::playlist;
+
+        /* Reads a refreshed MPD as a stream of elements and only merges
+         * the segment timelines into the matching existing elements,
+         * without building the document nor a new MPD tree.
+         * Refuses documents it can't apply, so that the caller can
+         * fall back to a full parse and merge. */
+        class IsoffMainUpdater
+        {
+            public:
+                IsoffMainUpdater(vlc_object_t *, stream_t *);
+                ~IsoffMainUpdater();
+                bool update(AbstractPlaylist *, vlc_tick_t);
+
+            private:
+                enum Kind
+                {
+                    OTHER,
+                    PERIOD,
+                    ADAPTATIONSET,
+                    REPRESENTATION,
+                    TEMPLATE,
+                    TIMELINE,
+                    TIMELINE_S,
+                };
+
+                class Frame
+                {
+                    public:
+                        Frame(Kind, SegmentInformation *);
+                        Kind kind;
+                        SegmentInformation *info; /* matching element, or NULL */
+                        uint64_t nextid;
+                        bool b_template; /* first SegmentTemplate seen */
+                        bool b_timeline; /* first SegmentTimeline seen */
+                        uint64_t startNumber;
+                        uint64_t timescale;
+                        size_t update; /* index of the timeline update */
+                };
+
+                class Update
+                {
+                    public:
+                        SegmentInformation *info;
+                        SegmentTimeline *timeline;
+                        uint64_t number;
+                };
+
+                void readAttributes(xml_reader_t *);
+                const std::string * getAttribute(const char *) const;
+                Frame * getNearest(Kind, Kind);
+                bool startElement(AbstractPlaylist *, const char *);
+                void matchElement(SegmentInformation **);
+
+                vlc_object_t *p_object;
+                stream_t *p_stream;
+                std::vector<Frame> frames;
+                std::vector<Update> updates;
+                std::vector<SegmentInformation *> matched;
+                std::vector<std::pair<std::string, std::string> > attributes;
+                size_t periodIndex;
+        };
+    }
+}
+
+#endif /* ISOFFMAINUPDATER_H_ */
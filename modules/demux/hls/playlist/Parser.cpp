@@ -174,215 +174,412 @@ bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, Representati
     block_t *p_block = Retrieve::HTTP(p_obj, auth, rep->getPlaylistUrl().toString());
     if(p_block)
     {
+        /* Unchanged playlist, nothing new to append */
+        if(!rep->playlistDigest.update(p_block))
+        {
+            msg_Dbg(p_obj, "playlist ID %s unchanged", rep->getID().str().c_str());
+            block_Release(p_block);
+            return true;
+        }
+
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
         if(substream)
         {
-            std::list<Tag *> tagslist = parseEntries(substream);
+            updateSegments(p_obj, rep, substream);
             vlc_stream_Delete(substream);
-
-            parseSegments(p_obj, rep, tagslist);
-
-            releaseTagsList(tagslist);
         }
+        else rep->playlistDigest.reset();
         block_Release(p_block);
         return true;
     }
     return false;
 }
 
-void M3U8Parser::parseSegments(vlc_object_t *, Representation *rep, const std::list<Tag *> &tagslist)
+/* Pulls tags one at a time, so that they don't all need to be held */
+class M3U8Parser::TagsReader
 {
-    SegmentList *segmentList = new (std::nothrow) SegmentList(rep);
-
-    rep->setTimescale(100);
-    rep->b_loaded = true;
-
-    vlc_tick_t totalduration = 0;
-    vlc_tick_t nzStartTime = 0;
-    vlc_tick_t absReferenceTime = VLC_TICK_INVALID;
-    uint64_t sequenceNumber = 0;
-    bool discontinuity = false;
-    std::size_t prevbyterangeoffset = 0;
-    const SingleValueTag *ctx_byterange = NULL;
-    SegmentEncryption encryption;
-    const ValuesListTag *ctx_extinf = NULL;
-
-    std::list<Tag *>::const_iterator it;
-    for(it = tagslist.begin(); it != tagslist.end(); ++it)
-    {
-        const Tag *tag = *it;
-        switch(tag->getType())
+    public:
+        TagsReader(stream_t *stream)
         {
-            /* using static cast as attribute type permits avoiding class check */
-            case SingleValueTag::EXTXMEDIASEQUENCE:
-            {
-                sequenceNumber = (static_cast<const SingleValueTag*>(tag))->getValue().decimal();
-            }
-            break;
+            this->stream = stream;
+            lastTag = NULL;
+            b_eof = false;
+        }
 
-            case ValuesListTag::EXTINF:
-            {
-                ctx_extinf = static_cast<const ValuesListTag *>(tag);
-            }
-            break;
+        ~TagsReader()
+        {
+            releaseTagsList(pending);
+        }
 
-            case SingleValueTag::URI:
+        Tag * read()
+        {
+            /* last tag can still receive the next line URI */
+            while(!b_eof && (pending.empty() || isOpen(pending.front())))
             {
-                const SingleValueTag *uritag = static_cast<const SingleValueTag *>(tag);
-                if(uritag->getValue().value.empty())
+                char *psz_line = vlc_stream_ReadLine(stream);
+                if(!psz_line)
                 {
-                    ctx_extinf = NULL;
-                    ctx_byterange = NULL;
+                    b_eof = true;
                     break;
                 }
+                parseLine(psz_line);
+                free(psz_line);
+            }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
+            if(pending.empty())
+                return NULL;
+            Tag *tag = pending.front();
+            pending.pop_front();
+            if(tag == lastTag)
+                lastTag = NULL;
+            return tag;
+        }
 
-                segment->setSourceUrl(uritag->getValue().value);
-                if((unsigned)rep->getStreamFormat() == StreamFormat::UNKNOWN)
-                    setFormatFromExtension(rep, uritag->getValue().value);
+    private:
+        bool isOpen(const Tag *tag) const
+        {
+            return tag == lastTag && tag->getType() == AttributesTag::EXTXSTREAMINF;
+        }
 
-                /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
-                double duration = rep->targetDuration;
-                if(ctx_extinf)
+        void parseLine(const char *psz_line)
+        {
+            if(*psz_line == '#')
+            {
+                if(!strncmp(psz_line, "#EXT", 4)) //tag
                 {
-                    const Attribute *durAttribute = ctx_extinf->getAttributeByName("DURATION");
-                    if(durAttribute)
-                        duration = durAttribute->floatingPoint();
-                    ctx_extinf = NULL;
+                    std::string key;
+                    std::string attributes;
+                    const char *split = strchr(psz_line, ':');
+                    if(split)
+                    {
+                        key = std::string(psz_line + 1, split - psz_line - 1);
+                        attributes = std::string(split + 1);
+                    }
+                    else
+                    {
+                        key = std::string(psz_line + 1);
+                    }
+
+                    if(!key.empty())
+                    {
+                        Tag *tag = TagFactory::createTagByName(key, attributes);
+                        if(tag)
+                            pending.push_back(tag);
+                        lastTag = tag;
+                    }
                 }
-                const vlc_tick_t nzDuration = vlc_tick_from_sec( duration );
-                segment->duration.Set(duration * (uint64_t) rep->getTimescale());
-                segment->startTime.Set(rep->getTimescale().ToScaled(nzStartTime));
-                nzStartTime += nzDuration;
-                totalduration += nzDuration;
-                if(absReferenceTime != VLC_TICK_INVALID)
+            }
+            else if(*psz_line)
+            {
+                /* URI */
+                if(lastTag && lastTag->getType() == AttributesTag::EXTXSTREAMINF)
                 {
-                    segment->utcTime = absReferenceTime;
-                    absReferenceTime += nzDuration;
+                    AttributesTag *streaminftag = static_cast<AttributesTag *>(lastTag);
+                    /* master playlist uri, merge as attribute */
+                    Attribute *uriAttr = new (std::nothrow) Attribute("URI", std::string(psz_line));
+                    if(uriAttr)
+                        streaminftag->addAttribute(uriAttr);
                 }
-
-                segmentList->addSegment(segment);
-
-                if(ctx_byterange)
+                else /* playlist tag, will take modifiers */
                 {
-                    std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
-                    if(range.first == 0) /* first == size, second = offset */
-                        range.first = prevbyterangeoffset;
-                    prevbyterangeoffset = range.first + range.second;
-                    segment->setByteRange(range.first, prevbyterangeoffset - 1);
-                    ctx_byterange = NULL;
+                    Tag *tag = TagFactory::createTagByName("", std::string(psz_line));
+                    if(tag)
+                        pending.push_back(tag);
                 }
+                lastTag = NULL;
+            }
+            else // drop
+            {
+                lastTag = NULL;
+            }
+        }
 
-                if(discontinuity)
-                {
-                    segment->discontinuity = true;
-                    discontinuity = false;
-                }
+        stream_t *stream;
+        std::list<Tag *> pending;
+        Tag *lastTag;
+        bool b_eof;
+};
 
-                if(encryption.method != SegmentEncryption::NONE)
-                    segment->setEncryption(encryption);
-            }
-            break;
+/* Segments parsing state, carried from one tag to the next */
+class M3U8Parser::SegmentsContext
+{
+    public:
+        SegmentsContext(Representation *rep)
+        {
+            segmentList = new (std::nothrow) SegmentList(rep);
+            totalduration = 0;
+            nzStartTime = 0;
+            absReferenceTime = VLC_TICK_INVALID;
+            sequenceNumber = 0;
+            discontinuity = false;
+            prevbyterangeoffset = 0;
+            b_byterange = false;
+            b_extinf = false;
+            extinfduration = -1;
+            /* Refreshes only need to create the segments not known yet */
+            b_update = rep->getLastListedSegmentNumber(&lastKnownNumber);
+
+            rep->setTimescale(100);
+            rep->b_loaded = true;
+        }
 
-            case SingleValueTag::EXTXTARGETDURATION:
-                rep->targetDuration = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
-                break;
+        SegmentList *segmentList;
+        vlc_tick_t totalduration;
+        vlc_tick_t nzStartTime;
+        vlc_tick_t absReferenceTime;
+        uint64_t sequenceNumber;
+        bool discontinuity;
+        std::size_t prevbyterangeoffset;
+        bool b_byterange;
+        std::pair<std::size_t,std::size_t> byterange;
+        bool b_extinf;
+        double extinfduration; /* or -1 */
+        SegmentEncryption encryption;
+        std::string keyurl; /* resolved for the first segment using it */
+        bool b_update;
+        uint64_t lastKnownNumber;
+};
+
+void M3U8Parser::parseSegments(vlc_object_t *p_obj, Representation *rep, const std::list<Tag *> &tagslist)
+{
+    SegmentsContext ctx(rep);
+    if(!ctx.segmentList)
+        return;
+
+    std::list<Tag *>::const_iterator it;
+    for(it = tagslist.begin(); it != tagslist.end(); ++it)
+        parseSegmentTag(p_obj, rep, ctx, *it);
 
-            case SingleValueTag::EXTXPLAYLISTTYPE:
-                rep->b_live = (static_cast<const SingleValueTag *>(tag)->getValue().value != "VOD");
+    finishSegments(rep, ctx);
+}
+
+void M3U8Parser::updateSegments(vlc_object_t *p_obj, Representation *rep, stream_t *stream)
+{
+    SegmentsContext ctx(rep);
+    if(!ctx.segmentList)
+        return;
+
+    /* Tags are read, applied and released one at a time */
+    TagsReader reader(stream);
+    Tag *tag;
+    while((tag = reader.read()))
+    {
+        parseSegmentTag(p_obj, rep, ctx, tag);
+        delete tag;
+    }
+
+    finishSegments(rep, ctx);
+}
+
+void M3U8Parser::parseSegmentTag(vlc_object_t *, Representation *rep,
+                                 SegmentsContext &ctx, const Tag *tag)
+{
+    SegmentList *segmentList = ctx.segmentList;
+
+    switch(tag->getType())
+    {
+        /* using static cast as attribute type permits avoiding class check */
+        case SingleValueTag::EXTXMEDIASEQUENCE:
+        {
+            ctx.sequenceNumber = (static_cast<const SingleValueTag*>(tag))->getValue().decimal();
+        }
+        break;
+
+        case ValuesListTag::EXTINF:
+        {
+            const Attribute *durAttribute =
+                    static_cast<const ValuesListTag *>(tag)->getAttributeByName("DURATION");
+            ctx.b_extinf = true;
+            ctx.extinfduration = durAttribute ? durAttribute->floatingPoint() : -1;
+        }
+        break;
+
+        case SingleValueTag::URI:
+        {
+            const SingleValueTag *uritag = static_cast<const SingleValueTag *>(tag);
+            if(uritag->getValue().value.empty())
+            {
+                ctx.b_extinf = false;
+                ctx.b_byterange = false;
                 break;
+            }
+
+            if((unsigned)rep->getStreamFormat() == StreamFormat::UNKNOWN)
+                setFormatFromExtension(rep, uritag->getValue().value);
+
+            /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
+            double duration = rep->targetDuration;
+            if(ctx.b_extinf)
+            {
+                if(ctx.extinfduration >= 0)
+                    duration = ctx.extinfduration;
+                ctx.b_extinf = false;
+            }
+            const vlc_tick_t nzDuration = vlc_tick_from_sec( duration );
+            const vlc_tick_t nzStartTime = ctx.nzStartTime;
+            const vlc_tick_t utcTime = ctx.absReferenceTime;
+            ctx.nzStartTime += nzDuration;
+            ctx.totalduration += nzDuration;
+            if(ctx.absReferenceTime != VLC_TICK_INVALID)
+                ctx.absReferenceTime += nzDuration;
+
+            std::size_t startbyte = 0, endbyte = 0;
+            const bool b_byterange = ctx.b_byterange;
+            if(b_byterange)
+            {
+                std::pair<std::size_t,std::size_t> range = ctx.byterange;
+                if(range.first == 0) /* first == size, second = offset */
+                    range.first = ctx.prevbyterangeoffset;
+                ctx.prevbyterangeoffset = range.first + range.second;
+                startbyte = range.first;
+                endbyte = ctx.prevbyterangeoffset - 1;
+                ctx.b_byterange = false;
+            }
+
+            const bool discontinuity = ctx.discontinuity;
+            ctx.discontinuity = false;
 
-            case SingleValueTag::EXTXBYTERANGE:
-                ctx_byterange = static_cast<const SingleValueTag *>(tag);
+            /* Already listed: it would be dropped when merging */
+            const uint64_t number = ctx.sequenceNumber++;
+            if(ctx.b_update && number <= ctx.lastKnownNumber)
                 break;
 
-            case SingleValueTag::EXTXPROGRAMDATETIME:
-                rep->b_consistent = false;
-                absReferenceTime = VLC_TICK_0 +
-                        UTCTime(static_cast<const SingleValueTag *>(tag)->getValue().value).mtime();
+            HLSSegment *segment = new (std::nothrow) HLSSegment(rep, number);
+            if(!segment)
                 break;
 
-            case AttributesTag::EXTXKEY:
-            {
-                const AttributesTag *keytag = static_cast<const AttributesTag *>(tag);
-                if( keytag->getAttributeByName("METHOD") &&
-                    keytag->getAttributeByName("METHOD")->value == "AES-128" &&
-                    keytag->getAttributeByName("URI") )
-                {
-                    encryption.method = SegmentEncryption::AES_128;
-                    encryption.key.clear();
+            segment->setSourceUrl(uritag->getValue().value);
+            segment->duration.Set(duration * (uint64_t) rep->getTimescale());
+            segment->startTime.Set(rep->getTimescale().ToScaled(nzStartTime));
+            if(utcTime != VLC_TICK_INVALID)
+                segment->utcTime = utcTime;
 
-                    Url keyurl(keytag->getAttributeByName("URI")->quotedString());
-                    if(!keyurl.hasScheme())
-                    {
-                        keyurl.prepend(Helper::getDirectoryPath(rep->getPlaylistUrl().toString()).append("/"));
-                    }
+            segmentList->addSegment(segment);
+
+            if(b_byterange)
+                segment->setByteRange(startbyte, endbyte);
 
+            if(discontinuity)
+                segment->discontinuity = true;
+
+            if(ctx.encryption.method != SegmentEncryption::NONE)
+            {
+                if(!ctx.keyurl.empty())
+                {
                     M3U8 *m3u8 = dynamic_cast<M3U8 *>(rep->getPlaylist());
                     if(likely(m3u8))
-                        encryption.key = m3u8->getEncryptionKey(keyurl.toString());
-                    if(keytag->getAttributeByName("IV"))
-                    {
-                        encryption.iv.clear();
-                        encryption.iv = keytag->getAttributeByName("IV")->hexSequence();
-                    }
+                        ctx.encryption.key = m3u8->getEncryptionKey(ctx.keyurl);
+                    ctx.keyurl.clear();
                 }
-                else
+                segment->setEncryption(ctx.encryption);
+            }
+        }
+        break;
+
+        case SingleValueTag::EXTXTARGETDURATION:
+            rep->targetDuration = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
+            break;
+
+        case SingleValueTag::EXTXPLAYLISTTYPE:
+            rep->b_live = (static_cast<const SingleValueTag *>(tag)->getValue().value != "VOD");
+            break;
+
+        case SingleValueTag::EXTXBYTERANGE:
+            ctx.b_byterange = true;
+            ctx.byterange = static_cast<const SingleValueTag *>(tag)->getValue().getByteRange();
+            break;
+
+        case SingleValueTag::EXTXPROGRAMDATETIME:
+            rep->b_consistent = false;
+            ctx.absReferenceTime = VLC_TICK_0 +
+                    UTCTime(static_cast<const SingleValueTag *>(tag)->getValue().value).mtime();
+            break;
+
+        case AttributesTag::EXTXKEY:
+        {
+            const AttributesTag *keytag = static_cast<const AttributesTag *>(tag);
+            if( keytag->getAttributeByName("METHOD") &&
+                keytag->getAttributeByName("METHOD")->value == "AES-128" &&
+                keytag->getAttributeByName("URI") )
+            {
+                ctx.encryption.method = SegmentEncryption::AES_128;
+                ctx.encryption.key.clear();
+
+                Url keyurl(keytag->getAttributeByName("URI")->quotedString());
+                if(!keyurl.hasScheme())
                 {
-                    /* unsupported or invalid */
-                    encryption.method = SegmentEncryption::NONE;
-                    encryption.key.clear();
-                    encryption.iv.clear();
+                    keyurl.prepend(Helper::getDirectoryPath(rep->getPlaylistUrl().toString()).append("/"));
+                }
+
+                /* Not fetched if it only applies to already listed segments */
+                ctx.keyurl = keyurl.toString();
+                if(keytag->getAttributeByName("IV"))
+                {
+                    ctx.encryption.iv.clear();
+                    ctx.encryption.iv = keytag->getAttributeByName("IV")->hexSequence();
                 }
             }
-            break;
+            else
+            {
+                /* unsupported or invalid */
+                ctx.encryption.method = SegmentEncryption::NONE;
+                ctx.encryption.key.clear();
+                ctx.encryption.iv.clear();
+                ctx.keyurl.clear();
+            }
+        }
+        break;
 
-            case AttributesTag::EXTXMAP:
+        case AttributesTag::EXTXMAP:
+        {
+            /* The listed segments already have it */
+            if(ctx.b_update)
+                break;
+
+            const AttributesTag *keytag = static_cast<const AttributesTag *>(tag);
+            const Attribute *uriAttr;
+            if(keytag && (uriAttr = keytag->getAttributeByName("URI")) &&
+               !segmentList->initialisationSegment.Get()) /* FIXME: handle discontinuities */
             {
-                const AttributesTag *keytag = static_cast<const AttributesTag *>(tag);
-                const Attribute *uriAttr;
-                if(keytag && (uriAttr = keytag->getAttributeByName("URI")) &&
-                   !segmentList->initialisationSegment.Get()) /* FIXME: handle discontinuities */
+                InitSegment *initSegment = new (std::nothrow) InitSegment(rep);
+                if(initSegment)
                 {
-                    InitSegment *initSegment = new (std::nothrow) InitSegment(rep);
-                    if(initSegment)
+                    initSegment->setSourceUrl(uriAttr->quotedString());
+                    const Attribute *byterangeAttr = keytag->getAttributeByName("BYTERANGE");
+                    if(byterangeAttr)
                     {
-                        initSegment->setSourceUrl(uriAttr->quotedString());
-                        const Attribute *byterangeAttr = keytag->getAttributeByName("BYTERANGE");
-                        if(byterangeAttr)
-                        {
-                            const std::pair<std::size_t,std::size_t> range = byterangeAttr->unescapeQuotes().getByteRange();
-                            initSegment->setByteRange(range.first, range.first + range.second - 1);
-                        }
-                        segmentList->initialisationSegment.Set(initSegment);
+                        const std::pair<std::size_t,std::size_t> range = byterangeAttr->unescapeQuotes().getByteRange();
+                        initSegment->setByteRange(range.first, range.first + range.second - 1);
                     }
+                    segmentList->initialisationSegment.Set(initSegment);
                 }
             }
-            break;
+        }
+        break;
 
-            case Tag::EXTXDISCONTINUITY:
-                discontinuity  = true;
-                break;
+        case Tag::EXTXDISCONTINUITY:
+            ctx.discontinuity  = true;
+            break;
 
-            case Tag::EXTXENDLIST:
-                rep->b_live = false;
-                break;
-        }
+        case Tag::EXTXENDLIST:
+            rep->b_live = false;
+            break;
     }
+}
 
+void M3U8Parser::finishSegments(Representation *rep, SegmentsContext &ctx)
+{
     if(rep->isLive())
     {
         rep->getPlaylist()->duration.Set(0);
     }
-    else if(totalduration > rep->getPlaylist()->duration.Get())
+    else if(ctx.totalduration > rep->getPlaylist()->duration.Get())
     {
-        rep->getPlaylist()->duration.Set(totalduration);
+        rep->getPlaylist()->duration.Set(ctx.totalduration);
     }
 
-    rep->appendSegmentList(segmentList, true);
+    rep->appendSegmentList(ctx.segmentList, true);
+    ctx.segmentList = NULL;
 }
 M3U8 * M3U8Parser::parse(vlc_object_t *p_object, stream_t *p_stream, const std::string &playlisturl)
 {
@@ -535,63 +732,11 @@ M3U8 * M3U8Parser::parse(vlc_object_t *p_object, stream_t *p_stream, const std::
 std::list<Tag *> M3U8Parser::parseEntries(stream_t *stream)
 {
     std::list<Tag *> entrieslist;
-    Tag *lastTag = NULL;
-    char *psz_line;
+    TagsReader reader(stream);
+    Tag *tag;
 
-    while((psz_line = vlc_stream_ReadLine(stream)))
-    {
-        if(*psz_line == '#')
-        {
-            if(!strncmp(psz_line, "#EXT", 4)) //tag
-            {
-                std::string key;
-                std::string attributes;
-                const char *split = strchr(psz_line, ':');
-                if(split)
-                {
-                    key = std::string(psz_line + 1, split - psz_line - 1);
-                    attributes = std::string(split + 1);
-                }
-                else
-                {
-                    key = std::string(psz_line + 1);
-                }
-
-                if(!key.empty())
-                {
-                    Tag *tag = TagFactory::createTagByName(key, attributes);
-                    if(tag)
-                        entrieslist.push_back(tag);
-                    lastTag = tag;
-                }
-            }
-        }
-        else if(*psz_line)
-        {
-            /* URI */
-            if(lastTag && lastTag->getType() == AttributesTag::EXTXSTREAMINF)
-            {
-                AttributesTag *streaminftag = static_cast<AttributesTag *>(lastTag);
-                /* master playlist uri, merge as attribute */
-                Attribute *uriAttr = new (std::nothrow) Attribute("URI", std::string(psz_line));
-                if(uriAttr)
-                    streaminftag->addAttribute(uriAttr);
-            }
-            else /* playlist tag, will take modifiers */
-            {
-                Tag *tag = TagFactory::createTagByName("", std::string(psz_line));
-                if(tag)
-                    entrieslist.push_back(tag);
-            }
-            lastTag = NULL;
-        }
-        else // drop
-        {
-            lastTag = NULL;
-        }
-
-        free(psz_line);
-    }
+    while((tag = reader.read()))
+        entrieslist.push_back(tag);
 
     return entrieslist;
 }
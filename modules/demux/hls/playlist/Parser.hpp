@@ -64,10 +64,15 @@ namespace hls
                 bool appendSegmentsFromPlaylistURI(vlc_object_t *, Representation *);
 
             private:
+                class TagsReader;
+                class SegmentsContext;
                 Representation * createRepresentation(BaseAdaptationSet *, const AttributesTag *);
                 void createAndFillRepresentation(vlc_object_t *, BaseAdaptationSet *,
                                                  const AttributesTag *, const std::list<Tag *>&);
                 void parseSegments(vlc_object_t *, Representation *, const std::list<Tag *>&);
+                void updateSegments(vlc_object_t *, Representation *, stream_t *);
+                void parseSegmentTag(vlc_object_t *, Representation *, SegmentsContext &, const Tag *);
+                void finishSegments(Representation *, SegmentsContext &);
                 void setFormatFromExtension(Representation *rep, const std::string &);
                 std::list<Tag *> parseEntries(stream_t *);
                 AuthStorage *auth;
@@ -24,6 +24,7 @@
 #include "../adaptive/playlist/BaseRepresentation.h"
 #include "../adaptive/tools/Properties.hpp"
 #include "../adaptive/StreamFormat.hpp"
+#include "../adaptive/tools/ContentDigest.hpp"
 
 namespace hls
 {
@@ -60,6 +61,7 @@ namespace hls
                 time_t nextUpdateTime;
                 time_t targetDuration;
                 Url playlistUrl;
+                ContentDigest playlistDigest;
         };
     }
 }
@@ -28,6 +28,7 @@
 #include "util.hpp"
 #include "Ebml_parser.hpp"
 #include "Ebml_dispatcher.hpp"
+#include "stream_io_callback.hpp"
 
 #include <new>
 #include <iterator>
@@ -63,11 +64,14 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,ep( EbmlParser(&estream, p_seg, &demuxer.demuxer ))
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
+    ,p_indexer(NULL)
 {
 }
 
 matroska_segment_c::~matroska_segment_c()
 {
+    delete p_indexer;
+
     free( psz_writing_application );
     free( psz_muxing_application );
     free( psz_segment_filename );
@@ -837,6 +841,9 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 
     // find appropriate seekpoints //
 
+    if( p_indexer )
+        p_indexer->fetch( _seeker );
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
@@ -1147,11 +1154,38 @@ bool matroska_segment_c::ESCreate()
             es_out_Control( sys.demuxer.out, ES_OUT_SET_ES_DEFAULT, track->p_es );
     }
 
+    /* without Cues, find the clusters ahead of the playback */
+    vlc_stream_io_callback *io_callback = dynamic_cast<vlc_stream_io_callback *>( &es.I_O() );
+    if( !b_cues && !p_indexer && sys.b_seekable && sys.b_fastseekable && io_callback )
+    {
+        SegmentSeeker::track_ids_t track_ids;
+        for( tracks_map_t::const_iterator it = tracks.begin(); it != tracks.end(); ++it )
+            track_ids.push_back( it->first );
+
+        p_indexer = new (std::nothrow) SegmentIndexer( VLC_OBJECT( &sys.demuxer ),
+                                                       track_ids, i_timescale );
+        if( p_indexer &&
+            !p_indexer->start( io_callback->GetStream()->psz_url, segment->GetDataStart(),
+                               segment->IsFiniteSize() ? segment->GetEndPosition()
+                                                       : UINT64_MAX ) )
+        {
+            delete p_indexer;
+            p_indexer = NULL;
+        }
+    }
+
     return true;
 }
 
 void matroska_segment_c::ESDestroy( )
 {
+    if( p_indexer )
+    {
+        p_indexer->fetch( _seeker );
+        delete p_indexer;
+        p_indexer = NULL;
+    }
+
     sys.ev.ResetPci();
 
     for( tracks_map_t::iterator it = tracks.begin(); it != tracks.end(); ++it )
@@ -28,6 +28,7 @@
 #include "demux.hpp"
 #include "mkv.hpp"
 #include "matroska_segment_seeker.hpp"
+#include "matroska_segment_indexer.hpp"
 #include <vector>
 #include <string>
 
@@ -175,6 +176,7 @@ private:
     void EnsureDuration();
 
     SegmentSeeker _seeker;
+    SegmentIndexer *p_indexer;
 
     friend SegmentSeeker;
 };
@@ -0,0 +1,251 @@
+/*****************************************************************************
+ * matroska_segment_indexer.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "matroska_segment_indexer.hpp"
+
+#include <vlc_stream.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+    /* Only the headers are read, by hand, not to share the libebml
+     * objects of the demuxer with this thread */
+    const uint64_t ID_CLUSTER       = 0x1F43B675;
+    const uint64_t ID_TIMECODE      = 0xE7;
+    const uint64_t ID_SIMPLEBLOCK   = 0xA3;
+    const uint64_t ID_BLOCKGROUP    = 0xA0;
+
+    /* enough for an element header, the cluster timecode and the first
+     * block header, with a CRC-32, Position and PrevSize before them */
+    const size_t   HEADER_PEEK_SIZE = 64;
+
+    /* Reads an EBML variable size integer, keeping the length marker for
+     * IDs. Returns its length, or 0 if invalid. */
+    size_t ReadVint( const uint8_t *p, size_t i_size, uint64_t *pi_value,
+                     bool b_id, bool *pb_unknown = NULL )
+    {
+        if( i_size < 1 || p[0] == 0 )
+            return 0;
+
+        size_t i_len = 1;
+        for( uint8_t mask = 0x80; !( p[0] & mask ); mask >>= 1 )
+            i_len++;
+        if( i_len > ( b_id ? 4 : 8 ) || i_len > i_size )
+            return 0;
+
+        uint64_t i_value = b_id ? p[0] : p[0] & ( 0xFF >> i_len );
+        for( size_t i = 1; i < i_len; i++ )
+            i_value = ( i_value << 8 ) | p[i];
+
+        if( pb_unknown )
+            *pb_unknown = ( i_value == ( UINT64_C(1) << ( 7 * i_len ) ) - 1 );
+        *pi_value = i_value;
+        return i_len;
+    }
+}
+
+namespace mkv {
+
+SegmentIndexer::SegmentIndexer( vlc_object_t *p_obj, SegmentSeeker::track_ids_t const& tracks,
+                                uint64_t i_timescale )
+    : p_obj( p_obj )
+    , s( NULL )
+    , b_running( false )
+    , b_abort( false )
+    , tracks( tracks )
+    , i_timescale( i_timescale )
+    , i_start( 0 )
+    , i_end( 0 )
+{
+    vlc_mutex_init( &lock );
+}
+
+SegmentIndexer::~SegmentIndexer()
+{
+    if( b_running )
+    {
+        vlc_mutex_lock( &lock );
+        b_abort = true;
+        vlc_mutex_unlock( &lock );
+
+        vlc_join( thread, NULL );
+    }
+
+    if( s )
+        vlc_stream_Delete( s );
+    vlc_mutex_destroy( &lock );
+}
+
+bool SegmentIndexer::start( const char *psz_url, fptr_t start, fptr_t end )
+{
+    if( b_running || psz_url == NULL )
+        return false;
+
+    s = vlc_stream_NewURL( p_obj, psz_url );
+    if( s == NULL )
+        return false;
+
+    i_start = start;
+    i_end   = end;
+
+    b_running = !vlc_clone( &thread, IndexThread, this, VLC_THREAD_PRIORITY_LOW );
+    return b_running;
+}
+
+void SegmentIndexer::fetch( SegmentSeeker & seeker )
+{
+    std::vector<SegmentSeeker::Cluster> found_clusters;
+    std::vector<std::pair<track_id_t, SegmentSeeker::Seekpoint> > found_seekpoints;
+
+    {
+        vlc_mutex_locker lock_guard( &lock );
+        found_clusters.swap( clusters );
+        found_seekpoints.swap( seekpoints );
+    }
+
+    for( size_t i = 0; i < found_clusters.size(); i++ )
+        seeker.add_cluster( found_clusters[i] );
+
+    for( size_t i = 0; i < found_seekpoints.size(); i++ )
+        seeker.add_seekpoint( found_seekpoints[i].first, found_seekpoints[i].second );
+}
+
+void *SegmentIndexer::IndexThread( void *data )
+{
+    static_cast<SegmentIndexer*>( data )->IndexThread();
+    return NULL;
+}
+
+void SegmentIndexer::IndexThread()
+{
+    fptr_t fpos = i_start;
+    size_t i_clusters = 0;
+
+    while( fpos < i_end )
+    {
+        {
+            vlc_mutex_locker lock_guard( &lock );
+            if( b_abort )
+                return;
+        }
+
+        const uint8_t *p_peek;
+        ssize_t i_peek;
+        if( vlc_stream_Seek( s, fpos ) != VLC_SUCCESS ||
+            ( i_peek = vlc_stream_Peek( s, &p_peek, HEADER_PEEK_SIZE ) ) <= 0 )
+            break;
+
+        uint64_t i_id, i_size;
+        bool b_unknown;
+        size_t i_id_len = ReadVint( p_peek, i_peek, &i_id, true );
+        size_t i_size_len = i_id_len ? ReadVint( p_peek + i_id_len, i_peek - i_id_len,
+                                                 &i_size, false, &b_unknown ) : 0;
+        if( i_size_len == 0 || b_unknown )
+            break; /* broken, or live, we can't go any further */
+
+        const fptr_t i_header = i_id_len + i_size_len;
+        if( i_size > std::numeric_limits<fptr_t>::max() - fpos - i_header )
+            break;
+
+        if( i_id == ID_CLUSTER )
+        {
+            parseCluster( fpos, i_header + i_size, i_header,
+                          p_peek + i_header, i_peek - i_header );
+            i_clusters++;
+        }
+
+        fpos += i_header + i_size;
+    }
+
+    msg_Dbg( p_obj, "indexed %zu clusters up to %" PRIu64, i_clusters, fpos );
+}
+
+void SegmentIndexer::parseCluster( fptr_t fpos, fptr_t size, fptr_t i_header,
+                                   const uint8_t *p, size_t i_size )
+{
+    const uint8_t *p_start = p;
+    uint64_t i_timecode = 0;
+    bool b_timecode = false;
+
+    while( i_size > 0 )
+    {
+        uint64_t i_id, i_len;
+        size_t i_id_len = ReadVint( p, i_size, &i_id, true );
+        size_t i_len_len = i_id_len ? ReadVint( p + i_id_len, i_size - i_id_len,
+                                                &i_len, false ) : 0;
+        if( i_len_len == 0 )
+            break;
+
+        const uint8_t *p_data = p + i_id_len + i_len_len;
+        const size_t i_avail = i_size - i_id_len - i_len_len;
+
+        if( i_id == ID_TIMECODE )
+        {
+            if( i_len > 8 || i_len > i_avail )
+                break;
+            i_timecode = 0;
+            for( size_t i = 0; i < i_len; i++ )
+                i_timecode = ( i_timecode << 8 ) | p_data[i];
+            b_timecode = true;
+        }
+        else if( i_id == ID_SIMPLEBLOCK )
+        {
+            /* track number, relative timecode, flags */
+            uint64_t i_track;
+            size_t i_track_len = ReadVint( p_data, i_avail, &i_track, false );
+            if( b_timecode && i_track_len && i_avail >= i_track_len + 3 &&
+                ( p_data[i_track_len + 2] & 0x80 ) &&
+                std::find( tracks.begin(), tracks.end(), i_track ) != tracks.end() )
+            {
+                int16_t i_relative = GetWBE( &p_data[i_track_len] );
+                vlc_tick_t i_pts = ( (int64_t) i_timecode + i_relative ) *
+                                   (int64_t) i_timescale / 1000;
+
+                vlc_mutex_locker lock_guard( &lock );
+                seekpoints.push_back( std::make_pair( track_id_t( i_track ),
+                    SegmentSeeker::Seekpoint( fpos + i_header + ( p - p_start ), i_pts ) ) );
+            }
+            break;
+        }
+        else if( i_id == ID_BLOCKGROUP )
+            break;
+
+        if( i_len > i_avail )
+            break;
+        p = p_data + i_len;
+        i_size = i_avail - i_len;
+    }
+
+    if( !b_timecode )
+        return;
+
+    SegmentSeeker::Cluster cinfo = {
+        /* fpos     */ fpos,
+        /* pts      */ vlc_tick_t( i_timecode * i_timescale / 1000 ),
+        /* duration */ vlc_tick_t( -1 ),
+        /* size     */ size
+    };
+
+    vlc_mutex_locker lock_guard( &lock );
+    clusters.push_back( cinfo );
+}
+
+} // namespace
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * matroska_segment_indexer.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+#define MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+
+#include "matroska_segment_seeker.hpp"
+
+#include <vlc_threads.h>
+
+#include <utility>
+#include <vector>
+
+namespace mkv {
+
+/* Walks the cluster headers of a segment without Cues, on its own stream
+ * and thread, so that seeking does not have to read all the clusters up
+ * to the target. The first block of each cluster is used as seekpoint
+ * when it is a keyframe. */
+class SegmentIndexer
+{
+    public:
+        typedef SegmentSeeker::fptr_t fptr_t;
+        typedef SegmentSeeker::track_id_t track_id_t;
+
+        SegmentIndexer( vlc_object_t *, SegmentSeeker::track_ids_t const&,
+                        uint64_t i_timescale );
+        ~SegmentIndexer();
+
+        bool start( const char *psz_url, fptr_t start, fptr_t end );
+
+        /* moves the clusters found so far to the seeker */
+        void fetch( SegmentSeeker & );
+
+    private:
+        void IndexThread();
+        static void *IndexThread( void * );
+        void parseCluster( fptr_t fpos, fptr_t size, fptr_t header,
+                           const uint8_t *, size_t );
+
+        vlc_object_t *p_obj;
+        stream_t     *s;
+        vlc_thread_t  thread;
+        vlc_mutex_t   lock;
+        bool          b_running;
+        bool          b_abort;
+
+        SegmentSeeker::track_ids_t tracks;
+        uint64_t     i_timescale;
+        fptr_t       i_start;
+        fptr_t       i_end;
+
+        std::vector<SegmentSeeker::Cluster> clusters;
+        std::vector<std::pair<track_id_t, SegmentSeeker::Seekpoint> > seekpoints;
+};
+
+} // namespace
+
+#endif /* include-guard */
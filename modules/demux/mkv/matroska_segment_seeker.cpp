@@ -47,6 +47,11 @@ namespace {
 
     template<class It> It prev_( It it ) { return --it; }
     template<class It> It next_( It it ) { return ++it; }
+
+    bool cluster_before( mkv::SegmentSeeker::Cluster const& cluster, vlc_tick_t pts )
+    {
+        return cluster.pts < pts;
+    }
 }
 
 namespace mkv {
@@ -60,10 +65,14 @@ SegmentSeeker::add_cluster_position( fptr_t fpos )
       fpos
     );
 
+    // Cues list the same cluster for each track
+    if( insertion_point != _cluster_positions.begin() && *prev_( insertion_point ) == fpos )
+        return prev_( insertion_point );
+
     return _cluster_positions.insert( insertion_point, fpos );
 }
 
-SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::clusters_t::iterator
 SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
 {
     Cluster cinfo = {
@@ -75,17 +84,24 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
             : UINT64_MAX
     };
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::clusters_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     add_cluster_position( cinfo.fpos );
 
-    cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
+    clusters_t::iterator it = std::lower_bound( _clusters.begin(), _clusters.end(),
+                                                cinfo.pts, cluster_before );
 
-    if( it != _clusters.end() && it->second.pts == cinfo.pts )
+    if( it != _clusters.end() && it->pts == cinfo.pts )
     {
         // cluster already known
     }
     else
     {
-        it = _clusters.insert( cluster_map_t::value_type( cinfo.pts, cinfo ) ).first;
+        it = _clusters.insert( it, cinfo );
     }
 
     // ------------------------------------------------------------------
@@ -102,12 +118,12 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
 
     if( it != _clusters.begin() )
     {
-        Duration::fix( prev_( it )->second, it->second );
+        Duration::fix( *prev_( it ), *it );
     }
 
     if( it != _clusters.end() && next_( it ) != _clusters.end() )
     {
-        Duration::fix( it->second, next_( it )->second );
+        Duration::fix( *it, *next_( it ) );
     }
 
     return it;
@@ -116,20 +132,7 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
 void
 SegmentSeeker::add_seekpoint( track_id_t track_id, Seekpoint sp )
 {
-    seekpoints_t&  seekpoints = _tracks_seekpoints[ track_id ];
-    seekpoints_t::iterator it = std::lower_bound( seekpoints.begin(), seekpoints.end(), sp );
-
-    if( it != seekpoints.end() && it->pts == sp.pts )
-    {
-        if (sp.trust_level <= it->trust_level)
-            return;
-
-        *it = sp;
-    }
-    else
-    {
-        seekpoints.insert( it, sp );
-    }
+    _tracks_seekpoints[ track_id ].add( sp );
 }
 
 SegmentSeeker::tracks_seekpoint_t
@@ -137,9 +140,10 @@ SegmentSeeker::find_greatest_seekpoints_in_range( fptr_t start_fpos, vlc_tick_t
 {
     tracks_seekpoint_t tpoints;
 
-    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); it != _tracks_seekpoints.end(); ++it )
+    for( track_ids_t::const_iterator id_it = filter_tracks.begin(); id_it != filter_tracks.end(); ++id_it )
     {
-        if ( std::find( filter_tracks.begin(), filter_tracks.end(), it->first ) == filter_tracks.end() )
+        tracks_seekpoints_t::iterator it = _tracks_seekpoints.find( *id_it );
+        if( it == _tracks_seekpoints.end() )
             continue;
 
         Seekpoint sp = get_first_seekpoint_around( end_pts, it->second );
@@ -156,9 +160,10 @@ SegmentSeeker::find_greatest_seekpoints_in_range( fptr_t start_fpos, vlc_tick_t
     if (tpoints.empty())
     {
         // try a further pts
-        for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); it != _tracks_seekpoints.end(); ++it )
+        for( track_ids_t::const_iterator id_it = filter_tracks.begin(); id_it != filter_tracks.end(); ++id_it )
         {
-            if ( std::find( filter_tracks.begin(), filter_tracks.end(), it->first ) == filter_tracks.end() )
+            tracks_seekpoints_t::iterator it = _tracks_seekpoints.find( *id_it );
+            if( it == _tracks_seekpoints.end() )
                 continue;
 
             Seekpoint sp = get_first_seekpoint_around( end_pts, it->second );
@@ -174,58 +179,45 @@ SegmentSeeker::find_greatest_seekpoints_in_range( fptr_t start_fpos, vlc_tick_t
 }
 
 SegmentSeeker::Seekpoint
-SegmentSeeker::get_first_seekpoint_around( vlc_tick_t pts, seekpoints_t const& seekpoints,
+SegmentSeeker::get_first_seekpoint_around( vlc_tick_t pts, SeekpointIndex& seekpoints,
                                            Seekpoint::TrustLevel trust_level )
 {
+    seekpoints.commit();
+
     if( seekpoints.empty() )
     {
         return Seekpoint();
     }
 
-    typedef seekpoints_t::const_iterator iterator;
-
-    Seekpoint const needle ( std::numeric_limits<fptr_t>::max(), pts );
-
-    iterator const it_begin  = seekpoints.begin();
-    iterator const it_end    = seekpoints.end();
-    iterator const it_middle = greatest_lower_bound( it_begin, it_end, needle );
-
-    iterator it_before;
-
     // rewrind to _previous_ seekpoint with appropriate trust
-    for( it_before = it_middle; it_before != it_begin; --it_before )
+    for( size_t i = seekpoints.greatest_lower_bound( pts ); i != 0; --i )
     {
-        if( it_before->trust_level >= trust_level )
-            return *it_before;
+        if( seekpoints.trust_level( i ) >= trust_level )
+            return seekpoints[ i ];
     }
-    return *it_begin;
+    return seekpoints[ 0 ];
 }
 
 SegmentSeeker::seekpoint_pair_t
-SegmentSeeker::get_seekpoints_around( vlc_tick_t pts, seekpoints_t const& seekpoints )
+SegmentSeeker::get_seekpoints_around( vlc_tick_t pts, SeekpointIndex& seekpoints )
 {
+    seekpoints.commit();
+
     if( seekpoints.empty() )
     {
         return seekpoint_pair_t();
     }
 
-    typedef seekpoints_t::const_iterator iterator;
-
-    Seekpoint const needle ( std::numeric_limits<fptr_t>::max(), pts );
-
-    iterator const it_begin  = seekpoints.begin();
-    iterator const it_end    = seekpoints.end();
-    iterator const it_middle = greatest_lower_bound( it_begin, it_end, needle );
+    size_t const i_middle = seekpoints.greatest_lower_bound( pts );
 
-    if ( it_middle != it_end && (*it_middle).pts > pts)
+    if ( seekpoints.pts( i_middle ) > pts )
         // found nothing low enough, use the first one
-        return seekpoint_pair_t( *it_begin, Seekpoint() );
+        return seekpoint_pair_t( seekpoints[ 0 ], Seekpoint() );
 
-    iterator it_before = it_middle;
-    iterator it_after = it_middle == it_end ? it_middle : next_( it_middle ) ;
+    size_t const i_after = i_middle + 1;
 
-    return seekpoint_pair_t( *it_before,
-      it_after == it_end ? Seekpoint() : *it_after
+    return seekpoint_pair_t( seekpoints[ i_middle ],
+      i_after == seekpoints.size() ? Seekpoint() : seekpoints[ i_after ]
     );
 }
 
@@ -265,11 +257,12 @@ SegmentSeeker::get_seekpoints_around( vlc_tick_t target_pts, track_ids_t const&
 
     { // check if we got a cluster which is closer to target_pts than the found cues //
 
-        cluster_map_t::iterator it = _clusters.lower_bound( target_pts );
+        clusters_t::const_iterator it = std::lower_bound( _clusters.begin(), _clusters.end(),
+                                                          target_pts, cluster_before );
 
         if( it != _clusters.begin() && --it != _clusters.end() )
         {
-            Cluster const& cluster = it->second;
+            Cluster const& cluster = *it;
 
             if( cluster.fpos > points.first.fpos )
             {
@@ -25,6 +25,7 @@
 #define MKV_MATROSKA_SEGMENT_SEEKER_HPP_
 
 #include "mkv.hpp"
+#include "matroska_segment_seekpoints.hpp"
 
 #include <algorithm>
 #include <vector>
@@ -55,31 +56,7 @@ class SegmentSeeker
             }
         };
 
-        struct Seekpoint
-        {
-            enum TrustLevel {
-                TRUSTED = +3,
-                QUESTIONABLE = +2,
-                DISABLED = -1,
-            };
-
-            Seekpoint( fptr_t fpos, vlc_tick_t pts, TrustLevel trust_level = TRUSTED )
-                : fpos( fpos ), pts( pts ), trust_level( trust_level )
-            { }
-
-            Seekpoint()
-                : Seekpoint( std::numeric_limits<fptr_t>::max(), -1, DISABLED )
-            { }
-
-            bool operator<( Seekpoint const& rhs ) const
-            {
-                return pts < rhs.pts;
-            }
-
-            fptr_t fpos;
-            vlc_tick_t pts;
-            TrustLevel trust_level;
-        };
+        typedef mkv::Seekpoint Seekpoint;
 
         struct Cluster {
             fptr_t  fpos;
@@ -91,26 +68,26 @@ class SegmentSeeker
     public:
         typedef std::vector<track_id_t> track_ids_t;
         typedef std::vector<Range> ranges_t;
-        typedef std::vector<Seekpoint> seekpoints_t;
         typedef std::vector<fptr_t> cluster_positions_t;
 
         typedef std::map<track_id_t, Seekpoint> tracks_seekpoint_t;
-        typedef std::map<track_id_t, seekpoints_t> tracks_seekpoints_t;
-        typedef std::map<vlc_tick_t, Cluster> cluster_map_t;
+        typedef std::map<track_id_t, SeekpointIndex> tracks_seekpoints_t;
+        typedef std::vector<Cluster> clusters_t; /* sorted by pts */
 
         typedef std::pair<Seekpoint, Seekpoint> seekpoint_pair_t;
 
         void add_seekpoint( track_id_t, Seekpoint );
 
-        seekpoint_pair_t get_seekpoints_around( vlc_tick_t, seekpoints_t const& );
-        Seekpoint get_first_seekpoint_around( vlc_tick_t, seekpoints_t const&, Seekpoint::TrustLevel = Seekpoint::TRUSTED );
+        seekpoint_pair_t get_seekpoints_around( vlc_tick_t, SeekpointIndex& );
+        Seekpoint get_first_seekpoint_around( vlc_tick_t, SeekpointIndex&, Seekpoint::TrustLevel = Seekpoint::TRUSTED );
         seekpoint_pair_t get_seekpoints_around( vlc_tick_t, track_ids_t const& );
 
         tracks_seekpoint_t get_seekpoints( matroska_segment_c&, vlc_tick_t, track_ids_t const&, track_ids_t const& );
         tracks_seekpoint_t find_greatest_seekpoints_in_range( fptr_t , vlc_tick_t, track_ids_t const& filter_tracks );
 
         cluster_positions_t::iterator add_cluster_position( fptr_t pos );
-        cluster_map_t      ::iterator add_cluster( KaxCluster * const );
+        clusters_t         ::iterator add_cluster( KaxCluster * const );
+        clusters_t         ::iterator add_cluster( Cluster const& );
 
         void mkv_jump_to( matroska_segment_c&, fptr_t );
 
@@ -124,7 +101,7 @@ class SegmentSeeker
         ranges_t            _ranges_searched;
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
-        cluster_map_t       _clusters;
+        clusters_t          _clusters;
 };
 
 } // namespace
@@ -0,0 +1,116 @@
+/*****************************************************************************
+ * matroska_segment_seekpoints.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "matroska_segment_seekpoints.hpp"
+
+#include <algorithm>
+
+namespace {
+    /* by pts, the most trusted first */
+    bool seekpoint_order( mkv::Seekpoint const& lhs, mkv::Seekpoint const& rhs )
+    {
+        if( lhs.pts != rhs.pts )
+            return lhs.pts < rhs.pts;
+        return lhs.trust_level > rhs.trust_level;
+    }
+}
+
+namespace mkv {
+
+void
+SeekpointIndex::append( Seekpoint const& sp )
+{
+    _pts.push_back( sp.pts );
+    _fpos.push_back( sp.fpos );
+    _trust.push_back( sp.trust_level );
+}
+
+void
+SeekpointIndex::add( Seekpoint const& sp )
+{
+    if( _pts.empty() || _pts.back() < sp.pts )
+    {
+        append( sp );
+    }
+    else if( _pts.back() == sp.pts )
+    {
+        if( sp.trust_level > _trust.back() )
+        {
+            _fpos.back()  = sp.fpos;
+            _trust.back() = sp.trust_level;
+        }
+    }
+    else
+    {
+        _pending.push_back( sp );
+    }
+}
+
+void
+SeekpointIndex::commit()
+{
+    if( _pending.empty() )
+        return;
+
+    std::stable_sort( _pending.begin(), _pending.end(), seekpoint_order );
+
+    SeekpointIndex merged;
+    merged._pts.reserve( _pts.size() + _pending.size() );
+    merged._fpos.reserve( _pts.size() + _pending.size() );
+    merged._trust.reserve( _pts.size() + _pending.size() );
+
+    size_t i = 0, j = 0;
+    while( i < _pts.size() || j < _pending.size() )
+    {
+        if( j == _pending.size() || ( i < _pts.size() && _pts[i] < _pending[j].pts ) )
+        {
+            merged.append( (*this)[i++] );
+            continue;
+        }
+
+        /* the first pending one is the most trusted at that pts */
+        Seekpoint const& sp = _pending[j];
+
+        if( i < _pts.size() && _pts[i] == sp.pts )
+        {
+            merged.append( sp.trust_level > _trust[i] ? sp : (*this)[i] );
+            i++;
+        }
+        else
+            merged.append( sp );
+
+        while( j < _pending.size() && _pending[j].pts == sp.pts )
+            j++;
+    }
+
+    _pts.swap( merged._pts );
+    _fpos.swap( merged._fpos );
+    _trust.swap( merged._trust );
+    _pending.clear();
+}
+
+size_t
+SeekpointIndex::greatest_lower_bound( vlc_tick_t pts ) const
+{
+    size_t i = std::upper_bound( _pts.begin(), _pts.end(), pts ) - _pts.begin();
+    return i ? i - 1 : 0;
+}
+
+} // namespace
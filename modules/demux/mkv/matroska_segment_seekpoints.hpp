@@ -0,0 +1,99 @@
+/*****************************************************************************
+ * matroska_segment_seekpoints.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_MATROSKA_SEGMENT_SEEKPOINTS_HPP_
+#define MKV_MATROSKA_SEGMENT_SEEKPOINTS_HPP_
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include <limits>
+#include <vector>
+
+namespace mkv {
+
+struct Seekpoint
+{
+    typedef uint64_t fptr_t;
+
+    enum TrustLevel {
+        TRUSTED = +3,
+        QUESTIONABLE = +2,
+        DISABLED = -1,
+    };
+
+    Seekpoint( fptr_t fpos, vlc_tick_t pts, TrustLevel trust_level = TRUSTED )
+        : fpos( fpos ), pts( pts ), trust_level( trust_level )
+    { }
+
+    Seekpoint()
+        : Seekpoint( std::numeric_limits<fptr_t>::max(), -1, DISABLED )
+    { }
+
+    bool operator<( Seekpoint const& rhs ) const
+    {
+        return pts < rhs.pts;
+    }
+
+    fptr_t fpos;
+    vlc_tick_t pts;
+    TrustLevel trust_level;
+};
+
+/* Seekpoints of a track, sorted by pts, with one array per field so that
+ * lookups only walk the timestamps. Seekpoints added in order are appended,
+ * the others are batched and merged on the next commit(). At equal pts, the
+ * most trusted seekpoint is kept, or the first one added. */
+class SeekpointIndex
+{
+    public:
+        typedef Seekpoint::fptr_t fptr_t;
+
+        void add( Seekpoint const& );
+        void commit();
+
+        /* committed seekpoints only */
+        size_t size() const { return _pts.size(); }
+        bool empty() const { return _pts.empty(); }
+
+        Seekpoint operator[]( size_t i ) const
+        {
+            return Seekpoint( _fpos[i], _pts[i], _trust[i] );
+        }
+
+        vlc_tick_t pts( size_t i ) const { return _pts[i]; }
+        Seekpoint::TrustLevel trust_level( size_t i ) const { return _trust[i]; }
+
+        /* last seekpoint at or before pts, or the first one */
+        size_t greatest_lower_bound( vlc_tick_t pts ) const;
+
+    private:
+        void append( Seekpoint const& );
+
+        std::vector<vlc_tick_t>            _pts;
+        std::vector<fptr_t>                _fpos;
+        std::vector<Seekpoint::TrustLevel> _trust;
+
+        std::vector<Seekpoint>             _pending;
+};
+
+} // namespace
+
+#endif /* include-guard */
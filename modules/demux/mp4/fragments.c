@@ -41,55 +41,161 @@ mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_n
     mp4_fragments_index_t *p_index = malloc( sizeof(*p_index) );
     if( p_index )
     {
-        p_index->p_times = calloc( (size_t)i_num * i_tracks, sizeof(*p_index->p_times) );
-        p_index->pi_pos = calloc( i_num, sizeof(*p_index->pi_pos) );
+        p_index->p_times = vlc_alloc( (size_t)i_num * i_tracks, sizeof(*p_index->p_times) );
+        p_index->pi_pos = vlc_alloc( i_num, sizeof(*p_index->pi_pos) );
         if( !p_index->p_times || !p_index->pi_pos )
         {
             MP4_Fragments_Index_Delete( p_index );
             return NULL;
         }
-        p_index->i_entries = i_num;
+        p_index->i_entries = 0;
+        p_index->i_allocated = i_num;
         p_index->i_last_time = 0;
         p_index->i_tracks = i_tracks;
+        p_index->b_complete = false;
     }
     return p_index;
 }
 
-stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
-                                              unsigned i_track_index, uint64_t i_moof_pos )
+static bool MP4_Fragments_Index_Find( const mp4_fragments_index_t *p_index,
+                                      uint64_t i_pos, unsigned *pi_entry )
 {
-    for( size_t i=0; i<p_index->i_entries; i++ )
+    unsigned i_low = 0, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->pi_pos[i] >= i_moof_pos )
-            return p_index->p_times[i * p_index->i_tracks + i_track_index];
+        const unsigned i_mid = i_low + ( i_high - i_low ) / 2;
+        if( p_index->pi_pos[i_mid] < i_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
-    return 0;
+    *pi_entry = i_low;
+    return i_low < p_index->i_entries && p_index->pi_pos[i_low] == i_pos;
+}
+
+bool MP4_Fragments_Index_Add( mp4_fragments_index_t *p_index, uint64_t i_pos,
+                              const mp4_fragment_time_t *p_times )
+{
+    const unsigned i_tracks = p_index->i_tracks;
+    unsigned i_entry;
+
+    if( !MP4_Fragments_Index_Find( p_index, i_pos, &i_entry ) )
+    {
+        if( p_index->i_entries == p_index->i_allocated )
+        {
+            const unsigned i_allocated = p_index->i_allocated * 2;
+            if( i_allocated < p_index->i_allocated ||
+                SIZE_MAX / sizeof(*p_index->p_times) / i_tracks < i_allocated )
+                return false;
+            uint64_t *pi_pos = realloc( p_index->pi_pos,
+                                        (size_t)i_allocated * sizeof(*pi_pos) );
+            if( !pi_pos )
+                return false;
+            p_index->pi_pos = pi_pos;
+            mp4_fragment_time_t *p_realloc =
+                realloc( p_index->p_times, (size_t)i_allocated * i_tracks *
+                                           sizeof(*p_realloc) );
+            if( !p_realloc )
+                return false;
+            p_index->p_times = p_realloc;
+            p_index->i_allocated = i_allocated;
+        }
+
+        /* Fragments are mostly parsed in order, and appended */
+        memmove( &p_index->pi_pos[i_entry + 1], &p_index->pi_pos[i_entry],
+                 ( p_index->i_entries - i_entry ) * sizeof(*p_index->pi_pos) );
+        memmove( &p_index->p_times[(size_t)(i_entry + 1) * i_tracks],
+                 &p_index->p_times[(size_t)i_entry * i_tracks],
+                 (size_t)( p_index->i_entries - i_entry ) * i_tracks *
+                 sizeof(*p_index->p_times) );
+        p_index->pi_pos[i_entry] = i_pos;
+        for( unsigned i=0; i<i_tracks; i++ )
+        {
+            mp4_fragment_time_t *p_time = &p_index->p_times[(size_t)i_entry * i_tracks + i];
+            p_time->i_start = p_time->i_end = p_time->i_sync = MP4_FRAGMENTS_NO_TIME;
+        }
+        p_index->i_entries++;
+    }
+
+    for( unsigned i=0; i<i_tracks; i++ )
+    {
+        if( p_times[i].i_start == MP4_FRAGMENTS_NO_TIME )
+            continue;
+        mp4_fragment_time_t *p_time = &p_index->p_times[(size_t)i_entry * i_tracks + i];
+        p_time->i_start = p_times[i].i_start;
+        p_time->i_end = p_times[i].i_end;
+        if( p_times[i].i_sync != MP4_FRAGMENTS_NO_TIME )
+            p_time->i_sync = p_times[i].i_sync;
+        if( p_index->i_last_time < p_time->i_end )
+            p_index->i_last_time = p_time->i_end;
+    }
+
+    return true;
+}
+
+bool MP4_Fragment_Index_GetTrackStartTime( const mp4_fragments_index_t *p_index,
+                                           unsigned i_track_index, uint64_t i_moof_pos,
+                                           stime_t *pi_time )
+{
+    unsigned i_entry;
+    if( !MP4_Fragments_Index_Find( p_index, i_moof_pos, &i_entry ) )
+        return false;
+    *pi_time = p_index->p_times[(size_t)i_entry * p_index->i_tracks + i_track_index].i_start;
+    return *pi_time != MP4_FRAGMENTS_NO_TIME;
 }
 
 stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, unsigned i )
 {
-    return p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks + i];
+    if( p_index->i_entries < 1 )
+        return 0;
+    const stime_t i_start =
+        p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks + i].i_start;
+    return ( i_start != MP4_FRAGMENTS_NO_TIME ) ? i_start : 0;
 }
 
 bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_time,
-                                 uint64_t *pi_pos, unsigned i_track_index )
+                                 uint64_t *pi_pos, unsigned i_track_index, bool *pb_sync )
 {
     if( *pi_time >= p_index->i_last_time || p_index->i_entries < 1 ||
         i_track_index >= p_index->i_tracks )
         return false;
 
-    for( size_t i=1; i<p_index->i_entries; i++ )
+    const mp4_fragment_time_t *p_times = &p_index->p_times[i_track_index];
+    const unsigned i_tracks = p_index->i_tracks;
+
+    /* Last fragment starting before that time */
+    size_t i_found = SIZE_MAX;
+    for( size_t i=0; i<p_index->i_entries; i++ )
+    {
+        const mp4_fragment_time_t *p_time = &p_times[i * i_tracks];
+        if( p_time->i_start == MP4_FRAGMENTS_NO_TIME )
+            continue;
+        if( p_time->i_start > *pi_time )
+            break;
+        i_found = i;
+    }
+
+    /* Unless all fragments are known, it must cover that time */
+    if( i_found == SIZE_MAX ||
+        ( !p_index->b_complete && p_times[i_found * i_tracks].i_end <= *pi_time ) )
+        return false;
+
+    /* Start from the last sync sample before that time, when known */
+    for( size_t i=i_found + 1; i-- > 0; )
     {
-        if( p_index->p_times[i * p_index->i_tracks + i_track_index] > *pi_time )
+        const mp4_fragment_time_t *p_time = &p_times[i * i_tracks];
+        if( p_time->i_sync != MP4_FRAGMENTS_NO_TIME && p_time->i_sync <= *pi_time )
         {
-            *pi_time = p_index->p_times[(i - 1) * p_index->i_tracks + i_track_index];
-            *pi_pos = p_index->pi_pos[i - 1];
+            *pi_time = p_time->i_sync;
+            *pi_pos = p_index->pi_pos[i];
+            *pb_sync = true;
             return true;
         }
     }
 
-    *pi_time = p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks];
-    *pi_pos = p_index->pi_pos[p_index->i_entries - 1];
+    *pi_time = p_times[i_found * i_tracks].i_start;
+    *pi_pos = p_index->pi_pos[i_found];
+    *pb_sync = false;
     return true;
 }
 
@@ -105,14 +211,14 @@ void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t
         if( i + 1 == p_index->i_entries )
             i_end = p_index->i_last_time;
         else
-            i_end = p_index->p_times[(i + 1) * p_index->i_tracks];
+            i_end = p_index->p_times[(i + 1) * p_index->i_tracks].i_start;
 
         for( unsigned j=0; j<p_index->i_tracks; j++ )
         {
             char *psz_start = NULL;
             if( 0 < asprintf( &psz_start, "%s [%u]%"PRId64"ms ",
                       (psz_starts) ? psz_starts : "", j,
-                  INT64_C( 1000 ) * p_index->p_times[i * p_index->i_tracks + j] / i_movie_timescale ) )
+                  INT64_C( 1000 ) * p_index->p_times[i * p_index->i_tracks + j].i_start / i_movie_timescale ) )
             {
                 free( psz_starts );
                 psz_starts = psz_start;
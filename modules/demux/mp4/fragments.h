@@ -23,24 +23,46 @@
 #include <vlc_common.h>
 #include "libmp4.h"
 
+#define MP4_FRAGMENTS_NO_TIME INT64_MIN
+
+typedef struct
+{
+    stime_t i_start; // movie scaled
+    stime_t i_end;
+    stime_t i_sync;  // first sync sample, if any
+} mp4_fragment_time_t;
+
+/* Fragments by position, with their time for each track. Filled either
+ * by scanning the whole file, or as fragments are parsed. */
 typedef struct mp4_fragments_index_t
 {
     uint64_t *pi_pos;
-    stime_t  *p_times; // movie scaled
+    mp4_fragment_time_t *p_times; // i_tracks per fragment
     unsigned i_entries;
+    unsigned i_allocated;
     stime_t i_last_time; // movie scaled
     unsigned i_tracks;
+    bool b_complete; // all fragments of the file
 } mp4_fragments_index_t;
 
 void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index );
 mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_num );
 
-stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
-                                              unsigned i_track_index, uint64_t i_moof_pos );
+/* Adds or updates the fragment at i_pos, p_times having i_tracks entries.
+ * Unknown track times are MP4_FRAGMENTS_NO_TIME. */
+bool MP4_Fragments_Index_Add( mp4_fragments_index_t *p_index, uint64_t i_pos,
+                              const mp4_fragment_time_t *p_times );
+
+bool MP4_Fragment_Index_GetTrackStartTime( const mp4_fragments_index_t *p_index,
+                                           unsigned i_track_index, uint64_t i_moof_pos,
+                                           stime_t *pi_time );
 stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, unsigned i_track_index );
 
+/* Finds the fragment to start from for reaching *pi_time, preferably
+ * starting with a sync sample, which time is then returned. */
 bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index,
-                                 stime_t *pi_time, uint64_t *pi_pos, unsigned i_track_index );
+                                 stime_t *pi_time, uint64_t *pi_pos, unsigned i_track_index,
+                                 bool *pb_sync );
 
 #ifdef MP4_VERBOSE
 void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
@@ -1183,6 +1183,8 @@ typedef struct MP4_Box_data_tfhd_s
 #define MP4_TRUN_SAMPLE_SIZE         (1<<9)
 #define MP4_TRUN_SAMPLE_FLAGS        (1<<10)
 #define MP4_TRUN_SAMPLE_TIME_OFFSET  (1<<11)
+/* trex, tfhd and trun sample flags */
+#define MP4_SAMPLE_IS_NON_SYNC       (1<<16)
 typedef struct MP4_descriptor_trun_sample_t
 {
     uint32_t i_duration;
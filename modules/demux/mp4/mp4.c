@@ -37,6 +37,7 @@
 #include <vlc_url.h>
 #include <assert.h>
 #include <limits.h>
+#include <stdatomic.h>
 #include "../codec/cc.h"
 #include "heif.h"
 
@@ -173,6 +174,7 @@ static void MP4_TrackSelect  ( demux_t *, mp4_track_t *, bool );
 static int  MP4_TrackSeek   ( demux_t *, mp4_track_t *, vlc_tick_t );
 
 static uint64_t MP4_TrackGetPos    ( mp4_track_t * );
+static uint64_t MP4_TrackGetSamplePos( const mp4_track_t *, uint32_t, uint32_t );
 static uint32_t MP4_TrackGetReadSize( mp4_track_t *, uint32_t * );
 static int      MP4_TrackNextSample( demux_t *, mp4_track_t *, uint32_t );
 static void     MP4_TrackSetELST( demux_t *, mp4_track_t *, int64_t );
@@ -196,6 +198,11 @@ static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t i_target_time,
                                    uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime );
 static int FragGetMoofByTfraIndex( demux_t *p_demux, const vlc_tick_t i_target_time, unsigned i_track_ID,
                                    uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime );
+static int FragGetMoofByFragmentsIndex( demux_t *p_demux, vlc_tick_t i_target_time,
+                                        unsigned i_track_index, uint64_t *pi_moof_pos,
+                                        vlc_tick_t *pi_sampletime, bool *pb_sync );
+static bool FragGetTrafSyncOffset( MP4_Box_t *p_moov, const MP4_Box_t *p_traf,
+                                   stime_t *pi_offset );
 static void FragResetContext( demux_sys_t * );
 
 /* ASF Handlers */
@@ -319,27 +326,7 @@ static es_out_id_t * MP4_AddTrackES( es_out_t *out, mp4_track_t *p_track )
 static inline vlc_tick_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - p_chunk->i_sample_first;
-    int64_t sdts = p_chunk->i_first_dts;
-
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
-        {
-            sdts += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            sdts += i_sample * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    const stime_t sdts = MP4_SampleRuns_GetTime( &p_track->stts, p_track->i_sample );
 
     vlc_tick_t i_dts = MP4_rescale( sdts, p_track->i_timescale, CLOCK_FREQ );
 
@@ -369,26 +356,14 @@ static inline bool MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_track,
                                          vlc_tick_t *pi_delta )
 {
     VLC_UNUSED( p_demux );
-    mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+    uint32_t i_entry;
 
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
-
-    if( ck->p_sample_count_pts == NULL || ck->p_sample_offset_pts == NULL )
+    if( !MP4_SampleRuns_Find( &p_track->ctts, p_track->i_sample, &i_entry, NULL, NULL ) )
         return false;
 
-    for( i_index = 0; i_index < ck->i_entries_pts ; i_index++ )
-    {
-        if( i_sample < ck->p_sample_count_pts[i_index] )
-        {
-            *pi_delta = MP4_rescale( ck->p_sample_offset_pts[i_index],
-                                     p_track->i_timescale, CLOCK_FREQ );
-            return true;
-        }
-
-        i_sample -= ck->p_sample_count_pts[i_index];
-    }
-    return false;
+    *pi_delta = MP4_rescale( p_track->ctts.pi_value[i_entry] + p_track->i_cts_shift,
+                             p_track->i_timescale, CLOCK_FREQ );
+    return true;
 }
 
 static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *p_track,
@@ -396,44 +371,9 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
 {
     VLC_UNUSED( p_demux );
 
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    stime_t i_duration = 0;
-
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = p_track->i_sample - i;
-            break;
-        }
-    }
-
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
-        {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    const stime_t i_duration =
+            MP4_SampleRuns_GetTime( &p_track->stts, (uint64_t) p_track->i_sample + i_nb_samples ) -
+            MP4_SampleRuns_GetTime( &p_track->stts, p_track->i_sample );
 
     return MP4_rescale( i_duration, p_track->i_timescale, CLOCK_FREQ );
 }
@@ -1242,6 +1182,196 @@ static block_t * MP4_RTPHint_Convert( demux_t *p_demux, block_t *p_block, vlc_fo
     return p_converted;
 }
 
+/*
+ * Coalesced reads: on slow seeking streams, the upcoming chunks of all the
+ * selected tracks that are close enough in the file are read at once into a
+ * single span, and samples are handed out as blocks pointing into it. The
+ * span is freed when the last of its samples, and tracks, releases it.
+ */
+#define MP4_SPAN_MAX_SIZE   (4 * 1024 * 1024)
+#define MP4_SPAN_MAX_GAP    (128 * 1024) /* read through rather than seek */
+#define MP4_SPAN_MAX_CHUNKS 1024 /* lookahead, per track */
+
+struct mp4_span_t
+{
+    atomic_uint refs;
+    uint64_t    i_pos;
+    size_t      i_size;
+    uint8_t     p_data[];
+};
+
+typedef struct
+{
+    block_t     self;
+    mp4_span_t *p_span;
+} mp4_span_sample_t;
+
+typedef struct
+{
+    uint64_t i_start;
+    uint64_t i_end;
+} mp4_span_range_t;
+
+static mp4_span_t * MP4_SpanHold( mp4_span_t *p_span )
+{
+    atomic_fetch_add_explicit( &p_span->refs, 1, memory_order_relaxed );
+    return p_span;
+}
+
+static void MP4_SpanRelease( mp4_span_t *p_span )
+{
+    if( p_span && atomic_fetch_sub_explicit( &p_span->refs, 1,
+                                             memory_order_acq_rel ) == 1 )
+        free( p_span );
+}
+
+static void MP4_SpanSampleRelease( block_t *p_block )
+{
+    mp4_span_sample_t *p_sample = container_of( p_block, mp4_span_sample_t, self );
+
+    MP4_SpanRelease( p_sample->p_span );
+    free( p_sample );
+}
+
+static const struct vlc_block_callbacks mp4_span_cbs =
+{
+    MP4_SpanSampleRelease,
+};
+
+static bool MP4_SpanContains( const mp4_span_t *p_span,
+                              uint64_t i_pos, uint32_t i_size )
+{
+    return p_span && i_pos >= p_span->i_pos &&
+           i_pos - p_span->i_pos <= p_span->i_size &&
+           i_size <= p_span->i_size - ( i_pos - p_span->i_pos );
+}
+
+static int MP4_SpanRangeCmp( const void *a, const void *b )
+{
+    const mp4_span_range_t *p_a = a, *p_b = b;
+    return ( p_a->i_start > p_b->i_start ) - ( p_a->i_start < p_b->i_start );
+}
+
+/* Reads the span starting with the sample at i_pos, extended over the
+ * upcoming chunks of the selected tracks as long as they are contiguous,
+ * or nearly. Returns NULL if there is nothing to coalesce with. */
+static mp4_span_t * MP4_SpanRead( demux_t *p_demux, uint64_t i_pos, uint32_t i_size )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    mp4_span_range_t *p_ranges = NULL;
+    size_t i_ranges = 0;
+
+    for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+    {
+        const mp4_track_t *tk = &p_sys->track[i];
+        if( !tk->b_ok || tk->b_chapters_source || !tk->b_selected ||
+            tk->i_sample >= tk->i_sample_count || tk->i_chunk >= tk->i_chunk_count )
+            continue;
+
+        mp4_span_range_t *p_realloc =
+            realloc( p_ranges, ( i_ranges + MP4_SPAN_MAX_CHUNKS ) * sizeof(*p_ranges) );
+        if( !p_realloc )
+            break;
+        p_ranges = p_realloc;
+
+        for( uint32_t i_chunk = tk->i_chunk;
+             i_chunk < tk->i_chunk_count &&
+             i_chunk - tk->i_chunk < MP4_SPAN_MAX_CHUNKS; i_chunk++ )
+        {
+            const mp4_chunk_t *ck = &tk->chunk[i_chunk];
+            const uint32_t i_first = ( i_chunk == tk->i_chunk ) ? tk->i_sample
+                                                                : ck->i_sample_first;
+            const uint32_t i_last = __MIN( ck->i_sample_first + ck->i_sample_count,
+                                           tk->i_sample_count );
+            if( i_first >= i_last )
+                continue;
+
+            mp4_span_range_t range;
+            range.i_start = MP4_TrackGetSamplePos( tk, i_chunk, i_first );
+            range.i_end = MP4_TrackGetSamplePos( tk, i_chunk, i_last );
+            if( range.i_start >= i_pos + MP4_SPAN_MAX_SIZE )
+                break;
+            if( range.i_end > range.i_start && range.i_end > i_pos )
+                p_ranges[i_ranges++] = range;
+        }
+    }
+
+    uint64_t i_end = i_pos + i_size;
+    if( i_ranges )
+    {
+        qsort( p_ranges, i_ranges, sizeof(*p_ranges), MP4_SpanRangeCmp );
+        for( size_t i = 0; i < i_ranges; i++ )
+        {
+            if( p_ranges[i].i_start > i_end + MP4_SPAN_MAX_GAP )
+                break;
+            if( p_ranges[i].i_end > i_end )
+                i_end = __MAX( i_end, __MIN( p_ranges[i].i_end,
+                                             i_pos + MP4_SPAN_MAX_SIZE ) );
+            if( i_end >= i_pos + MP4_SPAN_MAX_SIZE )
+                break;
+        }
+    }
+    free( p_ranges );
+
+    if( i_end <= i_pos + i_size )
+        return NULL;
+
+    mp4_span_t *p_span = malloc( sizeof(*p_span) + ( i_end - i_pos ) );
+    if( !p_span )
+        return NULL;
+
+    ssize_t i_read = -1;
+    if( vlc_stream_Tell( p_demux->s ) == i_pos ||
+        MP4_Seek( p_demux->s, i_pos ) == VLC_SUCCESS )
+        i_read = vlc_stream_Read( p_demux->s, p_span->p_data, i_end - i_pos );
+    if( i_read < (ssize_t) i_size )
+    {
+        free( p_span );
+        return NULL;
+    }
+
+    atomic_init( &p_span->refs, 1 );
+    p_span->i_pos = i_pos;
+    p_span->i_size = i_read;
+    return p_span;
+}
+
+/* Returns the sample from the span covering it, reading a new span if
+ * none does. Returns NULL when the sample has to be read on its own. */
+static block_t * MP4_SpanGetSample( demux_t *p_demux, mp4_track_t *tk,
+                                    uint64_t i_pos, uint32_t i_size )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !MP4_SpanContains( tk->p_span, i_pos, i_size ) )
+    {
+        mp4_span_t *p_span = NULL;
+
+        /* Interleaved tracks share the same span */
+        for( unsigned i = 0; i < p_sys->i_tracks && !p_span; i++ )
+        {
+            if( MP4_SpanContains( p_sys->track[i].p_span, i_pos, i_size ) )
+                p_span = MP4_SpanHold( p_sys->track[i].p_span );
+        }
+
+        if( !p_span )
+            p_span = MP4_SpanRead( p_demux, i_pos, i_size );
+
+        MP4_SpanRelease( tk->p_span );
+        tk->p_span = p_span;
+        if( !p_span )
+            return NULL;
+    }
+
+    mp4_span_sample_t *p_sample = malloc( sizeof(*p_sample) );
+    if( !p_sample )
+        return NULL;
+    p_sample->p_span = MP4_SpanHold( tk->p_span );
+
+    return block_Init( &p_sample->self, &mp4_span_cbs,
+                       &tk->p_span->p_data[i_pos - tk->p_span->i_pos], i_size );
+}
+
 /*****************************************************************************
  * Demux: read packet and send them to decoders
  *****************************************************************************
@@ -1280,10 +1410,13 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
         i_samplessize = MP4_TrackGetReadSize( tk, &i_nb_samples );
         if( i_samplessize > 0 )
         {
-            block_t *p_block;
+            block_t *p_block = NULL;
             vlc_tick_t i_delta;
 
-            if( vlc_stream_Tell( p_demux->s ) != i_readpos )
+            if( !p_sys->b_fastseekable )
+                p_block = MP4_SpanGetSample( p_demux, tk, i_readpos, i_samplessize );
+
+            if( p_block == NULL && vlc_stream_Tell( p_demux->s ) != i_readpos )
             {
                 if( MP4_Seek( p_demux->s, i_readpos ) != VLC_SUCCESS )
                 {
@@ -1296,7 +1429,8 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
             }
 
             /* now read pes */
-            if( !(p_block = vlc_stream_Block( p_demux->s, i_samplessize )) )
+            if( p_block == NULL &&
+                !(p_block = vlc_stream_Block( p_demux->s, i_samplessize )) )
             {
                 msg_Warn( p_demux, "track[0x%x] will be disabled (eof?)"
                                    ": Failed to read %d bytes sample at %"PRIu64,
@@ -1749,6 +1883,12 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
         i_segment_time = i_sync_time;
         msg_Dbg( p_demux, "seeking to sidx moof pos %" PRId64 " %" PRId64, i64, i_sync_time );
     }
+    else if( FragGetMoofByFragmentsIndex( p_demux, i_nztime, i_seek_track_index,
+                                          &i64, &i_sync_time, &b_iframesync ) == VLC_SUCCESS )
+    {
+        /* Fragment already parsed or probed */
+        msg_Dbg( p_demux, "seeking to indexed fragment pos %" PRId64 " %" PRId64, i64, i_sync_time );
+    }
     else
     {
         bool b_buildindex = false;
@@ -1795,14 +1935,13 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
 
         if( p_sys->b_fragments_probed && p_sys->p_fragsindex )
         {
-            stime_t i_basetime = MP4_rescale( i_sync_time, CLOCK_FREQ, p_sys->i_timescale );
-            if( !MP4_Fragments_Index_Lookup( p_sys->p_fragsindex, &i_basetime, &i64, i_seek_track_index ) )
+            if( FragGetMoofByFragmentsIndex( p_demux, i_sync_time, i_seek_track_index,
+                                             &i64, &i_sync_time, &b_iframesync ) != VLC_SUCCESS )
             {
                 p_sys->b_error = (vlc_stream_Seek( p_demux->s, i_backup_pos ) != VLC_SUCCESS);
                 return VLC_EGENERIC;
             }
-            msg_Dbg( p_demux, "seeking to fragment index pos %" PRId64 " %" PRId64, i64,
-                     MP4_rescale( i_basetime, p_sys->i_timescale, CLOCK_FREQ ) );
+            msg_Dbg( p_demux, "seeking to fragment index pos %" PRId64 " %" PRId64, i64, i_sync_time );
         }
     }
 
@@ -2429,14 +2568,7 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
 
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
-
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2498,54 +2630,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_ENOVAR;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2583,18 +2667,11 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, read from the box */
+        if( stsz->i_entry_size == NULL )
+            return VLC_EGENERIC;
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2607,124 +2684,62 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
-
-    int64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
     }
-    else
-    {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
-        msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
+    MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
-        /* Create sample -> dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+    msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
-        {
-            mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* save first dts */
-            ck->i_first_dts = i_next_dts;
+    /* The table is not expanded: samples times are looked up in place */
+    MP4_SampleRuns_Init( &p_demux_track->stts, stts->pi_sample_count,
+                         stts->pi_sample_delta, stts->i_entry_count, true );
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
+    /* Chunks times, needed for interleaving and seeking,
+     * walking the table once */
+    int64_t i_next_dts = 0;
+    uint32_t i_index = 0;
+    uint32_t i_index_samples_left = stts->i_entry_count ? stts->pi_sample_count[0] : 0;
+    bool b_truncated = false;
 
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
+    for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
+    {
+        mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
+        uint32_t i_sample_count = ck->i_sample_count;
 
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+        ck->i_first_dts = i_next_dts;
 
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
+        while( i_sample_count > 0 )
+        {
+            if( i_index_samples_left == 0 )
             {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                if( i_index + 1 >= stts->i_entry_count )
                 {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    b_truncated = true;
+                    break;
                 }
-
+                i_index_samples_left = stts->pi_sample_count[++i_index];
+                continue;
             }
+
+            const uint32_t i_count = __MIN( i_sample_count, i_index_samples_left );
+            i_next_dts += (int64_t) i_count * (uint32_t) stts->pi_sample_delta[i_index];
+            i_sample_count -= i_count;
+            i_index_samples_left -= i_count;
         }
+
+        ck->i_duration = i_next_dts - ck->i_first_dts;
     }
 
+    if( b_truncated )
+        msg_Err( p_demux, "invalid STTS table: not enough samples" );
 
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
@@ -2736,91 +2751,13 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        int64_t i_cts_shift = 0;
+        p_demux_track->i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
         if( p_cslg && BOXDATA(p_cslg) )
-            i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
-
-        /* Create pts-dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
-
-        for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
-        {
-            mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            p_demux_track->i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-
-            }
-        }
+        MP4_SampleRuns_Init( &p_demux_track->ctts, ctts->pi_sample_count,
+                             ctts->pi_sample_offset, ctts->i_entry_count, false );
     }
 
     msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRId64"s",
@@ -3065,6 +3002,21 @@ static int TrackGetNearestSeekPoint( demux_t *p_demux, mp4_track_t *p_track,
     return i_ret;
 }
 
+/* returns the chunk holding i_sample */
+static uint32_t TrackSampleToChunk( const mp4_track_t *p_track, uint64_t i_sample )
+{
+    uint32_t i_low = 0, i_high = p_track->i_chunk_count - 1;
+    while( i_low < i_high )
+    {
+        const uint32_t i_mid = i_low + ( i_high - i_low + 1 ) / 2;
+        if( p_track->chunk[i_mid].i_sample_first <= i_sample )
+            i_low = i_mid;
+        else
+            i_high = i_mid - 1;
+    }
+    return i_low;
+}
+
 /* given a time it return sample/chunk
  * it also update elst field of the track
  */
@@ -3073,10 +3025,8 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
                                    uint32_t *pi_sample )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    uint64_t     i_dts;
-    unsigned int i_sample;
-    unsigned int i_chunk;
-    int          i_index;
+    uint64_t     i_sample;
+    uint32_t     i_chunk;
 
     /* FIXME see if it's needed to check p_track->i_chunk_count */
     if( p_track->i_chunk_count == 0 )
@@ -3119,60 +3069,16 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale( i_start, CLOCK_FREQ, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
-    /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
-    {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
-    }
-
-    /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
-    for( i_index = 0; i_sample < p_track->chunk[i_chunk].i_sample_count; )
-    {
-        if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
-        {
-            i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
-
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
-                break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
-            break;
-        }
-    }
-
+    /* *** find sample, then its chunk *** */
+    i_sample = MP4_SampleRuns_GetSample( &p_track->stts, i_start );
     if( i_sample >= p_track->i_sample_count )
     {
         msg_Warn( p_demux, "track[Id 0x%x] will be disabled "
-                  "(seeking too far) chunk=%d sample=%d",
-                  p_track->i_track_ID, i_chunk, i_sample );
+                  "(seeking too far) sample=%"PRIu64,
+                  p_track->i_track_ID, i_sample );
         return( VLC_EGENERIC );
     }
+    i_chunk = TrackSampleToChunk( p_track, i_sample );
 
 
     /* *** Try to find nearest sync points *** */
@@ -3181,19 +3087,7 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         TrackGetNearestSeekPoint( p_demux, p_track, i_sample, &i_sync_sample ) )
     {
         /* Go to chunk */
-        if( i_sync_sample <= i_sample )
-        {
-            while( i_chunk > 0 &&
-                   i_sync_sample < p_track->chunk[i_chunk].i_sample_first )
-                i_chunk--;
-        }
-        else
-        {
-            while( i_chunk < p_track->i_chunk_count - 1 &&
-                   i_sync_sample >= p_track->chunk[i_chunk].i_sample_first +
-                                    p_track->chunk[i_chunk].i_sample_count )
-                i_chunk++;
-        }
+        i_chunk = TrackSampleToChunk( p_track, i_sync_sample );
         i_sample = i_sync_sample;
     }
 
@@ -3596,15 +3490,6 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     p_track->b_ok = true;
 }
 
-static void DestroyChunk( mp4_chunk_t *ck )
-{
-    free( ck->p_sample_count_dts );
-    free( ck->p_sample_delta_dts );
-    free( ck->p_sample_count_pts );
-    free( ck->p_sample_offset_pts );
-    free( ck->p_sample_size );
-}
-
 /****************************************************************************
  * MP4_TrackClean:
  ****************************************************************************
@@ -3617,19 +3502,16 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            DestroyChunk( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
+    MP4_SampleRuns_Clean( &p_track->stts );
+    MP4_SampleRuns_Clean( &p_track->ctts );
 
     if ( p_track->asfinfo.p_frame )
         block_ChainRelease( p_track->asfinfo.p_frame );
 
+    MP4_SpanRelease( p_track->p_span );
+
     free( p_track->context.runs.p_array );
 }
 
@@ -3654,6 +3536,12 @@ static void MP4_TrackSelect( demux_t *p_demux, mp4_track_t *p_track, bool b_sele
                         p_track->p_es, false );
     }
 
+    if( !b_select )
+    {
+        MP4_SpanRelease( p_track->p_span );
+        p_track->p_span = NULL;
+    }
+
     p_track->b_selected = b_select;
 }
 
@@ -3888,16 +3776,16 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
     return i_size;
 }
 
-static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
+static uint64_t MP4_TrackGetSamplePos( const mp4_track_t *p_track,
+                                       uint32_t i_chunk, uint32_t i_sample )
 {
-    unsigned int i_sample;
     uint64_t i_pos;
 
-    i_pos = p_track->chunk[p_track->i_chunk].i_offset;
+    i_pos = p_track->chunk[i_chunk].i_offset;
 
     if( p_track->i_sample_size )
     {
-        MP4_Box_data_sample_soun_t *p_soun =
+        const MP4_Box_data_sample_soun_t *p_soun =
             p_track->p_sample->data.p_sample_soun;
 
         /* Quicktime builtin support, _must_ ignore sample tables */
@@ -3907,8 +3795,8 @@ static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
             switch( p_track->fmt.i_codec )
             {
             case VLC_CODEC_GSM: /* # Samples > data size */
-                i_pos += ( p_track->i_sample -
-                           p_track->chunk[p_track->i_chunk].i_sample_first ) / 160 * 33;
+                i_pos += ( i_sample -
+                           p_track->chunk[i_chunk].i_sample_first ) / 160 * 33;
                 return i_pos;
             default:
                 break;
@@ -3919,29 +3807,34 @@ static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
             p_track->fmt.audio.i_blockalign <= 1 ||
             p_soun->i_sample_per_packet * p_soun->i_bytes_per_frame == 0 )
         {
-            i_pos += ( p_track->i_sample -
-                       p_track->chunk[p_track->i_chunk].i_sample_first ) *
+            i_pos += ( i_sample -
+                       p_track->chunk[i_chunk].i_sample_first ) *
                      MP4_GetFixedSampleSize( p_track, p_soun );
         }
         else
         {
             /* we read chunk by chunk unless a blockalign is requested */
-            i_pos += ( p_track->i_sample - p_track->chunk[p_track->i_chunk].i_sample_first ) /
+            i_pos += ( i_sample - p_track->chunk[i_chunk].i_sample_first ) /
                         p_soun->i_sample_per_packet * p_soun->i_bytes_per_frame;
         }
     }
     else
     {
-        for( i_sample = p_track->chunk[p_track->i_chunk].i_sample_first;
-             i_sample < p_track->i_sample; i_sample++ )
+        for( uint32_t i = p_track->chunk[i_chunk].i_sample_first;
+             i < i_sample; i++ )
         {
-            i_pos += p_track->p_sample_size[i_sample];
+            i_pos += p_track->p_sample_size[i];
         }
     }
 
     return i_pos;
 }
 
+static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
+{
+    return MP4_TrackGetSamplePos( p_track, p_track->i_chunk, p_track->i_sample );
+}
+
 static int MP4_TrackNextSample( demux_t *p_demux, mp4_track_t *p_track, uint32_t i_samples )
 {
     if ( UINT32_MAX - p_track->i_sample < i_samples )
@@ -4080,7 +3973,7 @@ static stime_t GetCumulatedDuration( demux_t *p_demux )
             i_max_duration = __MAX( (uint64_t)i_max_duration, BOXDATA(p_tkhd)->i_duration );
         }
 
-        if( p_sys->p_fragsindex )
+        if( p_sys->p_fragsindex && p_sys->p_fragsindex->b_complete )
         {
             i_track_duration += MP4_Fragment_Index_GetTrackDuration( p_sys->p_fragsindex, i );
         }
@@ -4231,6 +4124,62 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return true;
 }
 
+/* Time of the first sync sample of a traf, from its start, track scaled */
+static bool FragGetTrafSyncOffset( MP4_Box_t *p_moov, const MP4_Box_t *p_traf,
+                                   stime_t *pi_offset )
+{
+    const MP4_Box_t *p_tfhd = MP4_BoxGet( p_traf, "tfhd" );
+    if( !p_tfhd || !BOXDATA(p_tfhd) )
+        return false;
+
+    uint32_t i_default_size = 0;
+    uint32_t i_default_duration = 0;
+    uint32_t i_default_flags = 0;
+    MP4_GetDefaultSizeAndDuration( p_moov, BOXDATA(p_tfhd),
+                                   &i_default_size, &i_default_duration );
+    if( BOXDATA(p_tfhd)->i_flags & MP4_TFHD_DFLT_SAMPLE_FLAGS )
+    {
+        i_default_flags = BOXDATA(p_tfhd)->i_default_sample_flags;
+    }
+    else
+    {
+        const MP4_Box_t *p_trex = MP4_GetTrexByTrackID( p_moov, BOXDATA(p_tfhd)->i_track_ID );
+        if( p_trex && BOXDATA(p_trex) )
+            i_default_flags = BOXDATA(p_trex)->i_default_sample_flags;
+    }
+
+    stime_t i_offset = 0;
+    for( const MP4_Box_t *p_trun = MP4_BoxGet( p_traf, "trun" );
+                          p_trun; p_trun = p_trun->p_next )
+    {
+        if ( p_trun->i_type != ATOM_trun || !BOXDATA(p_trun) )
+            continue;
+
+        const MP4_Box_data_trun_t *p_trundata = p_trun->data.p_trun;
+        for( uint32_t i=0; i<p_trundata->i_sample_count; i++ )
+        {
+            uint32_t i_flags = i_default_flags;
+            if( i == 0 && (p_trundata->i_flags & MP4_TRUN_FIRST_FLAGS) )
+                i_flags = p_trundata->i_first_sample_flags;
+            else if( p_trundata->i_flags & MP4_TRUN_SAMPLE_FLAGS )
+                i_flags = p_trundata->p_samples[i].i_flags;
+
+            if( !(i_flags & MP4_SAMPLE_IS_NON_SYNC) )
+            {
+                *pi_offset = i_offset;
+                return true;
+            }
+
+            if( p_trundata->i_flags & MP4_TRUN_SAMPLE_DURATION )
+                i_offset += p_trundata->p_samples[i].i_duration;
+            else
+                i_offset += i_default_duration;
+        }
+    }
+
+    return false;
+}
+
 static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -4252,7 +4201,9 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
         if( i_moof )
         {
             *pb_fragmented = true;
-            p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
+            /* Completes the fragments already indexed while playing */
+            if( !p_sys->p_fragsindex )
+                p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
             if( !p_sys->p_fragsindex )
             {
                 MP4_BoxFree( p_vroot );
@@ -4260,15 +4211,17 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
             }
 
             stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
-            if( !pi_track_times )
+            mp4_fragment_time_t *p_times = vlc_alloc( p_sys->i_tracks, sizeof(*p_times) );
+            if( !pi_track_times || !p_times )
             {
-                MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
-                p_sys->p_fragsindex = NULL;
+                free( pi_track_times );
+                free( p_times );
                 MP4_BoxFree( p_vroot );
                 return VLC_EGENERIC;
             }
 
             unsigned index = 0;
+            bool b_complete = true;
 
             for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
             {
@@ -4293,24 +4246,31 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                     }
 
                     stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
+                    p_times[i].i_start = i_movietime;
+
+                    stime_t i_sync;
+                    if( p_traf && FragGetTrafSyncOffset( p_sys->p_moov, p_traf, &i_sync ) )
+                        p_times[i].i_sync = MP4_rescale( pi_track_times[i] + i_sync,
+                                                         p_sys->track[i].i_timescale, p_sys->i_timescale );
+                    else
+                        p_times[i].i_sync = MP4_FRAGMENTS_NO_TIME;
 
                     stime_t i_duration = 0;
                     if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
                         pi_track_times[i] += i_duration;
+
+                    p_times[i].i_end = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
                 }
 
-                p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
-            }
-
-            for( unsigned i=0; i<p_sys->i_tracks; i++ )
-            {
-                stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
+                if( !MP4_Fragments_Index_Add( p_sys->p_fragsindex, p_moof->i_pos, p_times ) )
+                    b_complete = false;
+                index++;
             }
+            /* An index with gaps can't be trusted for seeking nor duration */
+            p_sys->p_fragsindex->b_complete = b_complete;
 
             free( pi_track_times );
+            free( p_times );
 #ifdef MP4_VERBOSE
             MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
 #endif
@@ -4570,6 +4530,14 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
     uint32_t i_traf = 0;
     uint64_t i_prev_traf_end = 0;
 
+    /* Tracks times of this fragment, for seeking back to it */
+    bool b_indexed = false;
+    mp4_fragment_time_t *p_times = NULL;
+    if( p_sys->b_seekable )
+        p_times = vlc_alloc( p_sys->i_tracks, sizeof(*p_times) );
+    for( unsigned i=0; p_times && i<p_sys->i_tracks; i++ )
+        p_times[i].i_start = p_times[i].i_end = p_times[i].i_sync = MP4_FRAGMENTS_NO_TIME;
+
     for( unsigned i=0; i<p_sys->i_tracks; i++ )
     {
         mp4_track_t *p_track = &p_sys->track[i];
@@ -4639,14 +4607,14 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
                 }
             }
 
-            /* After seek we should have probed fragments */
-            if( !b_has_base_media_decode_time && p_sys->p_fragsindex )
+            /* After seek we should have probed or already parsed that fragment */
+            stime_t i_indexed_time;
+            if( !b_has_base_media_decode_time && p_sys->p_fragsindex &&
+                MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex,
+                                                      p_track - p_sys->track,
+                                                      p_moof->i_pos, &i_indexed_time ) )
             {
-                unsigned i_track_index = (p_track - p_sys->track);
-                assert(&p_sys->track[i_track_index] == p_track);
-                i_traf_start_time = MP4_Fragment_Index_GetTrackStartTime( p_sys->p_fragsindex,
-                                                                          i_track_index, p_moof->i_pos );
-                i_traf_start_time = MP4_rescale( i_traf_start_time,
+                i_traf_start_time = MP4_rescale( i_indexed_time,
                                                  p_sys->i_timescale, p_track->i_timescale );
                 b_has_base_media_decode_time = true;
             }
@@ -4674,11 +4642,16 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
 
             /* Use global sidx moof time, in case moof does not carry tfdt */
             if( !b_has_base_media_decode_time && i_moof_time != INVALID_SEGMENT_TIME )
+            {
                 i_traf_start_time = MP4_rescale( i_moof_time, p_sys->i_timescale, p_track->i_timescale );
+                b_has_base_media_decode_time = true;
+            }
 
             /* That should not happen */
             if( !b_has_base_media_decode_time )
                 i_traf_start_time = MP4_rescale( p_sys->i_nztime, CLOCK_FREQ, p_track->i_timescale );
+
+            p_track->context.b_unknown_time_offset = !b_has_base_media_decode_time;
         }
 
         /* Parse TRUN data */
@@ -4785,9 +4758,30 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
             i_prev_traf_end = i_trun_data_offset + i_trun_size;
         }
 
+        if( p_times && !p_track->context.b_unknown_time_offset )
+        {
+            mp4_fragment_time_t *p_time = &p_times[p_track - p_sys->track];
+            stime_t i_sync;
+            p_time->i_start = MP4_rescale( i_traf_start_time, p_track->i_timescale, p_sys->i_timescale );
+            p_time->i_end = MP4_rescale( i_trun_dts, p_track->i_timescale, p_sys->i_timescale );
+            if( FragGetTrafSyncOffset( p_sys->p_moov, p_traf, &i_sync ) )
+                p_time->i_sync = MP4_rescale( i_traf_start_time + i_sync,
+                                              p_track->i_timescale, p_sys->i_timescale );
+            b_indexed = true;
+        }
+
         i_traf++;
     }
 
+    if( b_indexed )
+    {
+        if( !p_sys->p_fragsindex )
+            p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, 64 );
+        if( p_sys->p_fragsindex )
+            MP4_Fragments_Index_Add( p_sys->p_fragsindex, p_moof->i_pos, p_times );
+    }
+    free( p_times );
+
     return VLC_SUCCESS;
 }
 
@@ -4871,6 +4865,23 @@ static int FragGetMoofByTfraIndex( demux_t *p_demux, const vlc_tick_t i_target_t
     return VLC_EGENERIC;
 }
 
+static int FragGetMoofByFragmentsIndex( demux_t *p_demux, vlc_tick_t i_target_time,
+                                        unsigned i_track_index, uint64_t *pi_moof_pos,
+                                        vlc_tick_t *pi_sampletime, bool *pb_sync )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    if( !p_sys->p_fragsindex )
+        return VLC_EGENERIC;
+
+    stime_t i_time = MP4_rescale( i_target_time, CLOCK_FREQ, p_sys->i_timescale );
+    if( !MP4_Fragments_Index_Lookup( p_sys->p_fragsindex, &i_time, pi_moof_pos,
+                                     i_track_index, pb_sync ) )
+        return VLC_EGENERIC;
+
+    *pi_sampletime = MP4_rescale( i_time, p_sys->i_timescale, CLOCK_FREQ );
+    return VLC_SUCCESS;
+}
+
 static void MP4_GetDefaultSizeAndDuration( MP4_Box_t *p_moov,
                                            const MP4_Box_data_tfhd_t *p_tfhd_data,
                                            uint32_t *pi_default_size,
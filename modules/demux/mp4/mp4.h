@@ -28,6 +28,7 @@
 #include <vlc_common.h>
 #include "libmp4.h"
 #include "fragments.h"
+#include "samples.h"
 #include "../asf/asfpacket.h"
 
 /* Contain all information about a chunk */
@@ -40,25 +41,10 @@ typedef struct
     uint32_t     i_sample; /* index of the next sample to read in this chunk */
     uint32_t     i_virtual_run_number; /* chunks interleaving sequence */
 
-    /* now provide way to calculate pts, dts, and offset without too
-        much memory and with fast access */
-
-    /* with this we can calculate dts/pts without waste memory */
+    /* samples dts/pts are looked up in the track sample runs */
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    int32_t      *p_sample_offset_pts;  /* pts-dts */
-
-    uint32_t     *p_sample_size;
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
-
 } mp4_chunk_t;
 
 typedef struct
@@ -68,6 +54,9 @@ typedef struct
     const MP4_Box_t *p_trun;
 } mp4_run_t;
 
+/* Coalesced read of upcoming samples, shared by the tracks it covers */
+typedef struct mp4_span_t mp4_span_t;
+
 typedef enum RTP_timstamp_synchronization_s
 {
     UNKNOWN_SYNC = 0, UNSYNCHRONIZED = 1, SYNCHRONIZED = 2, RESERVED = 3
@@ -120,14 +109,20 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* stsz table, not copied */
+
+    /* sample -> dts (stts) and pts-dts (ctts) */
+    mp4_sampleruns_t stts;
+    mp4_sampleruns_t ctts;
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
     uint64_t     i_first_dts;    /* i_first_dts value
                                                    of the next chunk */
 
+    mp4_span_t      *p_span; /* last read span, for the next samples */
+
     const MP4_Box_t *p_track;
     const MP4_Box_t *p_stbl;  /* will contain all timing information */
     const MP4_Box_t *p_stsd;  /* will contain all data to initialize decoder */
@@ -151,6 +146,7 @@ typedef struct
     {
         /* for moof parsing */
         bool b_resync_time_offset;
+        bool b_unknown_time_offset; /* guessed, not indexed */
 
         /* tfhd defaults */
         uint32_t i_default_sample_size;
@@ -0,0 +1,207 @@
+/*****************************************************************************
+ * samples.c : MP4 sample tables
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "samples.h"
+
+void MP4_SampleRuns_Init( mp4_sampleruns_t *p_runs, const uint32_t *pi_count,
+                          const int32_t *pi_value, uint32_t i_entries, bool b_time )
+{
+    p_runs->pi_count = pi_count;
+    p_runs->pi_value = pi_value;
+    p_runs->i_entries = ( pi_count && pi_value ) ? i_entries : 0;
+    p_runs->b_time = b_time;
+    p_runs->p_pages = NULL;
+    p_runs->i_pages = 0;
+    p_runs->cursor.i_entry = 0;
+    p_runs->cursor.i_first = 0;
+    p_runs->cursor.i_time = 0;
+}
+
+void MP4_SampleRuns_Clean( mp4_sampleruns_t *p_runs )
+{
+    free( p_runs->p_pages );
+    p_runs->p_pages = NULL;
+    p_runs->i_pages = 0;
+}
+
+static inline stime_t MP4_SampleRuns_Duration( const mp4_sampleruns_t *p_runs,
+                                               uint32_t i_entry )
+{
+    /* stts deltas are unsigned */
+    return p_runs->b_time ? (stime_t) p_runs->pi_count[i_entry] *
+                            (uint32_t) p_runs->pi_value[i_entry] : 0;
+}
+
+static bool MP4_SampleRuns_DecodePage( mp4_sampleruns_t *p_runs )
+{
+    const uint32_t i_total = ( p_runs->i_entries + MP4_SAMPLERUNS_PAGE - 1 ) /
+                             MP4_SAMPLERUNS_PAGE;
+
+    if( p_runs->p_pages == NULL )
+    {
+        if( i_total == 0 )
+            return false;
+        p_runs->p_pages = vlc_alloc( i_total, sizeof(*p_runs->p_pages) );
+        if( !p_runs->p_pages )
+            return false;
+        p_runs->p_pages[0].i_sample = 0;
+        p_runs->p_pages[0].i_time = 0;
+        p_runs->i_pages = 1;
+        return true;
+    }
+
+    if( p_runs->i_pages >= i_total )
+        return false;
+
+    mp4_sampleruns_page_t *p_page = &p_runs->p_pages[p_runs->i_pages];
+    *p_page = p_page[-1];
+    const uint32_t i_first = ( p_runs->i_pages - 1 ) * MP4_SAMPLERUNS_PAGE;
+    for( uint32_t i = i_first; i < i_first + MP4_SAMPLERUNS_PAGE; i++ )
+    {
+        p_page->i_sample += p_runs->pi_count[i];
+        p_page->i_time += MP4_SampleRuns_Duration( p_runs, i );
+    }
+    p_runs->i_pages++;
+
+    return true;
+}
+
+bool MP4_SampleRuns_Find( mp4_sampleruns_t *p_runs, uint64_t i_sample,
+                          uint32_t *pi_entry, uint64_t *pi_first, stime_t *pi_time )
+{
+    uint32_t i_entry = 0;
+    uint64_t i_first = 0;
+    stime_t  i_time = 0;
+
+    /* Without pages (no memory), falls back to walking from the start */
+    if( p_runs->p_pages || MP4_SampleRuns_DecodePage( p_runs ) )
+    {
+        while( p_runs->p_pages[p_runs->i_pages - 1].i_sample <= i_sample &&
+               MP4_SampleRuns_DecodePage( p_runs ) );
+
+        /* Last page starting at or before the sample */
+        uint32_t i_low = 0, i_high = p_runs->i_pages - 1;
+        while( i_low < i_high )
+        {
+            const uint32_t i_mid = i_low + ( i_high - i_low + 1 ) / 2;
+            if( p_runs->p_pages[i_mid].i_sample <= i_sample )
+                i_low = i_mid;
+            else
+                i_high = i_mid - 1;
+        }
+
+        i_entry = i_low * MP4_SAMPLERUNS_PAGE;
+        i_first = p_runs->p_pages[i_low].i_sample;
+        i_time = p_runs->p_pages[i_low].i_time;
+    }
+
+    /* Continue from the previous lookup within the same page */
+    if( p_runs->cursor.i_entry / MP4_SAMPLERUNS_PAGE == i_entry / MP4_SAMPLERUNS_PAGE &&
+        p_runs->cursor.i_first <= i_sample && p_runs->cursor.i_entry > i_entry )
+    {
+        i_entry = p_runs->cursor.i_entry;
+        i_first = p_runs->cursor.i_first;
+        i_time = p_runs->cursor.i_time;
+    }
+
+    bool b_found = false;
+    for( ; i_entry < p_runs->i_entries; i_entry++ )
+    {
+        if( i_sample - i_first < p_runs->pi_count[i_entry] )
+        {
+            b_found = true;
+            break;
+        }
+        i_first += p_runs->pi_count[i_entry];
+        i_time += MP4_SampleRuns_Duration( p_runs, i_entry );
+    }
+
+    if( b_found )
+    {
+        p_runs->cursor.i_entry = i_entry;
+        p_runs->cursor.i_first = i_first;
+        p_runs->cursor.i_time = i_time;
+    }
+
+    if( pi_entry )
+        *pi_entry = i_entry;
+    if( pi_first )
+        *pi_first = i_first;
+    if( pi_time )
+        *pi_time = i_time;
+    return b_found;
+}
+
+stime_t MP4_SampleRuns_GetTime( mp4_sampleruns_t *p_runs, uint64_t i_sample )
+{
+    uint32_t i_entry;
+    uint64_t i_first;
+    stime_t i_time;
+
+    if( MP4_SampleRuns_Find( p_runs, i_sample, &i_entry, &i_first, &i_time ) )
+        i_time += (stime_t) ( i_sample - i_first ) * (uint32_t) p_runs->pi_value[i_entry];
+
+    return i_time;
+}
+
+uint64_t MP4_SampleRuns_GetSample( mp4_sampleruns_t *p_runs, stime_t i_time )
+{
+    uint32_t i_entry = 0;
+    uint64_t i_first = 0;
+    stime_t  i_entry_time = 0;
+
+    if( i_time < 0 )
+        i_time = 0;
+
+    if( p_runs->p_pages || MP4_SampleRuns_DecodePage( p_runs ) )
+    {
+        while( p_runs->p_pages[p_runs->i_pages - 1].i_time <= i_time &&
+               MP4_SampleRuns_DecodePage( p_runs ) );
+
+        /* Last page starting at or before that time */
+        uint32_t i_low = 0, i_high = p_runs->i_pages - 1;
+        while( i_low < i_high )
+        {
+            const uint32_t i_mid = i_low + ( i_high - i_low + 1 ) / 2;
+            if( p_runs->p_pages[i_mid].i_time <= i_time )
+                i_low = i_mid;
+            else
+                i_high = i_mid - 1;
+        }
+
+        i_entry = i_low * MP4_SAMPLERUNS_PAGE;
+        i_first = p_runs->p_pages[i_low].i_sample;
+        i_entry_time = p_runs->p_pages[i_low].i_time;
+    }
+
+    for( ; i_entry < p_runs->i_entries; i_entry++ )
+    {
+        const stime_t i_duration = MP4_SampleRuns_Duration( p_runs, i_entry );
+        if( i_time < i_entry_time + i_duration )
+            return i_first + ( i_time - i_entry_time ) / (uint32_t) p_runs->pi_value[i_entry];
+        i_first += p_runs->pi_count[i_entry];
+        i_entry_time += i_duration;
+    }
+
+    return i_first;
+}
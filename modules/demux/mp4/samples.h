@@ -0,0 +1,68 @@
+/*****************************************************************************
+ * samples.h : MP4 sample tables
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_MP4_SAMPLES_H_
+#define VLC_MP4_SAMPLES_H_
+
+#include <vlc_common.h>
+#include "libmp4.h"
+
+/* Entries per page of the run-length tables */
+#define MP4_SAMPLERUNS_PAGE 64
+
+typedef struct
+{
+    uint64_t i_sample; /* first sample of the page */
+    stime_t  i_time;   /* decoding time of that sample, stts only */
+} mp4_sampleruns_page_t;
+
+/* Run-length sample table (stts, ctts) read in place from the box.
+ * Pages are decoded on first access, and lookups are O(log n). */
+typedef struct
+{
+    const uint32_t *pi_count; /* samples per entry */
+    const int32_t  *pi_value; /* sample delta or composition offset */
+    uint32_t        i_entries;
+    bool            b_time;   /* values are durations, and get summed */
+
+    mp4_sampleruns_page_t *p_pages;
+    uint32_t        i_pages;  /* decoded so far */
+
+    struct /* last entry found, for sequential reads */
+    {
+        uint32_t i_entry;
+        uint64_t i_first;
+        stime_t  i_time;
+    } cursor;
+} mp4_sampleruns_t;
+
+void MP4_SampleRuns_Init( mp4_sampleruns_t *p_runs, const uint32_t *pi_count,
+                          const int32_t *pi_value, uint32_t i_entries, bool b_time );
+void MP4_SampleRuns_Clean( mp4_sampleruns_t *p_runs );
+
+/* Finds the entry holding i_sample, with its first sample and time.
+ * Past the table, returns false with the end sample and time. */
+bool MP4_SampleRuns_Find( mp4_sampleruns_t *p_runs, uint64_t i_sample,
+                          uint32_t *pi_entry, uint64_t *pi_first, stime_t *pi_time );
+
+/* stts only */
+stime_t  MP4_SampleRuns_GetTime( mp4_sampleruns_t *p_runs, uint64_t i_sample );
+uint64_t MP4_SampleRuns_GetSample( mp4_sampleruns_t *p_runs, stime_t i_time );
+
+#endif
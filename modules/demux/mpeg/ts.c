@@ -30,6 +30,8 @@
 # include "config.h"
 #endif
 
+#include <stdatomic.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>    /* DVB-specific things */
@@ -51,6 +53,7 @@
 #include "timestamps.h"
 
 #include "ts.h"
+#include "ts_sync.h"
 
 #include "../../codec/scte18.h"
 #include "../opus.h"
@@ -115,6 +118,12 @@ static void Close ( vlc_object_t * );
 #define CC_CHECK_LONGTEXT   "Detect discontinuities and drop packet duplicates. " \
                             "(bluRay sources are known broken and have false positives). "
 
+#define SEEK_INDEX_TEXT N_("Cache seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Store the time to position index built during playback in the cache " \
+    "directory, so that seeking and duration probing of a file opened again " \
+    "need a single read." )
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -153,6 +162,7 @@ vlc_module_begin ()
     add_bool( "ts-split-es", true, SPLIT_ES_TEXT, SPLIT_ES_LONGTEXT, false )
     add_bool( "ts-seek-percent", false, SEEK_PERCENT_TEXT, SEEK_PERCENT_LONGTEXT, true )
     add_bool( "ts-cc-check", true, CC_CHECK_TEXT, CC_CHECK_LONGTEXT, true )
+    add_bool( "ts-seek-index-cache", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT, true )
 
     add_obsolete_bool( "ts-silent" );
 
@@ -183,9 +193,13 @@ static stime_t GetPCR( const block_t * );
 static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, int * );
 static bool GatherPESData( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk, size_t );
 static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
-static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
+static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr, bool b_index );
+static void ProgramIndexPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static void ReleasePendingPackets( demux_sys_t * );
+static uint64_t TsStreamTell( demux_sys_t * );
+static int TsStreamSeek( demux_sys_t *, uint64_t );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
@@ -197,52 +211,31 @@ static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
 #define TS_PACKET_SIZE_MAX 204
 #define TS_HEADER_SIZE 4
 
+/* Number of packets read at once into a single buffer */
+#define TS_BULK_PACKETS 64
+/* A bulk peek taking longer than this had to wait for the input */
+#define TS_BULK_WAIT VLC_TICK_FROM_MS(1)
+
 #define PROBE_CHUNK_COUNT 500
 #define PROBE_MAX         (PROBE_CHUNK_COUNT * 10)
 
 static int DetectPacketSize( demux_t *p_demux, unsigned *pi_header_size, int i_offset )
 {
     const uint8_t *p_peek;
+    size_t i_sync;
 
-    if( vlc_stream_Peek( p_demux->s,
-                     &p_peek, i_offset + TS_PACKET_SIZE_MAX ) < i_offset + TS_PACKET_SIZE_MAX )
+    /* Look for 4 sync bytes in a row, starting within the first packet */
+    ssize_t i_peek = vlc_stream_Peek( p_demux->s, &p_peek,
+                                      i_offset + TS_PACKET_SIZE_MAX * 4 );
+    if( i_peek < i_offset + TS_PACKET_SIZE_MAX )
         return -1;
 
-    for( int i_sync = 0; i_sync < TS_PACKET_SIZE_MAX; i_sync++ )
-    {
-        if( p_peek[i_offset + i_sync] != 0x47 )
-            continue;
-
-        /* Check next 3 sync bytes */
-        int i_peek = i_offset + TS_PACKET_SIZE_MAX * 3 + i_sync + 1;
-        if( ( vlc_stream_Peek( p_demux->s, &p_peek, i_peek ) ) < i_peek )
-        {
-            msg_Dbg( p_demux, "cannot peek" );
-            return -1;
-        }
-        if( p_peek[i_offset + i_sync + 1 * TS_PACKET_SIZE_188] == 0x47 &&
-            p_peek[i_offset + i_sync + 2 * TS_PACKET_SIZE_188] == 0x47 &&
-            p_peek[i_offset + i_sync + 3 * TS_PACKET_SIZE_188] == 0x47 )
-        {
-            return TS_PACKET_SIZE_188;
-        }
-        else if( p_peek[i_offset + i_sync + 1 * TS_PACKET_SIZE_192] == 0x47 &&
-                 p_peek[i_offset + i_sync + 2 * TS_PACKET_SIZE_192] == 0x47 &&
-                 p_peek[i_offset + i_sync + 3 * TS_PACKET_SIZE_192] == 0x47 )
-        {
-            if( i_sync == 4 )
-            {
-                *pi_header_size = 4; /* BluRay TS packets have 4-byte header */
-            }
-            return TS_PACKET_SIZE_192;
-        }
-        else if( p_peek[i_offset + i_sync + 1 * TS_PACKET_SIZE_204] == 0x47 &&
-                 p_peek[i_offset + i_sync + 2 * TS_PACKET_SIZE_204] == 0x47 &&
-                 p_peek[i_offset + i_sync + 3 * TS_PACKET_SIZE_204] == 0x47 )
-        {
-            return TS_PACKET_SIZE_204;
-        }
-    }
+    unsigned i_size = ts_sync_DetectPacketSize( &p_peek[i_offset],
+                                                i_peek - i_offset, 3, &i_sync );
+    if( i_size == TS_PACKET_SIZE_192 && i_sync == 4 )
+        *pi_header_size = 4; /* BluRay TS packets have 4-byte header */
+    if( i_size != 0 )
+        return i_size;
 
     if( p_demux->obj.force )
     {
@@ -394,6 +387,11 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
+    p_sys->pending.p_first = NULL;
+    p_sys->pending.pp_last = &p_sys->pending.p_first;
+    p_sys->pending.i_count = 0;
+    p_sys->pending.i_bulk = 2;
+    p_sys->pending.i_single = 0;
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
@@ -518,6 +516,15 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_SEEK, &p_sys->b_canseek );
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
+    if( p_sys->b_canfastseek )
+        p_sys->pending.i_bulk = TS_BULK_PACKETS;
+
+    ts_seekindexes_Init( &p_sys->seekindex, stream_Size( p_sys->stream ) );
+    p_sys->b_seekindex_cache = p_sys->b_canseek &&
+                               p_sys->seekindex.i_stream_size > 0 &&
+                               var_InheritBool( p_demux, "ts-seek-index-cache" );
+    if( p_sys->b_seekindex_cache )
+        ts_seekindexes_Load( p_this, &p_sys->seekindex, p_demux->psz_url );
 
     /* Preparse time */
     if( p_sys->b_canseek )
@@ -548,6 +555,13 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    ReleasePendingPackets( p_sys );
+
+    if( p_sys->b_seekindex_cache && p_sys->seekindex.b_dirty &&
+        (uint64_t) stream_Size( p_sys->stream ) == p_sys->seekindex.i_stream_size )
+        ts_seekindexes_Save( p_this, &p_sys->seekindex, p_demux->psz_url );
+    ts_seekindexes_Clean( &p_sys->seekindex );
+
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -943,7 +957,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TsStreamTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -990,7 +1004,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         i64 = stream_Size( p_sys->stream );
         if( i64 > 0 &&
-            vlc_stream_Seek( p_sys->stream, (int64_t)(i64 * f) ) == VLC_SUCCESS )
+            TsStreamSeek( p_sys, (int64_t)(i64 * f) ) == VLC_SUCCESS )
         {
             ReadyQueuesPostSeek( p_demux );
             return VLC_SUCCESS;
@@ -1124,9 +1138,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        ReleasePendingPackets( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        ReleasePendingPackets( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_SEEKPOINT,
                                      args );
 
@@ -1609,7 +1625,7 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
                 if ( p_pmt->pcr.b_disable && p_block->i_dts != VLC_TICK_INVALID &&
                      ( p_pmt->i_pid_pcr == pid->i_pid || p_pmt->i_pid_pcr == 0x1FFF ) )
                 {
-                    ProgramSetPCR( p_demux, p_pmt, TO_SCALE(p_block->i_dts) - 120000 );
+                    ProgramSetPCR( p_demux, p_pmt, TO_SCALE(p_block->i_dts) - 120000, false );
                 }
 
                 /* Compute PCR/DTS offset if any */
@@ -1718,12 +1734,158 @@ static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool
     return b_ret;
 }
 
+/*
+ * Bulk packet reading: packets are read many at a time into a single
+ * buffer, and handed out as blocks pointing into that buffer. The buffer is
+ * freed when the last of its packets is released.
+ */
+typedef struct ts_bulk_t ts_bulk_t;
+
+typedef struct
+{
+    block_t    self;
+    ts_bulk_t *p_bulk;
+} ts_bulk_packet_t;
+
+struct ts_bulk_t
+{
+    atomic_uint      refs;
+    ts_bulk_packet_t packets[TS_BULK_PACKETS];
+};
+
+static void BulkPacketRelease( block_t *p_pkt )
+{
+    ts_bulk_t *p_bulk = container_of( p_pkt, ts_bulk_packet_t, self )->p_bulk;
+
+    if( atomic_fetch_sub_explicit( &p_bulk->refs, 1,
+                                   memory_order_acq_rel ) == 1 )
+        free( p_bulk );
+}
+
+static const struct vlc_block_callbacks ts_bulk_cbs =
+{
+    BulkPacketRelease,
+};
+
+static void ReleasePendingPackets( demux_sys_t *p_sys )
+{
+    block_ChainRelease( p_sys->pending.p_first );
+    p_sys->pending.p_first = NULL;
+    p_sys->pending.pp_last = &p_sys->pending.p_first;
+    p_sys->pending.i_count = 0;
+}
+
+/* Stream position of the next packet to demux */
+static uint64_t TsStreamTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream ) -
+           (uint64_t) p_sys->pending.i_count * p_sys->i_packet_size;
+}
+
+static int TsStreamSeek( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    int i_ret = vlc_stream_Seek( p_sys->stream, i_pos );
+    if( i_ret == VLC_SUCCESS )
+        ReleasePendingPackets( p_sys );
+    return i_ret;
+}
+
+static bool ReadTSPacketsBulk( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_size = p_sys->i_packet_size;
+    const uint8_t *p_peek;
+    unsigned i_count = 0;
+
+    if( p_sys->pending.i_single > 0 )
+    {
+        p_sys->pending.i_single--;
+        return false;
+    }
+
+    /* Peeking blocks until the whole bulk is there, which would delay
+     * low bitrate or live inputs. Unless reading from a local file, the
+     * bulk grows while the data is already buffered, and shrinks down to
+     * single packet reads when the peek has to wait. */
+    const unsigned i_wanted = p_sys->pending.i_bulk;
+    const vlc_tick_t i_start = vlc_tick_now();
+
+    ssize_t i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
+                                      i_size * i_wanted );
+    if( i_peek < 0 )
+        return false;
+
+    if( !p_sys->b_canfastseek )
+    {
+        if( vlc_tick_now() - i_start > TS_BULK_WAIT )
+        {
+            if( i_wanted > 2 )
+                p_sys->pending.i_bulk = i_wanted / 2;
+            else
+                p_sys->pending.i_single = TS_BULK_PACKETS;
+        }
+        else if( (size_t) i_peek == i_size * i_wanted )
+            p_sys->pending.i_bulk = __MIN( i_wanted * 2, TS_BULK_PACKETS );
+    }
+
+    /* Only consume packets that are in sync, so that the resync logic
+     * always sees the data where synchronization was lost. */
+    while( (i_count + 1) * i_size <= (size_t) i_peek &&
+           p_peek[i_count * i_size + p_sys->i_packet_header_size] == 0x47 )
+        i_count++;
+
+    if( i_count < 2 )
+        return false;
+
+    ts_bulk_t *p_bulk = malloc( sizeof(*p_bulk) + i_count * i_size );
+    if( unlikely(p_bulk == NULL) )
+        return false;
+
+    uint8_t *p_data = (uint8_t *) &p_bulk[1];
+    if( vlc_stream_Read( p_sys->stream, p_data, i_count * i_size )
+            != (ssize_t) (i_count * i_size) )
+    {
+        free( p_bulk );
+        return false;
+    }
+
+    atomic_init( &p_bulk->refs, i_count );
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        ts_bulk_packet_t *p_view = &p_bulk->packets[i];
+        block_t *p_pkt = block_Init( &p_view->self, &ts_bulk_cbs,
+                                     &p_data[i * i_size], i_size );
+
+        p_view->p_bulk = p_bulk;
+        /* Skip header (BluRay streams), see ReadTSPacket() */
+        p_pkt->p_buffer += p_sys->i_packet_header_size;
+        p_pkt->i_buffer -= p_sys->i_packet_header_size;
+
+        *p_sys->pending.pp_last = p_pkt;
+        p_sys->pending.pp_last = &p_pkt->p_next;
+    }
+    p_sys->pending.i_count += i_count;
+
+    return true;
+}
+
 static block_t* ReadTSPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     block_t     *p_pkt;
 
+    if( p_sys->pending.p_first != NULL || ReadTSPacketsBulk( p_demux ) )
+    {
+        p_pkt = p_sys->pending.p_first;
+        p_sys->pending.p_first = p_pkt->p_next;
+        if( p_sys->pending.p_first == NULL )
+            p_sys->pending.pp_last = &p_sys->pending.p_first;
+        p_sys->pending.i_count--;
+        p_pkt->p_next = NULL;
+        return p_pkt;
+    }
+
     /* Get a new TS packet */
     if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
     {
@@ -1761,26 +1923,23 @@ static block_t* ReadTSPacket( demux_t *p_demux )
 
             i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
                     p_sys->i_packet_size * 10 );
-            if( i_peek < 0 || (unsigned)i_peek < p_sys->i_packet_size + 1 )
+            if( i_peek < 0 || (unsigned)i_peek < p_sys->i_packet_size +
+                                       p_sys->i_packet_header_size + 1 )
             {
                 msg_Dbg( p_demux, "eof ?" );
                 return NULL;
             }
 
-            while( i_skip < i_peek - p_sys->i_packet_size )
-            {
-                if( p_peek[i_skip + p_sys->i_packet_header_size] == 0x47 &&
-                        p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
-                {
-                    break;
-                }
-                i_skip++;
-            }
+            /* Look for 2 sync bytes in a row */
+            const size_t i_len = i_peek - p_sys->i_packet_header_size;
+            i_skip = ts_sync_Find( &p_peek[p_sys->i_packet_header_size],
+                                   i_len, p_sys->i_packet_size, 1 );
+
             msg_Dbg( p_demux, "skipping %d bytes of garbage", i_skip );
             if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
                 return NULL;
 
-            if( i_skip < i_peek - p_sys->i_packet_size )
+            if( i_skip < ts_sync_Candidates( i_len, p_sys->i_packet_size, 1 ) )
             {
                 break;
             }
@@ -1901,17 +2060,31 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
 
     /* Deal with common but worst binary search case */
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
-        return vlc_stream_Seek( p_sys->stream, 0 );
+        return TsStreamSeek( p_sys, 0 );
+
+    /* Use the points indexed so far, close enough or to restrict the search */
+    const ts_seekpoint_t *p_before = NULL, *p_after = NULL;
+    const ts_seekindex_t *p_index = ts_seekindexes_Get( &p_sys->seekindex,
+                                                        p_pmt->i_number, false );
+    if( p_index )
+        ts_seekindex_Lookup( p_index, i_scaledtime, &p_before, &p_after );
+    if( p_before && p_sys->b_canseek &&
+        i_scaledtime - p_before->i_pcr < TO_SCALE(VLC_TICK_0 + VLC_TICK_FROM_MS(500)) )
+        return TsStreamSeek( p_sys, p_before->i_pos );
 
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
 
     /* Find the time position by using binary search algorithm. */
     uint64_t i_head_pos = 0;
     uint64_t i_tail_pos = (uint64_t) i_stream_size - p_sys->i_packet_size;
+    if( p_before )
+        i_head_pos = p_before->i_pos;
+    if( p_after && p_after->i_pos < i_tail_pos )
+        i_tail_pos = p_after->i_pos;
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
@@ -1923,7 +2096,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
         uint64_t i_div = i_splitpos % p_sys->i_packet_size;
         i_splitpos -= i_div;
 
-        if ( vlc_stream_Seek( p_sys->stream, i_splitpos ) != VLC_SUCCESS )
+        if ( TsStreamSeek( p_sys, i_splitpos ) != VLC_SUCCESS )
             break;
 
         uint64_t i_pos = i_splitpos;
@@ -1937,7 +2110,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                 break;
             }
             else
-                i_pos = vlc_stream_Tell( p_sys->stream );
+                i_pos = TsStreamTell( p_sys );
 
             int i_pid = PIDGet( p_pkt );
             ts_pid_t *p_pid = GetPID(p_sys, i_pid);
@@ -1994,7 +2167,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
-        vlc_stream_Seek( p_sys->stream, i_initial_pos );
+        TsStreamSeek( p_sys, i_initial_pos );
         return VLC_EGENERIC;
     }
     return VLC_SUCCESS;
@@ -2075,7 +2248,11 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, stime_t *pi_
                         if( b_end )
                         {
                             p_pmt->i_last_dts = *pi_pcr;
-                            p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                            p_pmt->i_last_dts_byte = TsStreamTell( p_sys );
+                            /* Only index real PCRs, not PES timestamps */
+                            if( b_pcrresult && p_pmt->pcr.i_first != -1 )
+                                ProgramIndexPCR( p_demux, p_pmt,
+                                                 TimeStampWrapAround( p_pmt->pcr.i_first, *pi_pcr ) );
                         }
                         /* Start, only keep first */
                         else if( b_pcrresult && p_pmt->pcr.i_first == -1 )
@@ -2103,7 +2280,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, stime_t *pi_
 int ProbeStart( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = 0;
@@ -2116,7 +2293,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
         i_pos = p_sys->i_packet_size * i_probe_count;
         i_pos = __MIN( i_pos, i_stream_size );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TsStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         ProbeChunk( p_demux, i_program, false, &i_pcr, &b_found );
@@ -2126,7 +2303,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
     } while( i_pos < i_stream_size && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TsStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2135,9 +2312,25 @@ int ProbeStart( demux_t *p_demux, int i_program )
 int ProbeEnd( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
+    ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
+    ts_pmt_t *p_pmt = i_program ? ts_pat_Get_pmt( p_pat, i_program ) : NULL;
+    ts_seekindex_t *p_index = NULL;
+    if( p_pmt )
+        p_index = ts_seekindexes_Get( &p_sys->seekindex, i_program, true );
+
+    /* The index already knows a PCR within the last probed chunk */
+    const ts_seekpoint_t *p_last = p_index ? ts_seekindex_Last( p_index ) : NULL;
+    if( p_last && i_stream_size > 0 && p_last->i_pos +
+        (uint64_t) p_sys->i_packet_size * PROBE_CHUNK_COUNT >= (uint64_t) i_stream_size )
+    {
+        p_pmt->i_last_dts = p_last->i_pcr;
+        p_pmt->i_last_dts_byte = p_last->i_pos + p_sys->i_packet_size;
+        return VLC_SUCCESS;
+    }
+
     int i_probe_count = PROBE_CHUNK_COUNT;
     int64_t i_pos;
     stime_t i_pcr = -1;
@@ -2148,7 +2341,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
         i_pos = i_stream_size - (p_sys->i_packet_size * i_probe_count);
         i_pos = __MAX( i_pos, 0 );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TsStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         ProbeChunk( p_demux, i_program, true, &i_pcr, &b_found );
@@ -2158,15 +2351,33 @@ int ProbeEnd( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TsStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
-static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
+/* Index the packet which carried that adaptation field PCR */
+static void ProgramIndexPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+    const uint64_t i_pos = TsStreamTell( p_sys );
+
+    if( !p_sys->b_canseek || i_pos < p_sys->i_packet_size )
+        return;
+
+    ts_seekindex_t *p_index = ts_seekindexes_Get( &p_sys->seekindex,
+                                                  p_pmt->i_number, true );
+    if( p_index )
+        ts_seekindex_Add( &p_sys->seekindex, p_index, i_pcr,
+                          i_pos - p_sys->i_packet_size );
+}
+
+static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr,
+                           bool b_index )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    bool b_fixedup = false;
 
     /* Check if we have enqueued blocks waiting the/before the
        PCR barrier, and then adapt pcr so they have valid PCR when dequeuing */
@@ -2195,6 +2406,7 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
             msg_Dbg( p_demux, "Program %d PCR prequeue fixup %"PRId64"->%"PRId64,
                      p_pmt->i_number, TO_SCALE(i_mindts), i_pcr );
             i_pcr = TO_SCALE(i_mindts);
+            b_fixedup = true;
         }
     }
 
@@ -2204,19 +2416,23 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
         p_pmt->pcr.i_first = i_pcr; // now seen
     }
 
+    /* Synthesized PCRs are PES timestamps, keep them out of the index */
+    if( b_index && !b_fixedup )
+        ProgramIndexPCR( p_demux, p_pmt, i_pcr );
+
     if ( p_sys->i_pmt_es )
     {
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TsStreamTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TsStreamTell( p_sys );
             }
         }
     }
@@ -2333,7 +2549,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
             if( PIDReferencedByProgram( p_pmt, pid->i_pid ) ) /* PCR shall be on pid itself */
             {
                 /* ? update PCR for the whole group program ? */
-                ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                ProgramSetPCR( p_demux, p_pmt, i_program_pcr, true );
             }
         }
         else /* set PCR provided by current pid to program(s) referencing it */
@@ -2343,7 +2559,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
             {
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
-                ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                ProgramSetPCR( p_demux, p_pmt, i_program_pcr, true );
             }
         }
 
@@ -20,6 +20,8 @@
 #ifndef VLC_TS_H
 #define VLC_TS_H
 
+#include "ts_seekindex.h"
+
 #ifdef HAVE_ARIBB24
     typedef struct arib_instance_t arib_instance_t;
 #endif
@@ -63,9 +65,23 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* TS packets read in bulk from the stream but not demuxed yet */
+    struct
+    {
+        block_t  *p_first;
+        block_t **pp_last;
+        unsigned  i_count;
+        unsigned  i_bulk;   /* packets to peek at once */
+        unsigned  i_single; /* packets to read one at a time before that */
+    } pending;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
+    /* PCR to byte offset index, built while playing */
+    ts_seekindexes_t seekindex;
+    bool        b_seekindex_cache;
+
     ts_standards_e standard;
 
     struct
@@ -0,0 +1,314 @@
+/*****************************************************************************
+ * ts_seekindex.c: MPEG-TS PCR to byte offset seek index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include <vlc_configuration.h>
+
+#include "ts_seekindex.h"
+
+/* Cache file layout, little endian:
+ *  magic[8], stream size (64), number of programs (32)
+ *  for each program: number (32), number of points (32),
+ *                    points: pcr (64), offset (64) */
+#define TS_SEEKINDEX_MAGIC      "VLCTSIX1"
+#define TS_SEEKINDEX_MAX_POINTS (1 << 20)
+
+void ts_seekindexes_Init( ts_seekindexes_t *p_indexes, uint64_t i_stream_size )
+{
+    p_indexes->p_indexes = NULL;
+    p_indexes->i_count = 0;
+    p_indexes->i_stream_size = i_stream_size;
+    p_indexes->b_dirty = false;
+}
+
+void ts_seekindexes_Clean( ts_seekindexes_t *p_indexes )
+{
+    for( size_t i = 0; i < p_indexes->i_count; i++ )
+        free( p_indexes->p_indexes[i].p_points );
+    free( p_indexes->p_indexes );
+    p_indexes->p_indexes = NULL;
+    p_indexes->i_count = 0;
+}
+
+ts_seekindex_t * ts_seekindexes_Get( ts_seekindexes_t *p_indexes,
+                                     int i_program, bool b_create )
+{
+    for( size_t i = 0; i < p_indexes->i_count; i++ )
+        if( p_indexes->p_indexes[i].i_program == i_program )
+            return &p_indexes->p_indexes[i];
+
+    if( !b_create )
+        return NULL;
+
+    ts_seekindex_t *p_realloc = realloc( p_indexes->p_indexes,
+                            sizeof(*p_realloc) * (p_indexes->i_count + 1) );
+    if( !p_realloc )
+        return NULL;
+    p_indexes->p_indexes = p_realloc;
+
+    ts_seekindex_t *p_index = &p_realloc[p_indexes->i_count++];
+    p_index->i_program = i_program;
+    p_index->p_points = NULL;
+    p_index->i_count = 0;
+    p_index->i_alloc = 0;
+    return p_index;
+}
+
+/* Returns the first point strictly after i_pcr */
+static size_t ts_seekindex_UpperBound( const ts_seekindex_t *p_index,
+                                       stime_t i_pcr )
+{
+    size_t i_low = 0, i_high = p_index->i_count;
+    while( i_low < i_high )
+    {
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_points[i_mid].i_pcr <= i_pcr )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+void ts_seekindex_Add( ts_seekindexes_t *p_indexes, ts_seekindex_t *p_index,
+                       stime_t i_pcr, uint64_t i_pos )
+{
+    const size_t k = ts_seekindex_UpperBound( p_index, i_pcr );
+    const ts_seekpoint_t *p_prev = k > 0 ? &p_index->p_points[k - 1] : NULL;
+    const ts_seekpoint_t *p_next = k < p_index->i_count ? &p_index->p_points[k] : NULL;
+
+    if( p_prev && ( i_pcr - p_prev->i_pcr < TS_SEEKINDEX_INTERVAL ||
+                    i_pos <= p_prev->i_pos ) )
+        return;
+    if( p_next && ( p_next->i_pcr - i_pcr < TS_SEEKINDEX_INTERVAL ||
+                    i_pos >= p_next->i_pos ) )
+        return;
+
+    if( p_index->i_count == p_index->i_alloc )
+    {
+        if( p_index->i_alloc >= TS_SEEKINDEX_MAX_POINTS )
+            return;
+        size_t i_alloc = p_index->i_alloc ? p_index->i_alloc * 2 : 256;
+        ts_seekpoint_t *p_realloc = realloc( p_index->p_points,
+                                             sizeof(*p_realloc) * i_alloc );
+        if( !p_realloc )
+            return;
+        p_index->p_points = p_realloc;
+        p_index->i_alloc = i_alloc;
+    }
+
+    memmove( &p_index->p_points[k + 1], &p_index->p_points[k],
+             sizeof(*p_index->p_points) * (p_index->i_count - k) );
+    p_index->p_points[k].i_pcr = i_pcr;
+    p_index->p_points[k].i_pos = i_pos;
+    p_index->i_count++;
+    p_indexes->b_dirty = true;
+}
+
+void ts_seekindex_Lookup( const ts_seekindex_t *p_index, stime_t i_pcr,
+                          const ts_seekpoint_t **pp_before,
+                          const ts_seekpoint_t **pp_after )
+{
+    const size_t k = ts_seekindex_UpperBound( p_index, i_pcr );
+    *pp_before = k > 0 ? &p_index->p_points[k - 1] : NULL;
+    *pp_after = k < p_index->i_count ? &p_index->p_points[k] : NULL;
+}
+
+static char * ts_seekindexes_Path( const char *psz_url, bool b_mkdir )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_cachedir )
+        return NULL;
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_url, strlen( psz_url ) );
+    EndMD5( &md5 );
+    char *psz_hash = psz_md5_hash( &md5 );
+
+    char *psz_path = NULL;
+    if( psz_hash )
+    {
+        if( b_mkdir )
+        {
+            char *psz_dir;
+            vlc_mkdir( psz_cachedir, 0700 );
+            if( asprintf( &psz_dir, "%s" DIR_SEP "ts-index", psz_cachedir ) != -1 )
+            {
+                vlc_mkdir( psz_dir, 0700 );
+                free( psz_dir );
+            }
+        }
+        if( asprintf( &psz_path, "%s" DIR_SEP "ts-index" DIR_SEP "%s.idx",
+                      psz_cachedir, psz_hash ) == -1 )
+            psz_path = NULL;
+        free( psz_hash );
+    }
+    free( psz_cachedir );
+    return psz_path;
+}
+
+static int ts_seekindexes_Read( FILE *p_file, ts_seekindexes_t *p_indexes )
+{
+    uint8_t header[20];
+    if( fread( header, sizeof(header), 1, p_file ) != 1 ||
+        memcmp( header, TS_SEEKINDEX_MAGIC, 8 ) ||
+        GetQWLE( &header[8] ) != p_indexes->i_stream_size )
+        return VLC_EGENERIC;
+
+    uint32_t i_programs = GetDWLE( &header[16] );
+    for( uint32_t i = 0; i < i_programs; i++ )
+    {
+        uint8_t program[8];
+        if( fread( program, sizeof(program), 1, p_file ) != 1 )
+            return VLC_EGENERIC;
+
+        uint32_t i_points = GetDWLE( &program[4] );
+        if( i_points > TS_SEEKINDEX_MAX_POINTS )
+            return VLC_EGENERIC;
+
+        ts_seekindex_t *p_index = ts_seekindexes_Get( p_indexes,
+                                        (int) GetDWLE( &program[0] ), true );
+        if( !p_index || p_index->i_count )
+            return VLC_EGENERIC;
+
+        p_index->p_points = vlc_alloc( i_points, sizeof(*p_index->p_points) );
+        if( i_points && !p_index->p_points )
+            return VLC_ENOMEM;
+        p_index->i_alloc = i_points;
+
+        for( uint32_t j = 0; j < i_points; j++ )
+        {
+            uint8_t point[16];
+            if( fread( point, sizeof(point), 1, p_file ) != 1 )
+                return VLC_EGENERIC;
+
+            ts_seekpoint_t *p_point = &p_index->p_points[j];
+            p_point->i_pcr = (stime_t) GetQWLE( &point[0] );
+            p_point->i_pos = GetQWLE( &point[8] );
+            if( p_point->i_pos >= p_indexes->i_stream_size ||
+                ( j > 0 && ( p_point->i_pcr <= p_point[-1].i_pcr ||
+                             p_point->i_pos <= p_point[-1].i_pos ) ) )
+                return VLC_EGENERIC;
+            p_index->i_count++;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+int ts_seekindexes_Load( vlc_object_t *p_obj, ts_seekindexes_t *p_indexes,
+                         const char *psz_url )
+{
+    char *psz_path = ts_seekindexes_Path( psz_url, false );
+    if( !psz_path )
+        return VLC_ENOMEM;
+
+    FILE *p_file = vlc_fopen( psz_path, "rb" );
+    if( !p_file )
+    {
+        free( psz_path );
+        return VLC_EGENERIC;
+    }
+
+    int i_ret = ts_seekindexes_Read( p_file, p_indexes );
+    fclose( p_file );
+
+    if( i_ret != VLC_SUCCESS )
+    {
+        msg_Dbg( p_obj, "discarding seek index %s", psz_path );
+        ts_seekindexes_Clean( p_indexes );
+    }
+    else
+    {
+        msg_Dbg( p_obj, "loaded seek index %s", psz_path );
+        p_indexes->b_dirty = false;
+    }
+    free( psz_path );
+    return i_ret;
+}
+
+static int ts_seekindexes_Write( FILE *p_file, const ts_seekindexes_t *p_indexes )
+{
+    uint8_t header[20];
+    memcpy( header, TS_SEEKINDEX_MAGIC, 8 );
+    SetQWLE( &header[8], p_indexes->i_stream_size );
+    SetDWLE( &header[16], p_indexes->i_count );
+    if( fwrite( header, sizeof(header), 1, p_file ) != 1 )
+        return VLC_EGENERIC;
+
+    for( size_t i = 0; i < p_indexes->i_count; i++ )
+    {
+        const ts_seekindex_t *p_index = &p_indexes->p_indexes[i];
+        uint8_t program[8];
+        SetDWLE( &program[0], p_index->i_program );
+        SetDWLE( &program[4], p_index->i_count );
+        if( fwrite( program, sizeof(program), 1, p_file ) != 1 )
+            return VLC_EGENERIC;
+
+        for( size_t j = 0; j < p_index->i_count; j++ )
+        {
+            uint8_t point[16];
+            SetQWLE( &point[0], p_index->p_points[j].i_pcr );
+            SetQWLE( &point[8], p_index->p_points[j].i_pos );
+            if( fwrite( point, sizeof(point), 1, p_file ) != 1 )
+                return VLC_EGENERIC;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+int ts_seekindexes_Save( vlc_object_t *p_obj, const ts_seekindexes_t *p_indexes,
+                         const char *psz_url )
+{
+    char *psz_path = ts_seekindexes_Path( psz_url, true );
+    char *psz_tmp;
+    if( !psz_path || asprintf( &psz_tmp, "%s.tmp", psz_path ) == -1 )
+    {
+        free( psz_path );
+        return VLC_ENOMEM;
+    }
+
+    int i_ret = VLC_EGENERIC;
+    FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+    if( p_file )
+    {
+        i_ret = ts_seekindexes_Write( p_file, p_indexes );
+        if( fclose( p_file ) && i_ret == VLC_SUCCESS )
+            i_ret = VLC_EGENERIC;
+        /* Replace atomically, readers never see a partial index */
+        if( i_ret == VLC_SUCCESS && vlc_rename( psz_tmp, psz_path ) )
+            i_ret = VLC_EGENERIC;
+        if( i_ret != VLC_SUCCESS )
+            vlc_unlink( psz_tmp );
+    }
+
+    if( i_ret == VLC_SUCCESS )
+        msg_Dbg( p_obj, "saved seek index %s", psz_path );
+    else
+        msg_Warn( p_obj, "cannot save seek index %s", psz_path );
+    free( psz_tmp );
+    free( psz_path );
+    return i_ret;
+}
@@ -0,0 +1,84 @@
+/*****************************************************************************
+ * ts_seekindex.h: MPEG-TS PCR to byte offset seek index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_SEEKINDEX_H
+#define VLC_TS_SEEKINDEX_H
+
+#include "timestamps.h"
+
+/* Minimum distance between two points of the index */
+#define TS_SEEKINDEX_INTERVAL TO_SCALE_NZ(VLC_TICK_FROM_MS(500))
+
+typedef struct
+{
+    stime_t  i_pcr;  /* program time, wrapped around the first PCR */
+    uint64_t i_pos;  /* offset of the packet carrying it */
+} ts_seekpoint_t;
+
+typedef struct
+{
+    int             i_program;
+    ts_seekpoint_t *p_points; /* sorted by both time and offset */
+    size_t          i_count;
+    size_t          i_alloc;
+} ts_seekindex_t;
+
+typedef struct
+{
+    ts_seekindex_t *p_indexes;
+    size_t          i_count;
+    uint64_t        i_stream_size; /* size of the indexed stream */
+    bool            b_dirty;       /* points added since loaded */
+} ts_seekindexes_t;
+
+void ts_seekindexes_Init( ts_seekindexes_t *, uint64_t i_stream_size );
+void ts_seekindexes_Clean( ts_seekindexes_t * );
+
+ts_seekindex_t * ts_seekindexes_Get( ts_seekindexes_t *, int i_program, bool b_create );
+
+/**
+ * Adds a point to a program index, unless it is too close to an existing one,
+ * or inconsistent with it (PCR discontinuity).
+ */
+void ts_seekindex_Add( ts_seekindexes_t *, ts_seekindex_t *,
+                       stime_t i_pcr, uint64_t i_pos );
+
+/**
+ * Finds the points surrounding a time.
+ *
+ * \param pp_before last point at or before i_pcr, or NULL [OUT]
+ * \param pp_after first point after i_pcr, or NULL [OUT]
+ */
+void ts_seekindex_Lookup( const ts_seekindex_t *, stime_t i_pcr,
+                          const ts_seekpoint_t **pp_before,
+                          const ts_seekpoint_t **pp_after );
+
+static inline const ts_seekpoint_t * ts_seekindex_Last( const ts_seekindex_t *p_index )
+{
+    return p_index->i_count ? &p_index->p_points[p_index->i_count - 1] : NULL;
+}
+
+/**
+ * Loads or saves the indexes of a stream in the user cache directory.
+ * The cache entry is identified by the stream URL and size.
+ */
+int ts_seekindexes_Load( vlc_object_t *, ts_seekindexes_t *, const char *psz_url );
+int ts_seekindexes_Save( vlc_object_t *, const ts_seekindexes_t *, const char *psz_url );
+
+#endif
@@ -0,0 +1,261 @@
+/*****************************************************************************
+ * ts_sync.h: MPEG-TS sync byte scanning helpers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_SYNC_H
+#define VLC_TS_SYNC_H
+
+#include <string.h>
+#include <vlc_cpu.h>
+
+#if defined(HAVE_SSE2_INTRINSICS)
+   #include <emmintrin.h>
+   #include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+   #include <arm_neon.h>
+   #define TS_SYNC_NEON
+#endif
+
+#define TS_SYNC_BYTE 0x47
+
+/* The ts_sync_Find*() functions look for the first offset o in p such that
+ * p[o], p[o + i_stride], ..., p[o + i_checks * i_stride] are all sync bytes.
+ *
+ * They return the offset, or the number of candidate offsets in the buffer
+ * (i.e. i_len - i_checks * i_stride, or 0) if there is no match. */
+
+static inline size_t ts_sync_Candidates( size_t i_len, size_t i_stride,
+                                         unsigned i_checks )
+{
+    size_t i_span = i_stride * i_checks;
+    return i_len > i_span ? i_len - i_span : 0;
+}
+
+static inline bool ts_sync_Check( const uint8_t *p, size_t i_stride,
+                                  unsigned i_checks )
+{
+    for( unsigned i = 1; i <= i_checks; i++ )
+        if( p[i * i_stride] != TS_SYNC_BYTE )
+            return false;
+    return true;
+}
+
+/* Reference implementation, one byte at a time */
+static inline size_t ts_sync_Find_C( const uint8_t *p, size_t i_len,
+                                     size_t i_stride, unsigned i_checks )
+{
+    const size_t i_end = ts_sync_Candidates( i_len, i_stride, i_checks );
+    size_t i;
+
+    for( i = 0; i < i_end; i++ )
+        if( p[i] == TS_SYNC_BYTE && ts_sync_Check( &p[i], i_stride, i_checks ) )
+            break;
+    return i;
+}
+
+/* Generic implementation, using memchr() to skip over non-sync bytes */
+static inline size_t ts_sync_Find_Generic( const uint8_t *p, size_t i_len,
+                                           size_t i_stride, unsigned i_checks )
+{
+    const size_t i_end = ts_sync_Candidates( i_len, i_stride, i_checks );
+    size_t i = 0;
+
+    while( i < i_end )
+    {
+        const uint8_t *c = memchr( &p[i], TS_SYNC_BYTE, i_end - i );
+        if( c == NULL )
+            return i_end;
+        i = c - p;
+        if( ts_sync_Check( c, i_stride, i_checks ) )
+            return i;
+        i++;
+    }
+    return i_end;
+}
+
+#if defined(HAVE_SSE2_INTRINSICS)
+/* Compares 16 (or 32) candidates at once: each lane of the mask tells
+ * whether the matching offset has all its sync bytes in place. Blocks of 64
+ * bytes without any sync byte are skipped first, as is most of the data
+ * while looking for synchronization. */
+__attribute__ ((__target__ ("sse2")))
+static inline unsigned ts_sync_Mask_SSE2( const uint8_t *p, size_t i_stride,
+                                          unsigned i_checks, __m128i sync )
+{
+    __m128i m = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)p ), sync );
+
+    for( unsigned k = 1; k <= i_checks && _mm_movemask_epi8( m ); k++ )
+        m = _mm_and_si128( m, _mm_cmpeq_epi8(
+            _mm_loadu_si128( (const __m128i *)&p[k * i_stride] ), sync ) );
+    return _mm_movemask_epi8( m );
+}
+
+__attribute__ ((__target__ ("sse2")))
+static inline size_t ts_sync_Find_SSE2( const uint8_t *p, size_t i_len,
+                                        size_t i_stride, unsigned i_checks )
+{
+    const size_t i_end = ts_sync_Candidates( i_len, i_stride, i_checks );
+    const __m128i sync = _mm_set1_epi8( TS_SYNC_BYTE );
+    size_t i = 0;
+
+    for( ; i + 64 <= i_end; i += 64 )
+    {
+        __m128i any = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)&p[i] ), sync ),
+                _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)&p[i + 16] ), sync ) ),
+            _mm_or_si128(
+                _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)&p[i + 32] ), sync ),
+                _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i *)&p[i + 48] ), sync ) ) );
+        if( !_mm_movemask_epi8( any ) )
+            continue;
+
+        for( unsigned j = 0; j < 64; j += 16 )
+        {
+            unsigned mask = ts_sync_Mask_SSE2( &p[i + j], i_stride, i_checks,
+                                               sync );
+            if( mask )
+                return i + j + __builtin_ctz( mask );
+        }
+    }
+
+    for( ; i + 16 <= i_end; i += 16 )
+    {
+        unsigned mask = ts_sync_Mask_SSE2( &p[i], i_stride, i_checks, sync );
+        if( mask )
+            return i + __builtin_ctz( mask );
+    }
+
+    return i + ts_sync_Find_C( &p[i], i_len - i, i_stride, i_checks );
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline size_t ts_sync_Find_AVX2( const uint8_t *p, size_t i_len,
+                                        size_t i_stride, unsigned i_checks )
+{
+    const size_t i_end = ts_sync_Candidates( i_len, i_stride, i_checks );
+    const __m256i sync = _mm256_set1_epi8( TS_SYNC_BYTE );
+    size_t i = 0;
+
+    for( ; i + 64 <= i_end; i += 64 )
+    {
+        __m256i m0 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256( (const __m256i *)&p[i] ), sync );
+        __m256i m1 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256( (const __m256i *)&p[i + 32] ), sync );
+        if( !_mm256_movemask_epi8( _mm256_or_si256( m0, m1 ) ) )
+            continue;
+
+        for( unsigned k = 1; k <= i_checks; k++ )
+        {
+            m0 = _mm256_and_si256( m0, _mm256_cmpeq_epi8(
+                _mm256_loadu_si256( (const __m256i *)&p[i + k * i_stride] ),
+                sync ) );
+            m1 = _mm256_and_si256( m1, _mm256_cmpeq_epi8(
+                _mm256_loadu_si256( (const __m256i *)&p[i + 32 + k * i_stride] ),
+                sync ) );
+        }
+
+        uint64_t mask = (uint32_t)_mm256_movemask_epi8( m0 )
+                      | (uint64_t)(uint32_t)_mm256_movemask_epi8( m1 ) << 32;
+        if( mask )
+            return i + __builtin_ctzll( mask );
+    }
+
+    return i + ts_sync_Find_SSE2( &p[i], i_len - i, i_stride, i_checks );
+}
+
+static inline size_t ts_sync_Find( const uint8_t *p, size_t i_len,
+                                   size_t i_stride, unsigned i_checks )
+{
+    if( vlc_CPU_AVX2() )
+        return ts_sync_Find_AVX2( p, i_len, i_stride, i_checks );
+    if( vlc_CPU_SSE2() )
+        return ts_sync_Find_SSE2( p, i_len, i_stride, i_checks );
+    return ts_sync_Find_Generic( p, i_len, i_stride, i_checks );
+}
+
+#elif defined(TS_SYNC_NEON)
+static inline size_t ts_sync_Find_NEON( const uint8_t *p, size_t i_len,
+                                        size_t i_stride, unsigned i_checks )
+{
+    const size_t i_end = ts_sync_Candidates( i_len, i_stride, i_checks );
+    const uint8x16_t sync = vdupq_n_u8( TS_SYNC_BYTE );
+    size_t i = 0;
+
+    for( ; i + 16 <= i_end; i += 16 )
+    {
+        uint8x16_t m = vceqq_u8( vld1q_u8( &p[i] ), sync );
+        for( unsigned k = 1; k <= i_checks; k++ )
+            m = vandq_u8( m, vceqq_u8( vld1q_u8( &p[i + k * i_stride] ),
+                                       sync ) );
+
+        uint64x2_t m64 = vreinterpretq_u64_u8( m );
+        if( vgetq_lane_u64( m64, 0 ) | vgetq_lane_u64( m64, 1 ) )
+            return i + ts_sync_Find_C( &p[i], 16 + i_stride * i_checks,
+                                       i_stride, i_checks );
+    }
+
+    return i + ts_sync_Find_C( &p[i], i_len - i, i_stride, i_checks );
+}
+#define ts_sync_Find ts_sync_Find_NEON
+
+#else
+#define ts_sync_Find ts_sync_Find_Generic
+#endif
+
+/**
+ * Detects the packet size of a transport stream.
+ *
+ * Finds the first offset where 188, 192 or 204 bytes packets have
+ * i_checks consecutive sync bytes, in that order of preference.
+ *
+ * \param pi_offset offset of the first sync byte [OUT]
+ * \return the packet size, or 0 if none was found
+ */
+static inline unsigned ts_sync_DetectPacketSize( const uint8_t *p,
+                                                 size_t i_len,
+                                                 unsigned i_checks,
+                                                 size_t *pi_offset )
+{
+    static const unsigned sizes[] = { 188, 192, 204 };
+    size_t i_best = SIZE_MAX;
+    unsigned i_size = 0;
+
+    for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+    {
+        /* Only search before the best offset found so far */
+        size_t i_max = i_best < SIZE_MAX ? i_best + sizes[i] * i_checks
+                                         : i_len;
+        size_t i_found = ts_sync_Find( p, __MIN(i_max, i_len), sizes[i],
+                                       i_checks );
+
+        if( i_found < ts_sync_Candidates( __MIN(i_max, i_len), sizes[i],
+                                          i_checks ) && i_found < i_best )
+        {
+            i_best = i_found;
+            i_size = sizes[i];
+        }
+    }
+
+    if( i_size )
+        *pi_offset = i_best;
+    return i_size;
+}
+
+#endif
@@ -413,7 +413,7 @@ static inline const char * __config_GetLabel(vlc_object_t *p_this, const char *p
     assert(p_item);
 
     char **values, **texts;
-    ssize_t count = config_GetPszChoices(name, &values, &texts);
+    ssize_t count = config_GetPszChoices(p_intf, name, &values, &texts);
     if (count < 0) {
         msg_Err(p_intf, "Cannot get choices for %s", name);
         return;
@@ -462,7 +462,7 @@ static inline const char * __config_GetLabel(vlc_object_t *p_this, const char *p
 
     int64_t *values;
     char **texts;
-    ssize_t count = config_GetIntChoices(name, &values, &texts);
+    ssize_t count = config_GetIntChoices(p_intf, name, &values, &texts);
     for (ssize_t i = 0; i < count; i++) {
         NSMenuItem *mi = [[NSMenuItem alloc] initWithTitle: toNSStr(texts[i]) action: NULL keyEquivalent: @""];
         [mi setRepresentedObject:[NSNumber numberWithInteger:values[i]]];
@@ -1054,7 +1054,7 @@ o_textfield = [[NSSecureTextField alloc] initWithFrame: s_rc];              \
     char *psz_value = config_GetPsz(self.p_item->psz_name);
 
     char **values, **texts;
-    ssize_t count = config_GetPszChoices(self.p_item->psz_name,
+    ssize_t count = config_GetPszChoices(getIntf(), self.p_item->psz_name,
                                          &values, &texts);
     for (ssize_t i = 0; i < count && texts; i++) {
         if (texts[i] == NULL || values[i] == NULL)
@@ -1462,7 +1462,7 @@ o_textfield = [[NSSecureTextField alloc] initWithFrame: s_rc];              \
     NSInteger i_current_selection = config_GetInt(self.p_item->psz_name);
     int64_t *values;
     char **texts;
-    ssize_t count = config_GetIntChoices(self.p_item->psz_name, &values, &texts);
+    ssize_t count = config_GetIntChoices(getIntf(), self.p_item->psz_name, &values, &texts);
     for (ssize_t i = 0; i < count; i++) {
         NSMenuItem *mi = [[NSMenuItem alloc] initWithTitle: toNSStr(texts[i]) action: NULL keyEquivalent: @""];
         [mi setRepresentedObject:[NSNumber numberWithInteger:values[i]]];
@@ -402,7 +402,7 @@ void ExtVideo::initComboBoxItems( QObject *widget )
     {
         int64_t *values;
         char **texts;
-        ssize_t count = config_GetIntChoices( qtu( option ), &values, &texts );
+        ssize_t count = config_GetIntChoices( p_intf, qtu( option ), &values, &texts );
         for( ssize_t i = 0; i < count; i++ )
         {
             combobox->addItem( qtr( texts[i] ), qlonglong(values[i]) );
@@ -415,7 +415,7 @@ void ExtVideo::initComboBoxItems( QObject *widget )
     {
         char **values;
         char **texts;
-        ssize_t count = config_GetPszChoices( qtu( option ), &values, &texts );
+        ssize_t count = config_GetPszChoices( p_intf, qtu( option ), &values, &texts );
         for( ssize_t i = 0; i < count; i++ )
         {
             combobox->addItem( qtr( texts[i] ), qfu(values[i]) );
@@ -34,6 +34,31 @@
 #include <vlc_stream.h>
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
+#include <vlc_url.h>
+
+#if defined (HAVE_LINUX_IO_URING_H) && defined (HAVE_SYS_EVENTFD_H)
+# define PREFETCH_URING 1
+# include <errno.h>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <sys/eventfd.h>
+# include "prefetch_uring.h"
+
+/* Maximum number of reads in flight */
+# define URING_DEPTH 8
+/* Reads are split on multiples of this size */
+# define URING_CHUNK (256 << 10)
+/* Completion tag of the wake-up event read */
+# define URING_WAKEUP URING_DEPTH
+
+struct prefetch_read
+{
+    uint64_t offset;
+    size_t   length;
+    int      result;
+    bool     done;
+};
+#endif
 
 struct stream_ctrl
 {
@@ -62,6 +87,7 @@ typedef struct
     bool         paused;
 
     bool         can_seek;
+    bool         can_fastseek;
     bool         can_pace;
     bool         can_pause;
     uint64_t     size;
@@ -76,6 +102,21 @@ typedef struct
     size_t       seek_threshold;
 
     struct stream_ctrl *controls;
+
+#ifdef PREFETCH_URING
+    struct
+    {
+        struct prefetch_uring *ring; /**< NULL if reading through a thread */
+        int fd; /**< Underlying file */
+        int wakeup; /**< Event to interrupt completion waits */
+        uint64_t wakeup_value;
+        bool wakeup_armed;
+        struct prefetch_read reads[URING_DEPTH]; /**< In file order */
+        unsigned head;
+        unsigned count;
+        uint64_t next_offset; /**< End of data read or being read */
+    } uring;
+#endif
 } stream_sys_t;
 
 static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
@@ -272,6 +313,311 @@ static void *Thread(void *data)
     return NULL;
 }
 
+#ifdef PREFETCH_URING
+/* The io_uring engine reads the file directly, with up to URING_DEPTH reads
+ * in flight at increasing offsets. Completed reads extend the buffered data
+ * in file order. On seek outside of the read-ahead window, the reads in
+ * flight are cancelled and reading restarts from the new offset. */
+
+static void UringWake(stream_sys_t *sys)
+{
+    if (sys->uring.ring != NULL)
+        eventfd_write(sys->uring.wakeup, 1);
+}
+
+static void UringWait(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    uint64_t tag;
+    int res;
+
+    if (!sys->uring.wakeup_armed
+     && prefetch_uring_Read(sys->uring.ring, sys->uring.wakeup,
+                            &sys->uring.wakeup_value,
+                            sizeof (sys->uring.wakeup_value), -1,
+                            URING_WAKEUP) == 0)
+        sys->uring.wakeup_armed = true;
+
+    int canc = vlc_savecancel();
+    vlc_mutex_unlock(&sys->lock);
+
+    if (prefetch_uring_Submit(sys->uring.ring, 1))
+        msg_Err(stream, "cannot submit reads: %s", vlc_strerror_c(errno));
+
+    vlc_mutex_lock(&sys->lock);
+    vlc_restorecancel(canc);
+
+    while (prefetch_uring_Reap(sys->uring.ring, &tag, &res))
+    {
+        if (tag == URING_WAKEUP)
+            sys->uring.wakeup_armed = false;
+        else if (tag < URING_DEPTH)
+        {
+            sys->uring.reads[tag].result = res;
+            sys->uring.reads[tag].done = true;
+        }
+    }
+}
+
+static bool UringBusy(const stream_sys_t *sys)
+{
+    for (unsigned i = 0; i < sys->uring.count; i++)
+        if (!sys->uring.reads[(sys->uring.head + i) % URING_DEPTH].done)
+            return true;
+    return false;
+}
+
+/* Cancels the reads in flight and waits until the buffer is not written to
+ * anymore. */
+static void UringFlush(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    for (unsigned i = 0; i < sys->uring.count; i++)
+    {
+        unsigned slot = (sys->uring.head + i) % URING_DEPTH;
+        if (!sys->uring.reads[slot].done)
+            prefetch_uring_Cancel(sys->uring.ring, slot);
+    }
+    while (UringBusy(sys))
+        UringWait(stream);
+
+    sys->uring.head = 0;
+    sys->uring.count = 0;
+    sys->uring.next_offset = sys->buffer_offset + sys->buffer_length;
+}
+
+/* Appends the completed reads, in file order, to the buffered data */
+static void UringAdvance(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    while (sys->uring.count > 0)
+    {
+        const struct prefetch_read *rd = &sys->uring.reads[sys->uring.head];
+        if (!rd->done)
+            break;
+
+        sys->uring.head = (sys->uring.head + 1) % URING_DEPTH;
+        sys->uring.count--;
+
+        if (rd->result < 0)
+        {
+            if (rd->result != -EINTR && rd->result != -EAGAIN)
+            {
+                msg_Err(stream, "read error: %s",
+                        vlc_strerror_c(-rd->result));
+                sys->error = true;
+            }
+            UringFlush(stream);
+            break;
+        }
+
+        assert(rd->offset == sys->buffer_offset + sys->buffer_length);
+        sys->buffer_length += rd->result;
+        assert(sys->buffer_length <= sys->buffer_size);
+
+        if ((size_t)rd->result < rd->length)
+        {   /* Short read: the following reads are not contiguous anymore */
+            if (rd->result == 0)
+            {
+                msg_Dbg(stream, "end of stream");
+                sys->eof = true;
+            }
+            UringFlush(stream);
+            break;
+        }
+    }
+    vlc_cond_signal(&sys->wait_data);
+}
+
+static void UringSubmitReads(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    while (sys->uring.count < URING_DEPTH)
+    {
+        uint64_t offset = sys->uring.next_offset;
+        size_t used = offset - sys->buffer_offset;
+
+        assert(used <= sys->buffer_size);
+        if (used == sys->buffer_size)
+        {   /* Discard some historical data to make room. */
+            uint64_t history = sys->stream_offset - sys->buffer_offset;
+            if (history > sys->buffer_length)
+                history = sys->buffer_length;
+            if (history == 0)
+                break;
+
+            sys->buffer_offset += history;
+            sys->buffer_length -= history;
+            continue;
+        }
+
+        size_t pos = offset % sys->buffer_size;
+        size_t len = sys->buffer_size - used;
+        /* Do not step past the sharp edge of the circular buffer */
+        if (pos + len > sys->buffer_size)
+            len = sys->buffer_size - pos;
+        if (len > URING_CHUNK - (offset % URING_CHUNK))
+            len = URING_CHUNK - (offset % URING_CHUNK);
+
+        unsigned slot = (sys->uring.head + sys->uring.count) % URING_DEPTH;
+        struct prefetch_read *rd = &sys->uring.reads[slot];
+
+        if (prefetch_uring_Read(sys->uring.ring, sys->uring.fd,
+                                sys->buffer + pos, len, offset, slot))
+            break;
+
+        rd->offset = offset;
+        rd->length = len;
+        rd->done = false;
+        sys->uring.count++;
+        sys->uring.next_offset += len;
+    }
+}
+
+static void *UringThread(void *data)
+{
+    stream_t *stream = data;
+    stream_sys_t *sys = stream->p_sys;
+    bool paused = false;
+
+    vlc_interrupt_set(sys->interrupt);
+
+    vlc_mutex_lock(&sys->lock);
+    mutex_cleanup_push(&sys->lock);
+    for (;;)
+    {
+        struct stream_ctrl *ctrl = sys->controls;
+
+        vlc_testcancel();
+
+        if (unlikely(ctrl != NULL))
+        {
+            sys->controls = ctrl->next;
+            ThreadControl(stream, ctrl->query, ctrl->id_state.id,
+                          ctrl->id_state.state);
+            free(ctrl);
+            continue;
+        }
+
+        if (sys->paused != paused)
+        {   /* Update pause state */
+            msg_Dbg(stream, paused ? "resuming" : "pausing");
+            paused = sys->paused;
+            ThreadControl(stream, STREAM_SET_PAUSE_STATE, paused);
+            continue;
+        }
+
+        uint_fast64_t stream_offset = sys->stream_offset;
+
+        if (!paused && !sys->error
+         && (stream_offset < sys->buffer_offset
+          || stream_offset >= sys->uring.next_offset + sys->seek_threshold))
+        {   /* Out of the read-ahead window: restart from the new offset */
+            UringFlush(stream);
+            sys->buffer_offset = stream_offset;
+            sys->buffer_length = 0;
+            sys->uring.next_offset = stream_offset;
+            sys->eof = false;
+            continue;
+        }
+
+        if (!paused && !sys->error && !sys->eof)
+            UringSubmitReads(stream);
+
+        if (sys->uring.count == 0)
+        {   /* Paused, failed, at end of stream or buffer full */
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
+
+        UringWait(stream);
+        UringAdvance(stream);
+    }
+    vlc_assert_unreachable();
+    vlc_cleanup_pop();
+    return NULL;
+}
+
+/* Opens the file underlying the stream, if it is a local regular file */
+static int UringOpenFile(stream_t *stream)
+{
+    if (stream->psz_url == NULL)
+        return -1;
+
+    char *path = vlc_uri2path(stream->psz_url);
+    if (path == NULL)
+        return -1;
+
+    int fd = vlc_open(path, O_RDONLY);
+    free(path);
+    if (fd == -1)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode))
+    {
+        vlc_close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool UringInit(stream_t *stream, int fd)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    sys->uring.ring = NULL;
+    if (fd == -1)
+        return false;
+
+    sys->uring.wakeup = eventfd(0, EFD_CLOEXEC);
+    if (sys->uring.wakeup == -1)
+        goto error;
+
+    /* Room for the reads, their cancellations and the wake-up event */
+    sys->uring.ring = prefetch_uring_New(2 * URING_DEPTH + 1);
+    if (sys->uring.ring == NULL)
+    {
+        msg_Dbg(stream, "io_uring not available: %s", vlc_strerror_c(errno));
+        vlc_close(sys->uring.wakeup);
+        goto error;
+    }
+
+    sys->uring.fd = fd;
+    sys->uring.wakeup_armed = false;
+    sys->uring.head = 0;
+    sys->uring.count = 0;
+    sys->uring.next_offset = 0;
+    return true;
+
+error:
+    vlc_close(fd);
+    return false;
+}
+
+static void UringClean(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    /* The kernel must not write to the buffer once it is freed */
+    vlc_mutex_lock(&sys->lock);
+    UringFlush(stream);
+    while (sys->uring.wakeup_armed)
+    {
+        eventfd_write(sys->uring.wakeup, 1);
+        UringWait(stream);
+    }
+    vlc_mutex_unlock(&sys->lock);
+
+    prefetch_uring_Delete(sys->uring.ring);
+    vlc_close(sys->uring.wakeup);
+    vlc_close(sys->uring.fd);
+}
+#endif
+
 static int Seek(stream_t *stream, uint64_t offset)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -280,6 +626,9 @@ static int Seek(stream_t *stream, uint64_t offset)
     sys->stream_offset = offset;
     sys->error = false;
     vlc_cond_signal(&sys->wait_space);
+#ifdef PREFETCH_URING
+    UringWake(sys);
+#endif
     vlc_mutex_unlock(&sys->lock);
     return 0;
 }
@@ -356,7 +705,7 @@ static int Control(stream_t *stream, int query, va_list args)
             *va_arg(args, bool *) = sys->can_seek;
             break;
         case STREAM_CAN_FASTSEEK:
-            *va_arg(args, bool *) = false;
+            *va_arg(args, bool *) = sys->can_fastseek;
             break;
         case STREAM_CAN_PAUSE:
              *va_arg(args, bool *) = sys->can_pause;
@@ -392,6 +741,9 @@ static int Control(stream_t *stream, int query, va_list args)
             vlc_mutex_lock(&sys->lock);
             sys->paused = paused;
             vlc_cond_signal(&sys->wait_space);
+#ifdef PREFETCH_URING
+            UringWake(sys);
+#endif
             vlc_mutex_unlock (&sys->lock);
             break;
         }
@@ -412,6 +764,9 @@ static int Control(stream_t *stream, int query, va_list args)
             for (pp = &sys->controls; *pp != NULL; pp = &((*pp)->next));
             *pp = ctrl;
             vlc_cond_signal(&sys->wait_space);
+#ifdef PREFETCH_URING
+            UringWake(sys);
+#endif
             vlc_mutex_unlock(&sys->lock);
             break;
         }
@@ -435,8 +790,17 @@ static int Open(vlc_object_t *obj)
      * undesirable high load at start-up. Lastly, local files may require
      * support for title/seekpoint and meta control requests. */
     vlc_stream_Control(stream->s, STREAM_CAN_FASTSEEK, &fast_seek);
+#ifdef PREFETCH_URING
+    /* Asynchronous reads are worth it even for local files */
+    int fd = -1;
+    if (var_InheritBool(obj, "prefetch-io-uring"))
+        fd = UringOpenFile(stream);
+    if (fast_seek && fd == -1)
+        return VLC_EGENERIC;
+#else
     if (fast_seek)
         return VLC_EGENERIC;
+#endif
 
     /* PID-filtered streams are not suitable for prefetching, as they would
      * suffer excessive latency to enable a PID. DVB would also require support
@@ -444,11 +808,35 @@ static int Open(vlc_object_t *obj)
      * TODO? For seekable streams, a forced could work around the problem. */
     if (vlc_stream_Control(stream->s, STREAM_GET_PRIVATE_ID_STATE, 0,
                            &(bool){ false }) == VLC_SUCCESS)
+    {
+#ifdef PREFETCH_URING
+        if (fd != -1)
+            vlc_close(fd);
+#endif
         return VLC_EGENERIC;
+    }
 
     stream_sys_t *sys = malloc(sizeof (*sys));
     if (unlikely(sys == NULL))
+    {
+#ifdef PREFETCH_URING
+        if (fd != -1)
+            vlc_close(fd);
+#endif
         return VLC_ENOMEM;
+    }
+    stream->p_sys = sys;
+
+#ifdef PREFETCH_URING
+    if (!UringInit(stream, fd) && fast_seek)
+    {
+        free(sys);
+        return VLC_EGENERIC;
+    }
+    sys->can_fastseek = sys->uring.ring != NULL && fast_seek;
+#else
+    sys->can_fastseek = false;
+#endif
 
     stream->pf_read = Read;
     stream->pf_seek = Seek;
@@ -485,6 +873,12 @@ static int Open(vlc_object_t *obj)
     if (sys->buffer == NULL)
         goto error;
 
+    void *(*entry)(void *) = Thread;
+#ifdef PREFETCH_URING
+    if (sys->uring.ring != NULL)
+        entry = UringThread;
+#endif
+
     sys->interrupt = vlc_interrupt_create();
     if (unlikely(sys->interrupt == NULL))
         goto error;
@@ -493,9 +887,7 @@ static int Open(vlc_object_t *obj)
     vlc_cond_init(&sys->wait_data);
     vlc_cond_init(&sys->wait_space);
 
-    stream->p_sys = sys;
-
-    if (vlc_clone(&sys->thread, Thread, stream, VLC_THREAD_PRIORITY_LOW))
+    if (vlc_clone(&sys->thread, entry, stream, VLC_THREAD_PRIORITY_LOW))
     {
         vlc_cond_destroy(&sys->wait_space);
         vlc_cond_destroy(&sys->wait_data);
@@ -505,11 +897,24 @@ static int Open(vlc_object_t *obj)
     }
 
     msg_Dbg(stream, "using %zu bytes buffer", sys->buffer_size);
+#ifdef PREFETCH_URING
+    if (sys->uring.ring != NULL)
+        msg_Dbg(stream, "using io_uring with up to %u reads in flight",
+                URING_DEPTH);
+#endif
     stream->pf_read = Read;
     stream->pf_control = Control;
     return VLC_SUCCESS;
 
 error:
+#ifdef PREFETCH_URING
+    if (sys->uring.ring != NULL)
+    {
+        prefetch_uring_Delete(sys->uring.ring);
+        vlc_close(sys->uring.wakeup);
+        vlc_close(sys->uring.fd);
+    }
+#endif
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -526,8 +931,15 @@ static void Close (vlc_object_t *obj)
     stream_sys_t *sys = stream->p_sys;
 
     vlc_cancel(sys->thread);
+#ifdef PREFETCH_URING
+    UringWake(sys);
+#endif
     vlc_interrupt_kill(sys->interrupt);
     vlc_join(sys->thread, NULL);
+#ifdef PREFETCH_URING
+    if (sys->uring.ring != NULL)
+        UringClean(stream);
+#endif
     vlc_interrupt_destroy(sys->interrupt);
     vlc_cond_destroy(&sys->wait_space);
     vlc_cond_destroy(&sys->wait_data);
@@ -559,4 +971,9 @@ vlc_module_begin()
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"), true)
         change_integer_range(0, UINT64_C(1) << 60)
+#ifdef PREFETCH_URING
+    add_bool("prefetch-io-uring", false, N_("Asynchronous file reads"),
+             N_("Keep several reads in flight with io_uring when the "
+                "stream is a file, including local files."), true)
+#endif
 vlc_module_end()
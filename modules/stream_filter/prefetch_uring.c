@@ -0,0 +1,269 @@
+/*****************************************************************************
+ * prefetch_uring.c: minimal io_uring wrapper for the prefetch filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include "prefetch_uring.h"
+
+struct prefetch_uring
+{
+    int fd;
+    unsigned pending; /**< Queued but not submitted requests */
+
+    void *sq_map;
+    size_t sq_map_size;
+    void *cq_map;
+    size_t cq_map_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    _Atomic uint32_t *sq_head;
+    _Atomic uint32_t *sq_tail;
+    uint32_t sq_mask;
+    uint32_t sq_entries;
+    uint32_t *sq_array;
+
+    _Atomic uint32_t *cq_head;
+    _Atomic uint32_t *cq_tail;
+    uint32_t cq_mask;
+    struct io_uring_cqe *cqes;
+};
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit,
+                              unsigned min_complete, unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                   NULL, 0);
+}
+
+/* IORING_OP_READ needs Linux 5.6, which also introduced the probe */
+static bool prefetch_uring_Probe(int fd)
+{
+    const unsigned count = IORING_OP_LAST;
+    struct io_uring_probe *probe = calloc(1, sizeof (*probe)
+                                    + count * sizeof (struct io_uring_probe_op));
+    if (unlikely(probe == NULL))
+        return false;
+
+    bool ok = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE,
+                      probe, count) == 0
+           && probe->last_op >= IORING_OP_READ
+           && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)
+           && (probe->ops[IORING_OP_ASYNC_CANCEL].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return ok;
+}
+
+struct prefetch_uring *prefetch_uring_New(unsigned entries)
+{
+    struct prefetch_uring *ring = malloc(sizeof (*ring));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof (p));
+
+    ring->fd = sys_io_uring_setup(entries, &p);
+    if (ring->fd == -1)
+    {
+        free(ring);
+        return NULL;
+    }
+    if (!prefetch_uring_Probe(ring->fd))
+    {
+        vlc_close(ring->fd);
+        free(ring);
+        errno = EOPNOTSUPP;
+        return NULL;
+    }
+    ring->pending = 0;
+    ring->sq_map_size = p.sq_off.array + p.sq_entries * sizeof (uint32_t);
+    ring->cq_map_size = p.cq_off.cqes
+                      + p.cq_entries * sizeof (struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cq_map_size > ring->sq_map_size)
+            ring->sq_map_size = ring->cq_map_size;
+        ring->cq_map_size = ring->sq_map_size;
+    }
+
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED)
+        goto error;
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cq_map = ring->sq_map;
+    else
+    {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->fd,
+                            IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED)
+        {
+            munmap(ring->sq_map, ring->sq_map_size);
+            goto error;
+        }
+    }
+
+    ring->sqes_size = p.sq_entries * sizeof (struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        if (ring->cq_map != ring->sq_map)
+            munmap(ring->cq_map, ring->cq_map_size);
+        munmap(ring->sq_map, ring->sq_map_size);
+        goto error;
+    }
+
+    char *sq = ring->sq_map, *cq = ring->cq_map;
+    ring->sq_head = (_Atomic uint32_t *)(sq + p.sq_off.head);
+    ring->sq_tail = (_Atomic uint32_t *)(sq + p.sq_off.tail);
+    ring->sq_mask = *(uint32_t *)(sq + p.sq_off.ring_mask);
+    ring->sq_entries = *(uint32_t *)(sq + p.sq_off.ring_entries);
+    ring->sq_array = (uint32_t *)(sq + p.sq_off.array);
+    ring->cq_head = (_Atomic uint32_t *)(cq + p.cq_off.head);
+    ring->cq_tail = (_Atomic uint32_t *)(cq + p.cq_off.tail);
+    ring->cq_mask = *(uint32_t *)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return ring;
+
+error:
+    vlc_close(ring->fd);
+    free(ring);
+    return NULL;
+}
+
+void prefetch_uring_Delete(struct prefetch_uring *ring)
+{
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map != ring->sq_map)
+        munmap(ring->cq_map, ring->cq_map_size);
+    munmap(ring->sq_map, ring->sq_map_size);
+    vlc_close(ring->fd);
+    free(ring);
+}
+
+static struct io_uring_sqe *prefetch_uring_GetSQE(struct prefetch_uring *ring)
+{
+    uint32_t tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(ring->sq_head, memory_order_acquire);
+
+    if (tail - head >= ring->sq_entries)
+        return NULL;
+
+    uint32_t index = tail & ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof (*sqe));
+    ring->sq_array[index] = index;
+    return sqe;
+}
+
+static void prefetch_uring_PushSQE(struct prefetch_uring *ring)
+{
+    uint32_t tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+
+    atomic_store_explicit(ring->sq_tail, tail + 1, memory_order_release);
+    ring->pending++;
+}
+
+int prefetch_uring_Read(struct prefetch_uring *ring, int fd, void *buf,
+                        size_t length, uint64_t offset, uint64_t tag)
+{
+    struct io_uring_sqe *sqe = prefetch_uring_GetSQE(ring);
+    if (sqe == NULL)
+        return -1;
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)buf;
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = tag;
+    prefetch_uring_PushSQE(ring);
+    return 0;
+}
+
+int prefetch_uring_Cancel(struct prefetch_uring *ring, uint64_t tag)
+{
+    struct io_uring_sqe *sqe = prefetch_uring_GetSQE(ring);
+    if (sqe == NULL)
+        return -1;
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = tag;
+    sqe->user_data = UINT64_MAX;
+    prefetch_uring_PushSQE(ring);
+    return 0;
+}
+
+int prefetch_uring_Submit(struct prefetch_uring *ring, unsigned min_complete)
+{
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+    int val;
+
+    do
+        val = sys_io_uring_enter(ring->fd, ring->pending, min_complete, flags);
+    while (val == -1 && errno == EINTR);
+
+    if (val >= 0)
+    {
+        ring->pending -= __MIN((unsigned)val, ring->pending);
+        return 0;
+    }
+    return -1;
+}
+
+bool prefetch_uring_Reap(struct prefetch_uring *ring, uint64_t *restrict tag,
+                         int *restrict result)
+{
+    uint32_t head = atomic_load_explicit(ring->cq_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(ring->cq_tail, memory_order_acquire);
+
+    if (head == tail)
+        return false;
+
+    const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+    *tag = cqe->user_data;
+    *result = cqe->res;
+    atomic_store_explicit(ring->cq_head, head + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+ * prefetch_uring.h: minimal io_uring wrapper for the prefetch filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PREFETCH_URING_H
+#define VLC_PREFETCH_URING_H
+
+/**
+ * Single-threaded submission and completion ring.
+ *
+ * None of these functions are thread-safe: the ring must be used by a
+ * single thread at a time.
+ */
+struct prefetch_uring;
+
+/**
+ * Creates a ring.
+ *
+ * \param entries maximum number of requests in flight
+ * \return a ring or NULL if io_uring, or its positioned reads, are not
+ *         available (errno is set)
+ */
+struct prefetch_uring *prefetch_uring_New(unsigned entries);
+void prefetch_uring_Delete(struct prefetch_uring *);
+
+/**
+ * Queues a positioned read. The request is only sent to the kernel by
+ * prefetch_uring_Submit().
+ *
+ * \return 0 on success, -1 if the submission queue is full
+ */
+int prefetch_uring_Read(struct prefetch_uring *, int fd, void *buf,
+                        size_t length, uint64_t offset, uint64_t tag);
+
+/**
+ * Queues the cancellation of the request identified by the tag.
+ * The cancellation itself completes with the tag UINT64_MAX.
+ */
+int prefetch_uring_Cancel(struct prefetch_uring *, uint64_t tag);
+
+/**
+ * Submits queued requests, and waits for at least min_complete completions.
+ */
+int prefetch_uring_Submit(struct prefetch_uring *, unsigned min_complete);
+
+/**
+ * Pops one completion.
+ *
+ * \return true if a completion was pending, false otherwise
+ */
+bool prefetch_uring_Reap(struct prefetch_uring *, uint64_t *restrict tag,
+                         int *restrict result);
+
+#endif
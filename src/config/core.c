@@ -194,7 +194,8 @@ void config_PutFloat(const char *psz_name, float f_value)
     vlc_rwlock_unlock (&config_lock);
 }
 
-ssize_t config_GetIntChoices(const char *name,
+#undef config_GetIntChoices
+ssize_t config_GetIntChoices(vlc_object_t *obj, const char *name,
                              int64_t **restrict values, char ***restrict texts)
 {
     *values = NULL;
@@ -206,7 +207,7 @@ ssize_t config_GetIntChoices(const char *name,
     size_t count = cfg->list_count;
     if (count == 0)
     {
-        if (module_Map(NULL, cfg->owner))
+        if (module_Map(obj, cfg->owner, cfg->psz_name))
         {
             errno = EIO;
             return -1;
@@ -284,7 +285,8 @@ static ssize_t config_ListModules (const char *cap, char ***restrict values,
     return n + 2;
 }
 
-ssize_t config_GetPszChoices(const char *name,
+#undef config_GetPszChoices
+ssize_t config_GetPszChoices(vlc_object_t *obj, const char *name,
                              char ***restrict values, char ***restrict texts)
 {
     *values = *texts = NULL;
@@ -312,7 +314,7 @@ ssize_t config_GetPszChoices(const char *name,
     size_t count = cfg->list_count;
     if (count == 0)
     {
-        if (module_Map(NULL, cfg->owner))
+        if (module_Map(obj, cfg->owner, cfg->psz_name))
         {
             errno = EIO;
             return -1;
@@ -343,7 +343,8 @@ static int vlc_swidth(const char *str)
     }
 }
 
-static void print_item(const module_t *m, const module_config_t *item,
+static void print_item(vlc_object_t *p_this, const module_t *m,
+                       const module_config_t *item,
                        const module_config_t **section, bool color, bool desc)
 {
 #ifndef _WIN32
@@ -382,7 +383,7 @@ static void print_item(const module_t *m, const module_config_t *item,
 
             char **ppsz_values, **ppsz_texts;
 
-            ssize_t i_count = config_GetPszChoices(item->psz_name, &ppsz_values, &ppsz_texts);
+            ssize_t i_count = config_GetPszChoices(p_this, item->psz_name, &ppsz_values, &ppsz_texts);
 
             if (i_count > 0)
             {
@@ -426,7 +427,7 @@ static void print_item(const module_t *m, const module_config_t *item,
             int64_t *pi_values;
             char **ppsz_texts;
 
-            ssize_t i_count = config_GetIntChoices(item->psz_name, &pi_values, &ppsz_texts);
+            ssize_t i_count = config_GetIntChoices(p_this, item->psz_name, &pi_values, &ppsz_texts);
 
             if (i_count > 0)
             {
@@ -627,7 +628,7 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
             if (item->b_removed)
                 continue; /* Skip removed options */
 
-            print_item(m, item, &section, color, desc);
+            print_item(p_this, m, item, &section, color, desc);
         }
     }
 
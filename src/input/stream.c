@@ -122,7 +122,7 @@ void stream_CommonDelete(stream_t *s)
     if (priv->peek != NULL)
         block_Release(priv->peek);
     if (priv->block != NULL)
-        block_Release(priv->block);
+        block_ChainRelease(priv->block);
 
     free(s->psz_url);
     vlc_object_release(s);
@@ -382,6 +382,14 @@ static ssize_t vlc_stream_CopyBlock(block_t **restrict pp,
 {
     block_t *block = *pp;
 
+    /* Skip empty blocks left in a chain */
+    while (block != NULL && block->i_buffer == 0)
+    {
+        *pp = block->p_next;
+        block_Release(block);
+        block = *pp;
+    }
+
     if (block == NULL)
         return -1;
 
@@ -396,8 +404,8 @@ static ssize_t vlc_stream_CopyBlock(block_t **restrict pp,
 
     if (block->i_buffer == 0)
     {
+        *pp = block->p_next;
         block_Release(block);
-        *pp = NULL;
     }
 
     return likely(len > 0) ? (ssize_t)len : -1;
@@ -502,6 +510,12 @@ ssize_t vlc_stream_Peek(stream_t *s, const uint8_t **restrict bufp, size_t len)
         peek = priv->block;
         priv->peek = peek;
         priv->block = NULL;
+
+        if (peek != NULL)
+        {   /* Only peek into the first block of a chain */
+            priv->block = peek->p_next;
+            peek->p_next = NULL;
+        }
     }
 
     if (peek == NULL)
@@ -590,7 +604,15 @@ block_t *vlc_stream_ReadBlock(stream_t *s)
     }
 
     if (block != NULL)
+    {
+        if (block->p_next != NULL)
+        {   /* Return one block at a time, keep the rest of the chain */
+            assert(priv->block == NULL);
+            priv->block = block->p_next;
+            block->p_next = NULL;
+        }
         priv->offset += block->i_buffer;
+    }
 
     return block;
 }
@@ -659,7 +681,7 @@ int vlc_stream_Seek(stream_t *s, uint64_t offset)
 
     if (priv->block != NULL)
     {
-        block_Release(priv->block);
+        block_ChainRelease(priv->block);
         priv->block = NULL;
     }
 
@@ -694,7 +716,7 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
 
             if (priv->block != NULL)
             {
-                block_Release(priv->block);
+                block_ChainRelease(priv->block);
                 priv->block = NULL;
             }
 
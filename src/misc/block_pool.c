@@ -0,0 +1,188 @@
+/*****************************************************************************
+ * block_pool.c: fixed-size block pool
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+/* Same layout as block_Alloc() */
+#define BLOCK_ALIGN        32
+#define BLOCK_PADDING      32
+
+struct block_pool
+{
+    size_t size; /**< Payload size */
+    size_t chunk_size; /**< Allocation size of each block */
+
+    block_t *free; /**< Owner-private free list */
+    _Atomic(block_t *) returned; /**< Blocks released by any thread */
+    atomic_size_t refs; /**< Owner reference + one per allocated block */
+
+    uint64_t requests;
+    uint64_t recycled;
+    size_t count;
+};
+
+struct block_pool_chunk
+{
+    block_t self;
+    block_pool_t *pool;
+};
+
+/* Marks the returned list of a released pool: blocks are then freed as they
+ * are released instead of being recycled. */
+static block_t dead_marker;
+#define BLOCK_POOL_DEAD (&dead_marker)
+
+static void block_pool_Unref(block_pool_t *pool)
+{
+    if (atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_acq_rel) == 1)
+        free(pool);
+}
+
+static void block_pool_FreeList(block_pool_t *pool, block_t *list)
+{
+    while (list != NULL)
+    {
+        block_t *next = list->p_next;
+
+        free(container_of(list, struct block_pool_chunk, self));
+        block_pool_Unref(pool);
+        list = next;
+    }
+}
+
+static void block_pool_ReleaseBlock(block_t *block)
+{
+    struct block_pool_chunk *chunk =
+        container_of(block, struct block_pool_chunk, self);
+    block_pool_t *pool = chunk->pool;
+    block_t *head = atomic_load_explicit(&pool->returned,
+                                         memory_order_relaxed);
+
+    do
+    {
+        if (head == BLOCK_POOL_DEAD)
+        {   /* The pool owner is gone */
+            free(chunk);
+            block_pool_Unref(pool);
+            return;
+        }
+        block->p_next = head;
+    }
+    while (!atomic_compare_exchange_weak_explicit(&pool->returned, &head,
+                                                  block,
+                                                  memory_order_release,
+                                                  memory_order_relaxed));
+}
+
+static const struct vlc_block_callbacks block_pool_cbs =
+{
+    block_pool_ReleaseBlock,
+};
+
+block_pool_t *block_PoolNew(size_t size)
+{
+    if (unlikely(size >> 27))
+    {
+        errno = ENOBUFS;
+        return NULL;
+    }
+
+    block_pool_t *pool = malloc(sizeof (*pool));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    pool->size = size;
+    pool->chunk_size = sizeof (struct block_pool_chunk) + BLOCK_ALIGN
+                     + (2 * BLOCK_PADDING) + size;
+    pool->free = NULL;
+    atomic_init(&pool->returned, NULL);
+    atomic_init(&pool->refs, 1);
+    pool->requests = 0;
+    pool->recycled = 0;
+    pool->count = 0;
+    return pool;
+}
+
+void block_PoolRelease(block_pool_t *pool)
+{
+    block_pool_FreeList(pool, pool->free);
+    pool->free = NULL;
+    block_pool_FreeList(pool, atomic_exchange_explicit(&pool->returned,
+                                                       BLOCK_POOL_DEAD,
+                                                       memory_order_acquire));
+    block_pool_Unref(pool);
+}
+
+block_t *block_PoolAlloc(block_pool_t *pool)
+{
+    struct block_pool_chunk *chunk;
+    block_t *block = pool->free;
+
+    pool->requests++;
+
+    if (block == NULL)
+        block = atomic_exchange_explicit(&pool->returned, NULL,
+                                         memory_order_acquire);
+
+    if (block != NULL)
+    {
+        assert(block != BLOCK_POOL_DEAD);
+        pool->free = block->p_next;
+        pool->recycled++;
+        chunk = container_of(block, struct block_pool_chunk, self);
+    }
+    else
+    {
+        chunk = malloc(pool->chunk_size);
+        if (unlikely(chunk == NULL))
+            return NULL;
+
+        chunk->pool = pool;
+        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+        pool->count++;
+        block = &chunk->self;
+    }
+
+    block_Init(block, &block_pool_cbs, chunk + 1,
+               pool->chunk_size - sizeof (*chunk));
+    block->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
+    block->p_buffer = (void *)(((uintptr_t)block->p_buffer)
+                               & ~(BLOCK_ALIGN - 1));
+    block->i_buffer = pool->size;
+    return block;
+}
+
+void block_PoolGetStats(const block_pool_t *pool,
+                        struct block_pool_stats *restrict stats)
+{
+    stats->requests = pool->requests;
+    stats->recycled = pool->recycled;
+    stats->count = pool->count;
+}
@@ -107,26 +107,30 @@ vlc_plugin_t *vlc_plugins = NULL;
 static int vlc_module_store(module_t *mod)
 {
     const char *name = module_get_capability(mod);
-    vlc_modcap_t *cap = malloc(sizeof (*cap));
-    if (unlikely(cap == NULL))
-        return -1;
+    vlc_modcap_t key = { .name = (char *)name }, *cap, **cp;
 
-    cap->name = strdup(name);
-    cap->modv = NULL;
-    cap->modc = 0;
+    /* Most capabilities are shared by many modules: look up first */
+    cp = tfind(&key, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp == NULL)
+    {
+        cap = malloc(sizeof (*cap));
+        if (unlikely(cap == NULL))
+            return -1;
 
-    if (unlikely(cap->name == NULL))
-        goto error;
+        cap->name = strdup(name);
+        cap->modv = NULL;
+        cap->modc = 0;
 
-    vlc_modcap_t **cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
-    if (unlikely(cp == NULL))
-        goto error;
+        if (unlikely(cap->name == NULL))
+            goto error;
 
-    if (*cp != cap)
-    {
-        vlc_modcap_free(cap);
-        cap = *cp;
+        cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
+        if (unlikely(cp == NULL))
+            goto error;
+        assert(*cp == cap);
     }
+    else
+        cap = *cp;
 
     module_t **modv = realloc(cap->modv, sizeof (*modv) * (cap->modc + 1));
     if (unlikely(modv == NULL))
@@ -286,6 +290,7 @@ static int AllocatePluginFile (module_bank_t *bank, const char *abspath,
 
     if (plugin == NULL)
     {
+        msg_Dbg(bank->obj, "loading plug-in %s to describe it", abspath);
         plugin = module_InitDynamic(bank->obj, abspath, true);
 
         if (plugin != NULL)
@@ -491,9 +496,10 @@ static void AllocateAllPlugins (vlc_object_t *p_this)
  *
  * \note This function is thread-safe but not re-entrant.
  *
+ * \param reason capability or option the plug-in is needed for (for tracing)
  * \return 0 on success, -1 on failure
  */
-int module_Map(vlc_object_t *obj, vlc_plugin_t *plugin)
+int module_Map(vlc_object_t *obj, vlc_plugin_t *plugin, const char *reason)
 {
     static vlc_mutex_t lock = VLC_STATIC_MUTEX;
 
@@ -531,11 +537,15 @@ int module_Map(vlc_object_t *obj, vlc_plugin_t *plugin)
 
         atomic_store_explicit(&plugin->handle, (uintptr_t)handle,
                               memory_order_release);
+        handle = NULL;
     }
-    else /* Another thread won the race to load the plugin */
-        vlc_dlclose(handle);
     vlc_mutex_unlock(&lock);
 
+    if (handle != NULL) /* Another thread won the race to load the plugin */
+        vlc_dlclose(handle);
+    else
+        msg_Dbg(obj, "loaded plug-in %s for %s", plugin->abspath, reason);
+
     return 0;
 error:
     vlc_dlclose(handle);
@@ -559,9 +569,9 @@ static void module_Unmap(vlc_plugin_t *plugin)
         vlc_dlclose(handle);
 }
 #else
-int module_Map(vlc_object_t *obj, vlc_plugin_t *plugin)
+int module_Map(vlc_object_t *obj, vlc_plugin_t *plugin, const char *reason)
 {
-    (void) obj; (void) plugin;
+    (void) obj; (void) plugin; (void) reason;
     return 0;
 }
 
@@ -678,6 +688,16 @@ void module_LoadPlugins(vlc_object_t *obj)
     module_t **list = module_list_get (&count);
     module_list_free (list);
     msg_Dbg (obj, "plug-ins loaded: %zu modules", count);
+#ifdef HAVE_DYNAMIC_PLUGINS
+    /* Plug-ins are mapped when first used: anything mapped at this point was
+     * either not in the plugins cache or requested during initialization. */
+    count = 0;
+    for (vlc_plugin_t *lib = vlc_plugins; lib != NULL; lib = lib->next)
+        if (lib->abspath != NULL
+         && atomic_load_explicit(&lib->handle, memory_order_relaxed))
+            count++;
+    msg_Dbg (obj, "plug-ins mapped: %zu", count);
+#endif
 }
 
 /**
@@ -36,6 +36,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <assert.h>
+#ifdef HAVE_SEARCH_H
+# include <search.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -57,13 +60,91 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 35
+#define CACHE_SUBVERSION_NUM 36
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
 /* Magic for the cache filename */
 #define CACHE_STRING "cache "PACKAGE_NAME" "PACKAGE_VERSION
 
+/*
+ * Cache file layout
+ *
+ * The header (magic, distribution version, sub-version and header marker) is
+ * followed by an index of tables. Each table is an array of fixed-size records
+ * at an aligned offset from the start of the file. Records refer to each other
+ * by index, and to strings by offset within a pool of nul-terminated strings,
+ * where each distinct string is stored once. Offset zero stands for NULL.
+ *
+ * The file is mapped in memory and used in place: loading only checks bounds
+ * and points the run-time plugin descriptors at the mapped strings and
+ * integer lists. Nothing is parsed or copied, except for the default values of
+ * string items, which are mutable.
+ */
+struct vlc_cache_table
+{
+    uint32_t offset; /**< Offset from the start of the file */
+    uint32_t count; /**< Number of records (bytes for the string pool) */
+};
+
+struct vlc_cache_index
+{
+    struct vlc_cache_table strings; /**< String pool */
+    struct vlc_cache_table refs; /**< String references (uint32_t) */
+    struct vlc_cache_table ints; /**< Integer choices (int) */
+    struct vlc_cache_table configs; /**< struct vlc_cache_config */
+    struct vlc_cache_table modules; /**< struct vlc_cache_module */
+    struct vlc_cache_table plugins; /**< struct vlc_cache_plugin */
+};
+
+struct vlc_cache_config
+{
+    module_value_t orig; /**< Default value, or string reference in orig.i */
+    module_value_t min;
+    module_value_t max;
+    uint32_t type;
+    uint32_t name;
+    uint32_t text;
+    uint32_t longtext;
+    uint32_t list_cb_name;
+    uint32_t list; /**< First choice (string reference or integer) */
+    uint32_t list_text; /**< First choice name reference */
+    uint16_t list_count;
+    uint8_t i_type;
+    char i_short;
+    uint8_t flags;
+};
+
+#define CACHE_CONFIG_INTERNAL   0x01
+#define CACHE_CONFIG_UNSAVEABLE 0x02
+#define CACHE_CONFIG_SAFE       0x04
+#define CACHE_CONFIG_REMOVED    0x08
+
+struct vlc_cache_module
+{
+    uint32_t shortname;
+    uint32_t longname;
+    uint32_t help;
+    uint32_t capability;
+    uint32_t activate;
+    uint32_t deactivate;
+    uint32_t shortcuts; /**< First shortcut reference */
+    uint32_t shortcuts_count;
+    int32_t score;
+};
+
+struct vlc_cache_plugin
+{
+    int64_t mtime;
+    uint64_t size;
+    uint32_t path;
+    uint32_t textdomain;
+    uint32_t modules; /**< First module */
+    uint32_t modules_count;
+    uint32_t configs; /**< First configuration item */
+    uint32_t configs_count;
+    uint8_t unloadable;
+};
 
 static int vlc_cache_load_immediate(void *out, block_t *in, size_t size)
 {
@@ -76,201 +157,205 @@ static int vlc_cache_load_immediate(void *out, block_t *in, size_t size)
     return 0;
 }
 
-static int vlc_cache_load_bool(bool *out, block_t *in)
+/** Mapped cache file tables, bounds-checked */
+struct vlc_cache_view
 {
-    unsigned char b;
-
-    if (vlc_cache_load_immediate(&b, in, 1) || b > 1)
-        return -1;
-
-    *out = b;
-    return 0;
+    const char *strings;
+    size_t strings_size;
+    const uint32_t *refs;
+    size_t refs_count;
+    const int *ints;
+    size_t ints_count;
+    const struct vlc_cache_config *configs;
+    size_t configs_count;
+    const struct vlc_cache_module *modules;
+    size_t modules_count;
+    const struct vlc_cache_plugin *plugins;
+    size_t plugins_count;
+};
+
+static const void *vlc_cache_load_table(const uint8_t *base, size_t length,
+                                        const struct vlc_cache_table *table,
+                                        size_t size, size_t align)
+{
+    if (table->count == 0)
+        return base; /* never dereferenced */
+    if (table->offset > length
+     || ((uintptr_t)(base + table->offset) % align) != 0
+     || (length - table->offset) / size < table->count)
+        return NULL;
+    return base + table->offset;
 }
 
-static int vlc_cache_load_array(const void **p, size_t size, size_t n,
-                                block_t *file)
+#define LOAD_TABLE(v, t) \
+    do \
+    { \
+        (v)->t = vlc_cache_load_table(base, length, &index.t, \
+                                      sizeof (*(v)->t), alignof (*(v)->t)); \
+        if ((v)->t == NULL) \
+            return -1; \
+        (v)->t##_count = index.t.count; \
+    } while (0)
+
+static int vlc_cache_load_view(struct vlc_cache_view *view,
+                               const uint8_t *base, size_t length,
+                               block_t *file)
 {
-    if (n == 0)
-    {
-        *p = NULL;
-        return 0;
-    }
+    struct vlc_cache_index index;
 
-    if (unlikely(size * n < size))
+    size_t skip = (-(uintptr_t)file->p_buffer) % alignof (index);
+    if (file->i_buffer < skip)
         return -1;
+    file->p_buffer += skip;
+    file->i_buffer -= skip;
 
-    size *= n;
+    if (vlc_cache_load_immediate(&index, file, sizeof (index)))
+        return -1;
 
-    if (file->i_buffer < size)
+    /* The pool starts with the empty string, and ends with a nul, so that
+     * any offset within it is a valid nul-terminated string. */
+    view->strings = vlc_cache_load_table(base, length, &index.strings, 1, 1);
+    view->strings_size = index.strings.count;
+    if (view->strings == NULL || view->strings_size == 0
+     || view->strings[0] != '\0'
+     || view->strings[view->strings_size - 1] != '\0')
         return -1;
 
-    *p = file->p_buffer;
-    file->p_buffer += size;
-    file->i_buffer -= size;
+    LOAD_TABLE(view, refs);
+    LOAD_TABLE(view, ints);
+    LOAD_TABLE(view, configs);
+    LOAD_TABLE(view, modules);
+    LOAD_TABLE(view, plugins);
     return 0;
 }
 
-static int vlc_cache_load_string(const char **restrict p, block_t *file)
+static bool vlc_cache_range(uint32_t first, uint32_t count, size_t total)
 {
-    uint16_t size;
-
-    if (vlc_cache_load_immediate(&size, file, sizeof (size)) || size > 16384)
-        return -1;
-
-    if (size == 0)
-    {
-        *p = NULL;
-        return 0;
-    }
-
-    const char *str = (char *)file->p_buffer;
+    return first <= total && count <= total - first;
+}
 
-    if (file->i_buffer < size || str[size - 1] != '\0')
+static int vlc_cache_load_string(const struct vlc_cache_view *view,
+                                 uint32_t ref, const char **restrict p)
+{
+    if (ref >= view->strings_size)
         return -1;
 
-    file->p_buffer += size;
-    file->i_buffer -= size;
-    *p = str;
+    *p = (ref != 0) ? view->strings + ref : NULL;
     return 0;
 }
 
-static int vlc_cache_load_align(size_t align, block_t *file)
+/* Loads string references, where NULL entries become empty strings */
+static int vlc_cache_load_strings(const struct vlc_cache_view *view,
+                                  uint32_t first, size_t count,
+                                  const char ***restrict p)
 {
-    assert(align > 0);
-
-    size_t skip = (-(uintptr_t)file->p_buffer) % align;
-    if (skip == 0)
-        return 0;
-
-    assert(skip < align);
+    if (!vlc_cache_range(first, count, view->refs_count))
+        return -1;
 
-    if (file->i_buffer < skip)
+    const char **tab = vlc_alloc(count, sizeof (*tab));
+    if (unlikely(tab == NULL))
         return -1;
 
-    file->p_buffer += skip;
-    file->i_buffer -= skip;
-    assert((((uintptr_t)file->p_buffer) % align) == 0);
+    for (size_t i = 0; i < count; i++)
+        if (vlc_cache_load_string(view, view->refs[first + i], &tab[i]))
+        {
+            free(tab);
+            return -1;
+        }
+        else if (tab[i] == NULL)
+            tab[i] = view->strings;
+
+    *p = tab;
     return 0;
 }
 
-#define LOAD_IMMEDIATE(a) \
-    if (vlc_cache_load_immediate(&(a), file, sizeof (a))) \
-        goto error
-#define LOAD_FLAG(a) \
-    do \
-    { \
-        bool b; \
-        if (vlc_cache_load_bool(&b, file)) \
-            goto error; \
-        (a) = b; \
-    } while (0)
-#define LOAD_ARRAY(a,n) \
-    do \
-    { \
-        const void *base; \
-        if (vlc_cache_load_array(&base, sizeof (*(a)), (n), file)) \
-            goto error; \
-        (a) = base; \
-    } while (0)
-#define LOAD_STRING(a) \
-    if (vlc_cache_load_string(&(a), file)) \
-        goto error
-#define LOAD_ALIGNOF(t) \
-    if (vlc_cache_load_align(alignof(t), file)) \
+#define LOAD_STRING(a, ref) \
+    if (vlc_cache_load_string(view, (ref), &(a))) \
         goto error
 
-static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
+static int vlc_cache_load_config(module_config_t *cfg,
+                                 const struct vlc_cache_view *view,
+                                 const struct vlc_cache_config *rec)
 {
-    LOAD_IMMEDIATE (cfg->i_type);
-    LOAD_IMMEDIATE (cfg->i_short);
-    LOAD_FLAG (cfg->b_internal);
-    LOAD_FLAG (cfg->b_unsaveable);
-    LOAD_FLAG (cfg->b_safe);
-    LOAD_FLAG (cfg->b_removed);
-    LOAD_STRING (cfg->psz_type);
-    LOAD_STRING (cfg->psz_name);
-    LOAD_STRING (cfg->psz_text);
-    LOAD_STRING (cfg->psz_longtext);
-    LOAD_IMMEDIATE (cfg->list_count);
+    cfg->i_type = rec->i_type;
+    cfg->i_short = rec->i_short;
+    cfg->b_internal = (rec->flags & CACHE_CONFIG_INTERNAL) != 0;
+    cfg->b_unsaveable = (rec->flags & CACHE_CONFIG_UNSAVEABLE) != 0;
+    cfg->b_safe = (rec->flags & CACHE_CONFIG_SAFE) != 0;
+    cfg->b_removed = (rec->flags & CACHE_CONFIG_REMOVED) != 0;
+    LOAD_STRING(cfg->psz_type, rec->type);
+    LOAD_STRING(cfg->psz_name, rec->name);
+    LOAD_STRING(cfg->psz_text, rec->text);
+    LOAD_STRING(cfg->psz_longtext, rec->longtext);
+    LOAD_STRING(cfg->list_cb_name, rec->list_cb_name);
+    cfg->list_count = rec->list_count;
 
     if (IsConfigStringType (cfg->i_type))
     {
         const char *psz;
-        LOAD_STRING(psz);
+
+        if (rec->orig.i < 0 || rec->orig.i > UINT32_MAX)
+            goto error;
+        LOAD_STRING(psz, rec->orig.i);
         cfg->orig.psz = (char *)psz;
-        cfg->value.psz = (psz != NULL) ? strdup (cfg->orig.psz) : NULL;
 
-        if (cfg->list_count)
-            cfg->list.psz = xmalloc (cfg->list_count * sizeof (char *));
-        else
-            LOAD_STRING(cfg->list_cb_name);
-        for (unsigned i = 0; i < cfg->list_count; i++)
+        if (cfg->list_count
+         && vlc_cache_load_strings(view, rec->list, cfg->list_count,
+                                   &cfg->list.psz))
+            goto error;
+
+        if (psz != NULL)
         {
-            LOAD_STRING (cfg->list.psz[i]);
-            if (cfg->list.psz[i] == NULL /* NULL -> empty string */
-             && (cfg->list.psz[i] = calloc (1, 1)) == NULL)
+            cfg->value.psz = strdup(psz);
+            if (unlikely(cfg->value.psz == NULL))
                 goto error;
         }
     }
     else
     {
-        LOAD_IMMEDIATE (cfg->orig);
-        LOAD_IMMEDIATE (cfg->min);
-        LOAD_IMMEDIATE (cfg->max);
+        cfg->orig = rec->orig;
+        cfg->min = rec->min;
+        cfg->max = rec->max;
         cfg->value = cfg->orig;
 
+        if (!vlc_cache_range(rec->list, cfg->list_count, view->ints_count))
+            goto error;
         if (cfg->list_count)
-        {
-            LOAD_ALIGNOF(*cfg->list.i);
-        }
-        else
-            LOAD_STRING(cfg->list_cb_name);
-
-        LOAD_ARRAY(cfg->list.i, cfg->list_count);
+            cfg->list.i = view->ints + rec->list;
     }
 
-    cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
-    for (unsigned i = 0; i < cfg->list_count; i++)
-    {
-        LOAD_STRING (cfg->list_text[i]);
-        if (cfg->list_text[i] == NULL /* NULL -> empty string */
-         && (cfg->list_text[i] = calloc (1, 1)) == NULL)
-            goto error;
-    }
+    if (cfg->list_count
+     && vlc_cache_load_strings(view, rec->list_text, cfg->list_count,
+                               &cfg->list_text))
+        goto error;
 
     return 0;
 error:
-    return -1; /* FIXME: leaks */
+    return -1;
 }
 
-static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
+static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin,
+                                        const struct vlc_cache_view *view,
+                                        const struct vlc_cache_plugin *rec)
 {
-    uint16_t lines;
-
-    /* Calculate the structure length */
-    LOAD_IMMEDIATE (lines);
+    if (rec->configs_count == 0)
+        return 0;
+    if (!vlc_cache_range(rec->configs, rec->configs_count,
+                         view->configs_count))
+        return -1;
 
-    /* Allocate memory */
-    if (lines)
-    {
-        plugin->conf.items = calloc(sizeof (module_config_t), lines);
-        if (unlikely(plugin->conf.items == NULL))
-        {
-            plugin->conf.size = 0;
-            return -1;
-        }
-    }
-    else
-        plugin->conf.items = NULL;
+    plugin->conf.items = calloc(rec->configs_count, sizeof (module_config_t));
+    if (unlikely(plugin->conf.items == NULL))
+        return -1;
 
-    plugin->conf.size = lines;
+    /* Items are zeroed, so the whole table can be freed at any point */
+    plugin->conf.size = rec->configs_count;
 
-    /* Do the duplication job */
-    for (size_t i = 0; i < lines; i++)
+    for (size_t i = 0; i < plugin->conf.size; i++)
     {
         module_config_t *item = plugin->conf.items + i;
 
-        if (vlc_cache_load_config(item, file))
+        if (vlc_cache_load_config(item, view, view->configs + rec->configs + i))
             return -1;
 
         if (CONFIG_ITEM(item->i_type))
@@ -283,70 +368,67 @@ static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
     }
 
     return 0;
-error:
-    return -1; /* FIXME: leaks */
 }
 
-static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
+static int vlc_cache_load_module(vlc_plugin_t *plugin,
+                                 const struct vlc_cache_view *view,
+                                 const struct vlc_cache_module *rec)
 {
     module_t *module = vlc_module_create(plugin);
     if (unlikely(module == NULL))
         return -1;
 
-    LOAD_STRING(module->psz_shortname);
-    LOAD_STRING(module->psz_longname);
-    LOAD_STRING(module->psz_help);
-
-    LOAD_IMMEDIATE(module->i_shortcuts);
-    if (module->i_shortcuts > MODULE_SHORTCUT_MAX)
+    LOAD_STRING(module->psz_shortname, rec->shortname);
+    LOAD_STRING(module->psz_longname, rec->longname);
+    LOAD_STRING(module->psz_help, rec->help);
+    LOAD_STRING(module->activate_name, rec->activate);
+    LOAD_STRING(module->deactivate_name, rec->deactivate);
+    LOAD_STRING(module->psz_capability, rec->capability);
+    module->i_score = rec->score;
+
+    if (rec->shortcuts_count > MODULE_SHORTCUT_MAX
+     || vlc_cache_load_strings(view, rec->shortcuts, rec->shortcuts_count,
+                               &module->pp_shortcuts))
         goto error;
-    else
-    {
-        module->pp_shortcuts =
-            xmalloc (sizeof (*module->pp_shortcuts) * module->i_shortcuts);
-        for (unsigned j = 0; j < module->i_shortcuts; j++)
-            LOAD_STRING(module->pp_shortcuts[j]);
-    }
-
-    LOAD_STRING(module->activate_name);
-    LOAD_STRING(module->deactivate_name);
-    LOAD_STRING(module->psz_capability);
-    LOAD_IMMEDIATE(module->i_score);
+    module->i_shortcuts = rec->shortcuts_count;
     return 0;
 error:
     return -1;
 }
 
-static vlc_plugin_t *vlc_cache_load_plugin(block_t *file)
+static vlc_plugin_t *vlc_cache_load_plugin(const struct vlc_cache_view *view,
+                                           const struct vlc_cache_plugin *rec)
 {
     vlc_plugin_t *plugin = vlc_plugin_create();
     if (unlikely(plugin == NULL))
         return NULL;
 
-    uint32_t modules;
-    LOAD_IMMEDIATE(modules);
+    if (!vlc_cache_range(rec->modules, rec->modules_count,
+                         view->modules_count))
+        goto error;
 
-    for (size_t i = 0; i < modules; i++)
-        if (vlc_cache_load_module(plugin, file))
+    for (size_t i = 0; i < rec->modules_count; i++)
+        if (vlc_cache_load_module(plugin, view,
+                                  view->modules + rec->modules + i))
             goto error;
 
-    if (vlc_cache_load_plugin_config(plugin, file))
+    if (vlc_cache_load_plugin_config(plugin, view, rec))
         goto error;
 
-    LOAD_STRING(plugin->textdomain);
+    LOAD_STRING(plugin->textdomain, rec->textdomain);
 
     const char *path;
-    LOAD_STRING(path);
-    if (path == NULL)
+    LOAD_STRING(path, rec->path);
+    if (path == NULL || rec->unloadable > 1)
         goto error;
 
     plugin->path = strdup(path);
     if (unlikely(plugin->path == NULL))
         goto error;
 
-    LOAD_FLAG(plugin->unloadable);
-    LOAD_IMMEDIATE(plugin->mtime);
-    LOAD_IMMEDIATE(plugin->size);
+    plugin->unloadable = rec->unloadable;
+    plugin->mtime = rec->mtime;
+    plugin->size = rec->size;
 
     if (plugin->textdomain != NULL)
         vlc_bindtextdomain(plugin->textdomain);
@@ -386,6 +468,9 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
     if (file == NULL)
         return NULL;
 
+    const uint8_t *base = file->p_buffer;
+    const size_t length = file->i_buffer;
+
     /* Check the file is a plugins cache */
     char cachestr[sizeof (CACHE_STRING) - 1];
 
@@ -437,11 +522,15 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return NULL;
     }
 
+    struct vlc_cache_view view;
     vlc_plugin_t *cache = NULL;
 
-    while (file->i_buffer > 0)
+    if (vlc_cache_load_view(&view, base, length, file))
+        goto error;
+
+    for (size_t i = 0; i < view.plugins_count; i++)
     {
-        vlc_plugin_t *plugin = vlc_cache_load_plugin(file);
+        vlc_plugin_t *plugin = vlc_cache_load_plugin(&view, view.plugins + i);
         if (plugin == NULL)
             goto error;
 
@@ -464,137 +553,304 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
 error:
     msg_Warn( p_this, "plugins cache not loaded (corrupted)" );
 
-    /* TODO: cleanup */
+    while (cache != NULL)
+    {
+        vlc_plugin_t *next = cache->next;
+        vlc_plugin_destroy(cache);
+        cache = next;
+    }
     block_Release(file);
     return NULL;
 }
 
-#define SAVE_IMMEDIATE( a ) \
-    if (fwrite (&(a), sizeof(a), 1, file) != 1) \
-        goto error
-#define SAVE_FLAG(a) \
-    do { \
-        char b = (a); \
-        SAVE_IMMEDIATE(b); \
-    } while (0)
+/** Cache file tables being built */
+struct vlc_cache_writer
+{
+    void *strings_tree; /**< Interned strings */
+    char *strings;
+    size_t strings_count;
+    size_t strings_alloc;
+    uint32_t *refs;
+    size_t refs_count;
+    size_t refs_alloc;
+    int *ints;
+    size_t ints_count;
+    size_t ints_alloc;
+    struct vlc_cache_config *configs;
+    size_t configs_count;
+    size_t configs_alloc;
+    struct vlc_cache_module *modules;
+    size_t modules_count;
+    size_t modules_alloc;
+    struct vlc_cache_plugin *plugins;
+    size_t plugins_count;
+    size_t plugins_alloc;
+};
+
+struct vlc_cache_string
+{
+    const char *str;
+    uint32_t ref;
+};
 
-static int CacheSaveString (FILE *file, const char *str)
+static int vlc_cache_string_cmp(const void *a, const void *b)
 {
-    uint16_t size = (str != NULL) ? (strlen (str) + 1) : 0;
+    const struct vlc_cache_string *sa = a, *sb = b;
+    return strcmp(sa->str, sb->str);
+}
+
+/* Grows a table to hold at least the given number of records */
+static void *CacheSaveGrow(void *tab, size_t *allocp, size_t needed,
+                           size_t size)
+{
+    if (tab != NULL && needed <= *allocp)
+        return tab;
 
-    SAVE_IMMEDIATE (size);
-    if (size != 0 && fwrite(str, 1, size, file) != size)
+    size_t alloc = *allocp ? *allocp : 64;
+    while (alloc < needed)
+        alloc *= 2;
+
+    void *ntab = (needed <= UINT32_MAX) ? realloc(tab, alloc * size) : NULL;
+    if (unlikely(ntab == NULL))
     {
-error:
-        return -1;
+        free(tab);
+        alloc = 0;
     }
-    return 0;
+    *allocp = alloc;
+    return ntab;
 }
 
-#define SAVE_STRING( a ) \
-    if (CacheSaveString (file, (a))) \
-        goto error
+/* Reserves room for n more records at the end of a table */
+#define SAVE_RESERVE(w, t, n) \
+    ((((w)->t = CacheSaveGrow((w)->t, &(w)->t##_alloc, \
+                              (w)->t##_count + (n), sizeof (*(w)->t)))) \
+        ? (w)->t + (w)->t##_count : NULL)
 
-static int CacheSaveAlign(FILE *file, size_t align)
+/* Interns a string in the pool, returns its reference (0 for NULL) */
+static int CacheSaveString(struct vlc_cache_writer *w, const char *str,
+                           uint32_t *restrict ref)
 {
-    assert(align > 0);
+    if (str == NULL)
+    {
+        *ref = 0;
+        return 0;
+    }
 
-    size_t skip = (-ftell(file)) % align;
-    if (skip == 0)
+    struct vlc_cache_string key = { str, 0 }, **sp;
+
+    sp = tfind(&key, &w->strings_tree, vlc_cache_string_cmp);
+    if (sp != NULL)
+    {
+        *ref = (*sp)->ref;
         return 0;
+    }
 
-    assert(((ftell(file) + skip) % align) == 0);
-    return fseek(file, skip, SEEK_CUR);
+    size_t len = strlen(str) + 1;
+    char *p = SAVE_RESERVE(w, strings, len);
+    struct vlc_cache_string *s = malloc(sizeof (*s));
+    if (unlikely(p == NULL || s == NULL))
+    {
+        free(s);
+        return -1;
+    }
+
+    s->str = str;
+    s->ref = w->strings_count;
+    sp = tsearch(s, &w->strings_tree, vlc_cache_string_cmp);
+    if (unlikely(sp == NULL))
+    {
+        free(s);
+        return -1;
+    }
+
+    memcpy(p, str, len);
+    w->strings_count += len;
+    *ref = s->ref;
+    return 0;
 }
 
-#define SAVE_ALIGNOF(t) \
-    if (CacheSaveAlign(file, alignof (t))) \
+#define SAVE_STRING(a, ref) \
+    if (CacheSaveString(w, (a), &(ref))) \
         goto error
 
-static int CacheSaveConfig (FILE *file, const module_config_t *cfg)
+static int CacheSaveStrings(struct vlc_cache_writer *w,
+                            const char *const *tab, size_t n,
+                            uint32_t *restrict first)
+{
+    uint32_t *refs = SAVE_RESERVE(w, refs, n);
+    if (unlikely(refs == NULL))
+        return -1;
+
+    *first = w->refs_count;
+    for (size_t i = 0; i < n; i++)
+        if (CacheSaveString(w, tab[i], &refs[i]))
+            return -1;
+
+    w->refs_count += n;
+    return 0;
+}
+
+static int CacheSaveConfig(struct vlc_cache_writer *w,
+                           const module_config_t *cfg)
 {
-    SAVE_IMMEDIATE (cfg->i_type);
-    SAVE_IMMEDIATE (cfg->i_short);
-    SAVE_FLAG (cfg->b_internal);
-    SAVE_FLAG (cfg->b_unsaveable);
-    SAVE_FLAG (cfg->b_safe);
-    SAVE_FLAG (cfg->b_removed);
-    SAVE_STRING (cfg->psz_type);
-    SAVE_STRING (cfg->psz_name);
-    SAVE_STRING (cfg->psz_text);
-    SAVE_STRING (cfg->psz_longtext);
-    SAVE_IMMEDIATE (cfg->list_count);
+    struct vlc_cache_config *rec = SAVE_RESERVE(w, configs, 1);
+    if (unlikely(rec == NULL))
+        goto error;
+
+    memset(rec, 0, sizeof (*rec));
+    rec->i_type = cfg->i_type;
+    rec->i_short = cfg->i_short;
+    rec->flags = (cfg->b_internal ? CACHE_CONFIG_INTERNAL : 0)
+               | (cfg->b_unsaveable ? CACHE_CONFIG_UNSAVEABLE : 0)
+               | (cfg->b_safe ? CACHE_CONFIG_SAFE : 0)
+               | (cfg->b_removed ? CACHE_CONFIG_REMOVED : 0);
+    SAVE_STRING(cfg->psz_type, rec->type);
+    SAVE_STRING(cfg->psz_name, rec->name);
+    SAVE_STRING(cfg->psz_text, rec->text);
+    SAVE_STRING(cfg->psz_longtext, rec->longtext);
+    rec->list_count = cfg->list_count;
+
+    if (cfg->list_count == 0)
+        SAVE_STRING(cfg->list_cb_name, rec->list_cb_name);
 
     if (IsConfigStringType (cfg->i_type))
     {
-        SAVE_STRING (cfg->orig.psz);
-        if (cfg->list_count == 0)
-            SAVE_STRING(cfg->list_cb_name);
+        uint32_t ref;
+
+        SAVE_STRING(cfg->orig.psz, ref);
+        rec->orig.i = ref;
 
-        for (unsigned i = 0; i < cfg->list_count; i++)
-            SAVE_STRING (cfg->list.psz[i]);
+        if (cfg->list_count > 0
+         && CacheSaveStrings(w, cfg->list.psz, cfg->list_count, &rec->list))
+            goto error;
     }
     else
     {
-        SAVE_IMMEDIATE (cfg->orig);
-        SAVE_IMMEDIATE (cfg->min);
-        SAVE_IMMEDIATE (cfg->max);
+        rec->orig = cfg->orig;
+        rec->min = cfg->min;
+        rec->max = cfg->max;
 
-        if (cfg->list_count > 0)
-        {
-            SAVE_ALIGNOF(*cfg->list.i);
-        }
-        else
-            SAVE_STRING(cfg->list_cb_name);
+        int *ints = SAVE_RESERVE(w, ints, cfg->list_count);
+        if (unlikely(ints == NULL))
+            goto error;
 
-        for (unsigned i = 0; i < cfg->list_count; i++)
-             SAVE_IMMEDIATE (cfg->list.i[i]);
+        rec->list = w->ints_count;
+        if (cfg->list_count > 0)
+            memcpy(ints, cfg->list.i, cfg->list_count * sizeof (*ints));
+        w->ints_count += cfg->list_count;
     }
-    for (unsigned i = 0; i < cfg->list_count; i++)
-        SAVE_STRING (cfg->list_text[i]);
 
+    if (cfg->list_count > 0
+     && CacheSaveStrings(w, cfg->list_text, cfg->list_count, &rec->list_text))
+        goto error;
+
+    w->configs_count++;
     return 0;
 error:
     return -1;
 }
 
-static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
+static int CacheSaveModule(struct vlc_cache_writer *w, const module_t *module)
 {
-    uint16_t lines = plugin->conf.size;
-
-    SAVE_IMMEDIATE (lines);
+    struct vlc_cache_module *rec = SAVE_RESERVE(w, modules, 1);
+    if (unlikely(rec == NULL))
+        goto error;
 
-    for (size_t i = 0; i < lines; i++)
-        if (CacheSaveConfig(file, plugin->conf.items + i))
-           goto error;
+    memset(rec, 0, sizeof (*rec));
+    SAVE_STRING(module->psz_shortname, rec->shortname);
+    SAVE_STRING(module->psz_longname, rec->longname);
+    SAVE_STRING(module->psz_help, rec->help);
+    SAVE_STRING(module->psz_capability, rec->capability);
+    SAVE_STRING(module->activate_name, rec->activate);
+    SAVE_STRING(module->deactivate_name, rec->deactivate);
+    rec->score = module->i_score;
+    rec->shortcuts_count = module->i_shortcuts;
+    if (CacheSaveStrings(w, module->pp_shortcuts, module->i_shortcuts,
+                         &rec->shortcuts))
+        goto error;
 
+    w->modules_count++;
     return 0;
 error:
     return -1;
 }
 
-static int CacheSaveModule(FILE *file, const module_t *module)
+static int CacheSavePlugin(struct vlc_cache_writer *w,
+                           const vlc_plugin_t *plugin)
 {
-    SAVE_STRING(module->psz_shortname);
-    SAVE_STRING(module->psz_longname);
-    SAVE_STRING(module->psz_help);
-    SAVE_IMMEDIATE(module->i_shortcuts);
-
-    for (size_t j = 0; j < module->i_shortcuts; j++)
-         SAVE_STRING(module->pp_shortcuts[j]);
-
-    SAVE_STRING(module->activate_name);
-    SAVE_STRING(module->deactivate_name);
-    SAVE_STRING(module->psz_capability);
-    SAVE_IMMEDIATE(module->i_score);
+    struct vlc_cache_plugin *rec = SAVE_RESERVE(w, plugins, 1);
+    if (unlikely(rec == NULL))
+        goto error;
+
+    memset(rec, 0, sizeof (*rec));
+    rec->modules = w->modules_count;
+    rec->modules_count = plugin->modules_count;
+
+    for (module_t *module = plugin->module;
+         module != NULL;
+         module = module->next)
+        if (CacheSaveModule(w, module))
+            goto error;
+
+    rec->configs = w->configs_count;
+    rec->configs_count = plugin->conf.size;
+
+    for (size_t i = 0; i < plugin->conf.size; i++)
+        if (CacheSaveConfig(w, plugin->conf.items + i))
+            goto error;
+
+    SAVE_STRING(plugin->textdomain, rec->textdomain);
+    SAVE_STRING(plugin->path, rec->path);
+    rec->unloadable = plugin->unloadable;
+    rec->mtime = plugin->mtime;
+    rec->size = plugin->size;
+
+    w->plugins_count++;
     return 0;
 error:
     return -1;
 }
 
+static int CacheSaveTable(FILE *file, const void *tab, size_t count,
+                          size_t size, size_t align,
+                          struct vlc_cache_table *restrict table)
+{
+    size_t skip = (-ftell(file)) % align;
+    if (skip != 0 && fseek(file, skip, SEEK_CUR))
+        return -1;
+
+    long offset = ftell(file);
+    if (offset < 0 || (unsigned long)offset > UINT32_MAX)
+        return -1;
+
+    table->offset = offset;
+    table->count = count;
+    if (count > 0 && fwrite(tab, size, count, file) != count)
+        return -1;
+    return 0;
+}
+
+#define SAVE_TABLE(t) \
+    if (CacheSaveTable(file, w->t, w->t##_count, sizeof (*w->t), \
+                       alignof (*w->t), &index.t)) \
+        goto error
+
 static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
 {
     uint32_t i_file_size = 0;
+    struct vlc_cache_writer writer = { 0 }, *w = &writer;
+    int ret = -1;
+
+    /* Make sure that offset 0 is the empty string, and stands for NULL */
+    char *pool = SAVE_RESERVE(w, strings, 1);
+    if (unlikely(pool == NULL))
+        goto error;
+    *pool = '\0';
+    w->strings_count++;
+
+    for (size_t i = 0; i < n; i++)
+        if (CacheSavePlugin(w, cache[i]))
+            goto error;
 
     /* Contains version number */
     if (fputs (CACHE_STRING, file) == EOF)
@@ -615,37 +871,40 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
     if (fwrite (&i_file_size, sizeof (i_file_size), 1, file) != 1)
         goto error;
 
-    for (size_t i = 0; i < n; i++)
-    {
-        const vlc_plugin_t *plugin = cache[i];
-        uint32_t count = plugin->modules_count;
-
-        SAVE_IMMEDIATE(count);
+    /* Leave room for the index, write the tables, then go back to it */
+    struct vlc_cache_index index;
+    size_t skip = (-ftell(file)) % alignof (index);
+    if (skip != 0 && fseek(file, skip, SEEK_CUR))
+        goto error;
 
-        for (module_t *module = plugin->module;
-             module != NULL;
-             module = module->next)
-            if (CacheSaveModule(file, module))
-                goto error;
+    long index_offset = ftell(file);
+    if (index_offset < 0 || fseek(file, sizeof (index), SEEK_CUR))
+        goto error;
 
-        /* Config stuff */
-        if (CacheSaveModuleConfig(file, plugin))
-            goto error;
+    SAVE_TABLE(strings);
+    SAVE_TABLE(refs);
+    SAVE_TABLE(ints);
+    SAVE_TABLE(configs);
+    SAVE_TABLE(modules);
+    SAVE_TABLE(plugins);
 
-        /* Save common info */
-        SAVE_STRING(plugin->textdomain);
-        SAVE_STRING(plugin->path);
-        SAVE_FLAG(plugin->unloadable);
-        SAVE_IMMEDIATE(plugin->mtime);
-        SAVE_IMMEDIATE(plugin->size);
-    }
+    if (fseek(file, index_offset, SEEK_SET)
+     || fwrite(&index, sizeof (index), 1, file) != 1)
+        goto error;
 
     if (fflush (file)) /* flush libc buffers */
         goto error;
-    return 0; /* success! */
+    ret = 0; /* success! */
 
 error:
-    return -1;
+    tdestroy(w->strings_tree, free);
+    free(w->strings);
+    free(w->refs);
+    free(w->ints);
+    free(w->configs);
+    free(w->modules);
+    free(w->plugins);
+    return ret;
 }
 
 /**
@@ -157,7 +157,7 @@ static int module_load (vlc_object_t *obj, module_t *m,
 {
     int ret = VLC_SUCCESS;
 
-    if (module_Map(obj, m->plugin))
+    if (module_Map(obj, m->plugin, module_get_capability(m)))
         return VLC_EGENERIC;
 
     if (m->pf_activate != NULL)
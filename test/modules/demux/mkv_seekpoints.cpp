@@ -0,0 +1,152 @@
+/*****************************************************************************
+ * mkv_seekpoints.cpp: matroska seekpoints index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../modules/demux/mkv/matroska_segment_seekpoints.cpp"
+
+#undef NDEBUG
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+using namespace mkv;
+
+static const Seekpoint::TrustLevel levels[] = {
+    Seekpoint::TRUSTED, Seekpoint::QUESTIONABLE, Seekpoint::DISABLED,
+};
+
+/* The previous storage: a sorted vector with one insertion per seekpoint */
+static void reference_add(std::vector<Seekpoint> &seekpoints, Seekpoint sp)
+{
+    std::vector<Seekpoint>::iterator it =
+        std::lower_bound(seekpoints.begin(), seekpoints.end(), sp);
+
+    if(it != seekpoints.end() && it->pts == sp.pts)
+    {
+        if(sp.trust_level > it->trust_level)
+            *it = sp;
+    }
+    else
+        seekpoints.insert(it, sp);
+}
+
+/* Cue i is at 40ms * i, possibly shuffled and listed twice */
+static Seekpoint cue(unsigned i, unsigned count, bool shuffle)
+{
+    const unsigned n = shuffle ? (uint64_t)i * 7919 % count : i;
+    return Seekpoint(1000 * n + i, VLC_TICK_FROM_MS(40) * (n / 2), levels[i % 3]);
+}
+
+static void check(const SeekpointIndex &index, const std::vector<Seekpoint> &ref)
+{
+    assert(index.size() == ref.size());
+    for(size_t i = 0; i < ref.size(); i++)
+    {
+        assert(index[i].pts == ref[i].pts);
+        assert(index[i].fpos == ref[i].fpos);
+        assert(index[i].trust_level == ref[i].trust_level);
+    }
+}
+
+static void test_merge(unsigned count, bool shuffle, unsigned commit_every)
+{
+    SeekpointIndex index;
+    std::vector<Seekpoint> ref;
+
+    for(unsigned i = 0; i < count; i++)
+    {
+        index.add(cue(i, count, shuffle));
+        reference_add(ref, cue(i, count, shuffle));
+        if(commit_every && i % commit_every == 0)
+            index.commit();
+    }
+    index.commit();
+    check(index, ref);
+
+    /* same pts, more trusted */
+    index.add(Seekpoint(1, ref[0].pts, Seekpoint::TRUSTED));
+    index.add(Seekpoint(2, ref[0].pts, Seekpoint::TRUSTED));
+    index.commit();
+    assert(index[0].trust_level == Seekpoint::TRUSTED);
+    assert(index[0].fpos == (ref[0].trust_level == Seekpoint::TRUSTED ? ref[0].fpos : 1));
+}
+
+static void test_lookup(void)
+{
+    SeekpointIndex index;
+
+    assert(index.empty());
+    index.add(Seekpoint(300, 3000));
+    index.add(Seekpoint(100, 1000));
+    index.add(Seekpoint(200, 2000));
+    assert(index.size() == 1); /* pending */
+    index.commit();
+    assert(index.size() == 3);
+
+    assert(index.greatest_lower_bound(0) == 0);
+    assert(index.greatest_lower_bound(1000) == 0);
+    assert(index.greatest_lower_bound(2999) == 1);
+    assert(index.greatest_lower_bound(3000) == 2);
+    assert(index.greatest_lower_bound(9999) == 2);
+}
+
+static void bench(unsigned count)
+{
+    const unsigned lookups = 1000000;
+    const bool shuffles[] = { false, true };
+
+    for(bool shuffle : shuffles)
+    {
+        SeekpointIndex index;
+
+        vlc_tick_t start = vlc_tick_now();
+        for(unsigned i = 0; i < count; i++)
+            index.add(cue(i, count, shuffle));
+        index.commit();
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+        printf("%s cues %8.1f ms\n", shuffle ? "shuffled" : "ordered ",
+               1e3 * secf_from_vlc_tick(elapsed));
+
+        const vlc_tick_t last = index.pts(index.size() - 1);
+        uint64_t res = 0;
+        start = vlc_tick_now();
+        for(unsigned i = 0; i < lookups; i++)
+            res += index[index.greatest_lower_bound((vlc_tick_t)i * 7919 % last)].fpos;
+        elapsed = vlc_tick_now() - start;
+        printf("lookups       %8.1f ns (%" PRIu64 ")\n",
+               1e9 * secf_from_vlc_tick(elapsed) / lookups, res);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    test_lookup();
+    test_merge(20000, false, 0);
+    test_merge(20000, true, 0);
+    test_merge(20000, true, 1000);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        bench(1000000);
+
+    return 0;
+}
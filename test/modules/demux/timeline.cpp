@@ -0,0 +1,175 @@
+/*****************************************************************************
+ * timeline.cpp: adaptive SegmentTimeline lookups
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../modules/demux/adaptive/ID.cpp"
+#include "../modules/demux/adaptive/playlist/Inheritables.cpp"
+#include "../modules/demux/adaptive/playlist/SegmentTimeline.cpp"
+
+#undef NDEBUG
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include <vlc_tick.h>
+
+using namespace adaptive::playlist;
+
+/* Element i has duration 1000 + (i % 7), repeated i % 3 times */
+static stime_t fill(SegmentTimeline *timeline, unsigned count, uint64_t first)
+{
+    uint64_t number = first;
+    stime_t t = 0;
+    for(unsigned i = 0; i < count; i++)
+    {
+        const stime_t d = 1000 + (i % 7);
+        const uint64_t r = i % 3;
+        timeline->addElement(number, d, r, i ? 0 : t);
+        number += r + 1;
+        t += d * (r + 1);
+    }
+    return t;
+}
+
+/* Checks every segment of a timeline built by fill() */
+static void check(const SegmentTimeline *timeline, unsigned count, uint64_t first)
+{
+    uint64_t number = first;
+    stime_t t = 0, total = 0;
+
+    for(unsigned i = 0; i < count; i++)
+        total += (1000 + (i % 7)) * (1 + (i % 3));
+
+    assert(timeline->minElementNumber() == first);
+
+    for(unsigned i = 0; i < count; i++)
+    {
+        const stime_t d = 1000 + (i % 7);
+        for(uint64_t r = 0; r <= i % 3; r++)
+        {
+            stime_t time, duration;
+            assert(timeline->getScaledPlaybackTimeDurationBySegmentNumber(number, &time, &duration));
+            assert(time == t);
+            assert(duration == d);
+            assert(timeline->getElementNumberByScaledPlaybackTime(t) == number);
+            assert(timeline->getElementNumberByScaledPlaybackTime(t + d - 1) == number);
+            t += d;
+            assert(timeline->getMinAheadScaledTime(number) == total - t);
+            number++;
+        }
+    }
+
+    assert(timeline->maxElementNumber() == number - 1);
+}
+
+static void test_discontinuity(void)
+{
+    SegmentTimeline timeline(1000);
+
+    timeline.addElement(10, 100, 1, 1000);
+    timeline.addElement(20, 100, 0, 2000); /* gap in both time and number */
+
+    assert(timeline.getElementNumberByScaledPlaybackTime(0) == 10);
+    assert(timeline.getElementNumberByScaledPlaybackTime(1150) == 11);
+    assert(timeline.getElementNumberByScaledPlaybackTime(1500) == 20);
+    assert(timeline.getElementNumberByScaledPlaybackTime(2050) == 20);
+    assert(timeline.getElementNumberByScaledPlaybackTime(5000) == 20);
+    assert(timeline.getScaledPlaybackTimeByElementNumber(15) == 2000);
+    assert(timeline.getMinAheadScaledTime(10) == 200);
+
+    assert(timeline.pruneBySequenceNumber(11) == 1);
+    assert(timeline.minElementNumber() == 11);
+    assert(timeline.getScaledPlaybackTimeByElementNumber(11) == 1100);
+    assert(timeline.getMinAheadScaledTime(11) == 100);
+    assert(timeline.pruneBySequenceNumber(30) == 2);
+    assert(timeline.maxElementNumber() == 0);
+}
+
+static void test_merge(void)
+{
+    SegmentTimeline timeline(1000), update(1000);
+
+    timeline.addElement(1, 100, 4, 0);     /* #1..#5, up to 500 */
+    update.addElement(100, 100, 3, 300);   /* #4..#7, renumbered */
+    update.addElement(104, 50, 1, 0);      /* #8..#9 */
+    timeline.mergeWith(update);
+
+    assert(timeline.minElementNumber() == 1);
+    assert(timeline.maxElementNumber() == 9);
+    assert(timeline.getScaledPlaybackTimeByElementNumber(8) == 700);
+    assert(timeline.getElementNumberByScaledPlaybackTime(760) == 9);
+    assert(timeline.getMinAheadScaledTime(5) == 300);
+}
+
+static void bench(unsigned count)
+{
+    SegmentTimeline timeline(1000);
+    const stime_t total = fill(&timeline, count, 1);
+    const uint64_t last = timeline.maxElementNumber();
+    const unsigned lookups = 1000000;
+    uint64_t res = 0;
+
+    vlc_tick_t start = vlc_tick_now();
+    for(unsigned i = 0; i < lookups; i++)
+        res += timeline.getElementNumberByScaledPlaybackTime((stime_t)i * 7919 % total);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    printf("time lookups   %8.1f ns (%" PRIu64 ")\n",
+           1e9 * secf_from_vlc_tick(elapsed) / lookups, res);
+
+    start = vlc_tick_now();
+    for(unsigned i = 0; i < lookups; i++)
+        res += timeline.getScaledPlaybackTimeByElementNumber(1 + (uint64_t)i * 7919 % last);
+    elapsed = vlc_tick_now() - start;
+    printf("number lookups %8.1f ns (%" PRIu64 ")\n",
+           1e9 * secf_from_vlc_tick(elapsed) / lookups, res);
+
+    /* Live refresh: same window shifted by one element, then pruned */
+    start = vlc_tick_now();
+    for(unsigned i = 0; i < 100; i++)
+    {
+        SegmentTimeline *update = new SegmentTimeline(1000);
+        fill(update, count, 1);
+        update->addElement(last + 1, 1000, 0, total);
+        timeline.mergeWith(*update);
+        timeline.pruneBySequenceNumber(timeline.minElementNumber() + 1);
+        delete update;
+    }
+    elapsed = vlc_tick_now() - start;
+    printf("merge & prune  %8.1f us\n", 1e4 * secf_from_vlc_tick(elapsed));
+}
+
+int main(int argc, char *argv[])
+{
+    const unsigned count = 50000;
+
+    SegmentTimeline timeline(1000);
+    fill(&timeline, count, 1);
+    check(&timeline, count, 1);
+
+    test_discontinuity();
+    test_merge();
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        bench(count);
+
+    return 0;
+}
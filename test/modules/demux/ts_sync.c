@@ -0,0 +1,161 @@
+/*****************************************************************************
+ * ts_sync.c: MPEG-TS sync byte scanner test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../modules/demux/mpeg/ts_sync.h"
+
+typedef size_t (*ts_sync_find_t)(const uint8_t *, size_t, size_t, unsigned);
+
+static const struct
+{
+    const char *name;
+    ts_sync_find_t find;
+} impls[] = {
+    { "generic", ts_sync_Find_Generic },
+#if defined(HAVE_SSE2_INTRINSICS)
+    { "sse2", ts_sync_Find_SSE2 },
+    { "avx2", ts_sync_Find_AVX2 },
+#elif defined(TS_SYNC_NEON)
+    { "neon", ts_sync_Find_NEON },
+#endif
+    { "dispatch", ts_sync_Find },
+};
+
+static bool impl_usable(size_t i)
+{
+#if defined(HAVE_SSE2_INTRINSICS)
+    if (impls[i].find == ts_sync_Find_SSE2)
+        return vlc_CPU_SSE2();
+    if (impls[i].find == ts_sync_Find_AVX2)
+        return vlc_CPU_AVX2();
+#else
+    VLC_UNUSED(i);
+#endif
+    return true;
+}
+
+/* Fills a buffer with garbage free of sync bytes, then a stream of packets
+ * of the given size starting at the given offset. */
+static void fill(uint8_t *buf, size_t len, size_t start, size_t size)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = rand();
+        if (buf[i] == TS_SYNC_BYTE)
+            buf[i]++;
+    }
+    for (size_t i = start; i < len; i += size)
+        buf[i] = TS_SYNC_BYTE;
+}
+
+static void check(const uint8_t *buf, size_t len, size_t stride,
+                  unsigned checks)
+{
+    size_t ref = ts_sync_Find_C(buf, len, stride, checks);
+
+    for (size_t i = 0; i < ARRAY_SIZE(impls); i++)
+        if (impl_usable(i))
+            assert(impls[i].find(buf, len, stride, checks) == ref);
+}
+
+static void bench(uint8_t *buf, size_t len)
+{
+    /* Worst case for resync: sync is only found at the end */
+    fill(buf, len, len - 188 * 4, 188);
+    /* Sprinkle isolated sync bytes, like payload data would */
+    for (size_t i = 97; i < len - 188 * 4; i += 251)
+        buf[i] = TS_SYNC_BYTE;
+
+    for (size_t i = 0; i < ARRAY_SIZE(impls) + 1; i++)
+    {
+        ts_sync_find_t find = i ? impls[i - 1].find : ts_sync_Find_C;
+        const char *name = i ? impls[i - 1].name : "bytewise";
+        size_t res = 0;
+
+        if (i && !impl_usable(i - 1))
+            continue;
+
+        vlc_tick_t start = vlc_tick_now();
+        for (unsigned n = 0; n < 100; n++)
+            res += find(buf, len, 188, 3);
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+
+        printf("%-10s %8.1f MiB/s (%zu)\n", name,
+               100. * len / (1 << 20) / secf_from_vlc_tick(elapsed), res);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t len = 4096;
+    uint8_t *buf = malloc(len);
+    assert(buf != NULL);
+
+    srand(42);
+
+    static const unsigned sizes[] = { 188, 192, 204 };
+    for (size_t s = 0; s < ARRAY_SIZE(sizes); s++)
+        for (size_t start = 0; start < 300; start += 7)
+        {
+            fill(buf, len, start, sizes[s]);
+            for (unsigned checks = 1; checks <= 3; checks++)
+                for (size_t l = 0; l < len; l += 61)
+                    check(buf, l, sizes[s], checks);
+
+            size_t offset;
+            unsigned size = ts_sync_DetectPacketSize(buf, len, 3, &offset);
+            assert(size == sizes[s]);
+            assert(offset == start);
+        }
+
+    /* Random sync bytes */
+    memset(buf, 0, len);
+    for (unsigned i = 0; i < 2000; i++)
+    {
+        buf[rand() % len] = TS_SYNC_BYTE;
+        if (i % 100 == 0)
+            for (unsigned checks = 1; checks <= 3; checks++)
+                check(buf, len, 188, checks);
+    }
+
+    if (argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        const size_t big = 64 << 20;
+        uint8_t *p = realloc(buf, big);
+        assert(p != NULL);
+        buf = p;
+        bench(buf, big);
+    }
+
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * block_pool.c: test for the block pool
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#undef NDEBUG
+#include <assert.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#define PACKETS 1000
+
+static void *Releaser(void *data)
+{
+    block_fifo_t *fifo = data;
+    block_t *block;
+
+    while ((block = block_FifoGet(fifo))->i_buffer != 0)
+        block_Release(block);
+    block_Release(block);
+    return NULL;
+}
+
+int main(void)
+{
+    struct block_pool_stats stats;
+    block_pool_t *pool = block_PoolNew(1316);
+    assert(pool != NULL);
+
+    /* Same-thread recycling */
+    block_t *block = block_PoolAlloc(pool);
+    assert(block != NULL);
+    assert(block->i_buffer == 1316);
+    assert(((uintptr_t)block->p_buffer % 32) == 0);
+    memset(block->p_buffer, 0x47, block->i_buffer);
+    block_Release(block);
+
+    block = block_PoolAlloc(pool);
+    assert(block != NULL);
+    block_PoolGetStats(pool, &stats);
+    assert(stats.requests == 2);
+    assert(stats.recycled == 1);
+    assert(stats.count == 1);
+
+    /* Realloc beyond the pool size */
+    block = block_Realloc(block, 0, 4096);
+    assert(block != NULL);
+    block_Release(block);
+
+    /* Cross-thread release */
+    block_fifo_t *fifo = block_FifoNew();
+    vlc_thread_t th;
+    assert(fifo != NULL);
+    assert(vlc_clone(&th, Releaser, fifo, VLC_THREAD_PRIORITY_LOW) == 0);
+
+    for (unsigned i = 0; i < PACKETS; i++)
+    {
+        block = block_PoolAlloc(pool);
+        assert(block != NULL);
+        block_FifoPut(fifo, block);
+    }
+
+    block = block_PoolAlloc(pool);
+    assert(block != NULL);
+    block->i_buffer = 0; /* end marker */
+    block_FifoPut(fifo, block);
+    vlc_join(th, NULL);
+    block_FifoRelease(fifo);
+
+    block_PoolGetStats(pool, &stats);
+    assert(stats.requests == PACKETS + 3);
+    assert(stats.count <= PACKETS + 1);
+
+    /* Blocks outlive their pool */
+    block = block_PoolAlloc(pool);
+    assert(block != NULL);
+    block_PoolRelease(pool);
+    memset(block->p_buffer, 0, block->i_buffer);
+    block_Release(block);
+
+    return 0;
+}